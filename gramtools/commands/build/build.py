@@ -150,6 +150,8 @@ def _execute_gramtools_cpp_build(build_report, action, build_paths, args):
         str(args.kmer_size),
         "--max_threads",
         str(args.max_threads),
+        "--sa_memory_budget_mb",
+        str(args.sa_memory_budget_mb),
         "--all_kmers",  # Currently always build all kmers of given size
     ]
 
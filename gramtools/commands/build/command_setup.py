@@ -51,9 +51,22 @@ def setup_parser(common_parser, subparsers):
         required=False,
     )
 
-    # TODO: there is no multi-threading yet
     parser.add_argument(
-        "--max_threads", help=argparse.SUPPRESS, type=int, default=1, required=False
+        "--max_threads",
+        help="Run with more threads than the default of one. "
+        "Currently used for sorting the prg's suffixes.",
+        type=int,
+        default=1,
+        required=False,
+    )
+
+    parser.add_argument(
+        "--sa_memory_budget_mb",
+        help="Memory budget (MB) for sorting the prg's suffixes. "
+        "Beyond it, suffixes are sorted in partitions on disk. Defaults to no budget.",
+        type=int,
+        default=0,
+        required=False,
     )
 
     # Hidden arguments, for legacy/special uses (minos)
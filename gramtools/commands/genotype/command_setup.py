@@ -52,6 +52,59 @@ def setup_parser(common_parser, subparsers):
         required=False,
     )
 
+    parser.add_argument(
+        "--profile",
+        help="Also profile the read mapping hot path, and record hardware counters "
+        "and the peak RSS of each stage.\n"
+        "The run's peak RSS, as reported by the kernel, is then no longer that of the whole run.\n"
+        "A profile of the run is always written to profile.json in the output directory.",
+        action="store_true",
+        required=False,
+    )
+
+    parser.add_argument(
+        "--mmap",
+        help="Map the reduced BWT and BWT markers mask of gram_dir read-only, rather than copy them into memory.\n"
+        "Concurrent runs against the same gram_dir then share them. "
+        "The FM index and kmer index are still loaded into memory.",
+        action="store_true",
+        required=False,
+    )
+
+    parser.add_argument(
+        "--numa",
+        help="Interleave the loaded prg and kmer index over NUMA nodes, and pin mapping threads to nodes.\n"
+        "For multi-socket hosts: no socket's threads then query them all remotely.",
+        action="store_true",
+        required=False,
+    )
+
+    parser.add_argument(
+        "--huge_pages",
+        help="Back the loaded prg with transparent huge pages, and read it in upfront.\n"
+        "Backward search accesses it almost randomly: fewer, larger pages mean fewer TLB misses.",
+        action="store_true",
+        required=False,
+    )
+
+    parser.add_argument(
+        "--read_cache_mb",
+        help="Memory, in MB, for caching read mappings: identical reads then get searched once.\n"
+        "Off (0) by default: it pays off on libraries with many duplicate reads.",
+        type=int,
+        default=0,
+        required=False,
+    )
+
+    parser.add_argument(
+        "--suffix_cache_mb",
+        help="Memory, in MB, for caching the search of read 3' suffixes longer than the kmer size.\n"
+        "Reads sharing a long 3' suffix then resume their search from there. Off (0) by default.",
+        type=int,
+        default=0,
+        required=False,
+    )
+
     parser.add_argument(
         "--seed",
         help="Fixing the seed will produce the same read mappings across different runs."
@@ -86,11 +86,27 @@ def _execute_command_cpp_genotype(geno_report, action, geno_paths, args):
         str(args.max_threads),
         "--seed",
         str(args.seed),
+        "--read_cache_mb",
+        str(args.read_cache_mb),
+        "--suffix_cache_mb",
+        str(args.suffix_cache_mb),
     ]
 
     if args.debug:
         command += ["--debug"]
 
+    if args.profile:
+        command += ["--profile"]
+
+    if args.mmap:
+        command += ["--mmap"]
+
+    if args.numa:
+        command += ["--numa"]
+
+    if args.huge_pages:
+        command += ["--huge_pages"]
+
     command_result = common.run_subprocess(command)
     log.debug("Output run directory:\n%s", geno_paths.geno_dir)
 
@@ -0,0 +1,32 @@
+/** @file
+ * Recording per-base coverage of mapped reads on the coverage graph.
+ */
+#include "bench_resources.hpp"
+#include "genotype/quasimap/coverage/allele_base.hpp"
+#include "genotype/quasimap/quasimap.hpp"
+
+using namespace gram;
+using namespace gram::bench;
+using namespace gram::coverage::per_base;
+
+static void BM_PbCovRecorder(benchmark::State &state) {
+  auto &setup = get_mutable_setup(prg_params_from(state));
+
+  std::vector<std::pair<SearchStates, std::size_t>> mappings;
+  auto const kmer_size = setup.parameters.kmers_size;
+  for (auto const &read : setup.encoded_reads) {
+    auto kmer = get_kmer_from_read(kmer_size, read);
+    auto search_states = search_read_backwards(read, kmer, setup.kmer_index,
+                                               setup.prg_info);
+    if (!search_states.empty())
+      mappings.emplace_back(std::move(search_states), read.size());
+  }
+
+  for (auto _ : state) {
+    for (auto const &mapping : mappings)
+      PbCovRecorder recorder(setup.prg_info, mapping.first, mapping.second);
+  }
+  state.SetItemsProcessed(state.iterations() * mappings.size());
+  set_prg_counters(state, setup);
+}
+BENCHMARK(BM_PbCovRecorder)->Apply(prg_shapes);
@@ -0,0 +1,91 @@
+/** @file
+ * Genotyping the sites of a mapped PRG, and writing the results out.
+ */
+#include <filesystem>
+#include <sstream>
+
+#include "bench_resources.hpp"
+#include "genotype/infer/level_genotyping/runner.hpp"
+#include "genotype/infer/output_specs/make_json.hpp"
+#include "genotype/infer/output_specs/make_vcf.hpp"
+#include "genotype/infer/output_specs/segment_tracker.hpp"
+
+using namespace gram;
+using namespace gram::bench;
+namespace fs = std::filesystem;
+
+/**
+ * Runs `LevelGenotyperModel` on every site of the PRG.
+ * @param get_gcp whether to also compute genotype confidence percentiles, by
+ * simulation, as `genotype` does
+ */
+static void BM_LevelGenotyperModel(benchmark::State &state, Ploidy ploidy,
+                                   bool get_gcp) {
+  auto const &setup = get_setup(prg_params_from(state));
+
+  for (auto _ : state) {
+    LevelGenotyper genotyper(setup.prg_info.coverage_graph,
+                             setup.coverage.grouped_allele_counts,
+                             setup.read_stats, ploidy, get_gcp);
+    benchmark::DoNotOptimize(genotyper);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          setup.prg_info.num_variant_sites);
+  set_prg_counters(state, setup);
+}
+BENCHMARK_CAPTURE(BM_LevelGenotyperModel, haploid, Ploidy::Haploid, false)
+    ->Apply(prg_shapes);
+BENCHMARK_CAPTURE(BM_LevelGenotyperModel, diploid, Ploidy::Diploid, false)
+    ->Apply(prg_shapes);
+BENCHMARK_CAPTURE(BM_LevelGenotyperModel, haploid_gcp, Ploidy::Haploid, true)
+    ->Apply(prg_shapes);
+
+static gtyper_ptr make_genotyper(BenchSetup const &setup) {
+  return std::make_shared<LevelGenotyper>(
+      setup.prg_info.coverage_graph, setup.coverage.grouped_allele_counts,
+      setup.read_stats, Ploidy::Haploid, true);
+}
+
+static void BM_write_json(benchmark::State &state) {
+  auto const &setup = get_setup(prg_params_from(state));
+  auto const gtyper = make_genotyper(setup);
+  SegmentTracker tracker;
+  std::size_t bytes_written{0};
+
+  for (auto _ : state) {
+    tracker.reset();
+    auto json_prg = make_json_prg(gtyper, tracker);
+    json_prg->set_sample_info("sample", "made by gramtools bench");
+    std::ostringstream out;
+    out << json_prg->get_prg();
+    bytes_written = out.tellp();
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          setup.prg_info.num_variant_sites);
+  state.counters["bytes_written"] = bytes_written;
+  set_prg_counters(state, setup);
+}
+BENCHMARK(BM_write_json)->Apply(prg_shapes);
+
+static void BM_write_vcf(benchmark::State &state) {
+  auto const &setup = get_setup(prg_params_from(state));
+  auto const gtyper = make_genotyper(setup);
+  SegmentTracker tracker;
+
+  GenotypeParams parameters = setup.parameters;
+  auto const fpath = fs::temp_directory_path() / "gram_bench_genotyped.vcf.gz";
+  parameters.genotyped_vcf_fpath = fpath.generic_string();
+  parameters.sample_id = "sample";
+  parameters.ploidy = Ploidy::Haploid;
+
+  for (auto _ : state) {
+    tracker.reset();
+    write_vcf(parameters, gtyper, tracker);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          setup.prg_info.num_variant_sites);
+  state.counters["bytes_written"] = fs::file_size(fpath);
+  set_prg_counters(state, setup);
+  fs::remove(fpath);
+}
+BENCHMARK(BM_write_vcf)->Apply(prg_shapes);
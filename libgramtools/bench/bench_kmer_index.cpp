@@ -0,0 +1,33 @@
+/** @file
+ * Deserialisation of the kmer index, as done at the start of `genotype`.
+ */
+#include <filesystem>
+
+#include "bench_resources.hpp"
+#include "build/kmer_index/dump.hpp"
+#include "build/kmer_index/load.hpp"
+
+using namespace gram;
+using namespace gram::bench;
+namespace fs = std::filesystem;
+
+static void BM_kmer_index_load(benchmark::State &state) {
+  auto const &setup = get_setup(prg_params_from(state));
+
+  auto const dirpath = fs::temp_directory_path() / "gram_bench_kmer_index";
+  fs::create_directories(dirpath);
+  BuildParams parameters{};
+  fill_common_parameters(parameters, dirpath.generic_string());
+  parameters.kmers_size = setup.parameters.kmers_size;
+  kmer_index::dump(setup.kmer_index, parameters);
+
+  for (auto _ : state) {
+    auto kmer_index = kmer_index::load(parameters);
+    benchmark::DoNotOptimize(kmer_index);
+  }
+  state.SetItemsProcessed(state.iterations() * setup.kmer_index.size());
+  state.counters["num_kmers"] = setup.kmer_index.size();
+  set_prg_counters(state, setup);
+  fs::remove_all(dirpath);
+}
+BENCHMARK(BM_kmer_index_load)->Apply(prg_shapes);
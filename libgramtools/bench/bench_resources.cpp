@@ -0,0 +1,223 @@
+#include <map>
+#include <set>
+
+#include "bench_resources.hpp"
+#include "common/dna_kernels.hpp"
+#include "common/huge_pages.hpp"
+#include "genotype/quasimap/coverage/coverage_common.hpp"
+#include "genotype/quasimap/quasimap.hpp"
+#include "prg/linearised_prg.hpp"
+#include "submod_resources.hpp"
+
+using namespace gram;
+using namespace gram::bench;
+
+static std::string random_bases(std::size_t length, std::mt19937 &gen) {
+  static std::string const bases{"ACGT"};
+  std::uniform_int_distribution<std::size_t> base_dist(0, 3);
+  std::string result(length, 'A');
+  for (auto &base : result) base = bases[base_dist(gen)];
+  return result;
+}
+
+static std::string make_site(SyntheticPrgParams const &params,
+                             std::size_t level, std::mt19937 &gen) {
+  std::string site{"["};
+  for (std::size_t allele = 0; allele < params.num_alleles; ++allele) {
+    if (allele > 0) site += ",";
+    site += random_bases(params.allele_length, gen);
+    if (allele == 0 && level < params.nesting_depth) {
+      site += make_site(params, level + 1, gen);
+      site += random_bases(params.allele_length, gen);
+    }
+  }
+  return site + "]";
+}
+
+std::string gram::bench::make_synthetic_prg(SyntheticPrgParams const &params) {
+  std::mt19937 gen(params.seed);
+  std::string prg = random_bases(params.invariant_length, gen);
+  for (std::size_t i = 0; i < params.num_sites; ++i) {
+    prg += make_site(params, 1, gen);
+    prg += random_bases(params.invariant_length, gen);
+  }
+  return prg;
+}
+
+/**
+ * Appends one random path through the site opening at `prg_string[pos]` to
+ * `path`, and returns the position following the site's closing bracket.
+ */
+static std::size_t sample_site_path(std::string const &prg_string,
+                                    std::size_t pos, std::mt19937 &gen,
+                                    std::string &path) {
+  // Find where each allele of the site starts, skipping nested sites
+  std::vector<std::size_t> allele_starts{pos + 1};
+  std::size_t depth{0};
+  for (++pos;; ++pos) {
+    char const c = prg_string.at(pos);
+    if (c == '[')
+      ++depth;
+    else if (c == ']' && depth-- == 0)
+      break;
+    else if (c == ',' && depth == 0)
+      allele_starts.push_back(pos + 1);
+  }
+  std::size_t const site_end = pos + 1;
+
+  std::uniform_int_distribution<std::size_t> allele_dist(
+      0, allele_starts.size() - 1);
+  for (pos = allele_starts[allele_dist(gen)];;) {
+    char const c = prg_string[pos];
+    if (c == ',' || c == ']') break;
+    if (c == '[')
+      pos = sample_site_path(prg_string, pos, gen, path);
+    else {
+      path.push_back(c);
+      ++pos;
+    }
+  }
+  return site_end;
+}
+
+std::string gram::bench::sample_prg_path(std::string const &prg_string,
+                                         std::mt19937 &gen) {
+  std::string path;
+  path.reserve(prg_string.size());
+  for (std::size_t pos = 0; pos < prg_string.size();) {
+    if (prg_string[pos] == '[')
+      pos = sample_site_path(prg_string, pos, gen, path);
+    else
+      path.push_back(prg_string[pos++]);
+  }
+  return path;
+}
+
+GenomicRead_vector gram::bench::sample_reads(std::string const &prg_string,
+                                             std::size_t num_reads,
+                                             std::size_t read_length,
+                                             uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::size_t const num_paths{4};
+  std::vector<std::string> paths;
+  for (std::size_t i = 0; i < num_paths; ++i)
+    paths.push_back(sample_prg_path(prg_string, gen));
+
+  GenomicRead_vector reads;
+  reads.reserve(num_reads);
+  std::string const qualities(read_length, '?');
+  std::uniform_int_distribution<std::size_t> path_dist(0, num_paths - 1);
+  for (std::size_t i = 0; i < num_reads; ++i) {
+    auto const &path = paths[path_dist(gen)];
+    std::size_t const length = std::min(read_length, path.size());
+    std::uniform_int_distribution<std::size_t> start_dist(
+        0, path.size() - length);
+    auto seq = path.substr(start_dist(gen), length);
+    if (i % 2 == 1) {  // Reverse orientation
+      Sequence encoded, reverse;
+      encode_dna_bases(seq, encoded);
+      reverse_complement_read(encoded, reverse);
+      for (std::size_t j = 0; j < length; ++j)
+        seq[j] = decode_dna_base(reverse[j])[0];
+    }
+    reads.emplace_back("read" + std::to_string(i), seq,
+                       qualities.substr(0, length));
+  }
+  return reads;
+}
+
+BenchSetup::BenchSetup(SyntheticPrgParams const &prg_params,
+                       std::size_t num_reads, std::size_t read_length,
+                       uint32_t kmer_size)
+    : prg_params(prg_params), prg_string(make_synthetic_prg(prg_params)) {
+  prg_info = submods::generate_prg_info(prg_string_to_ints(prg_string));
+  sdsl::util::init_support(prg_info.prg_markers_rank,
+                           &prg_info.prg_markers_mask);
+  sdsl::util::init_support(prg_info.prg_markers_select,
+                           &prg_info.prg_markers_mask);
+
+  reads = sample_reads(prg_string, num_reads, read_length, prg_params.seed);
+  for (auto const &read : reads)
+    encoded_reads.push_back(encode_dna_bases(read.seq));
+
+  // Each full kmer is its own prefix diff
+  std::set<Sequence> kmers;
+  for (auto const &read : encoded_reads)
+    for (std::size_t i = 0; i + kmer_size <= read.size(); ++i)
+      kmers.emplace(read.begin() + i, read.begin() + i + kmer_size);
+  parameters.kmers_size = kmer_size;
+  parameters.seed = prg_params.seed;
+  kmer_index = index_kmers(Sequences(kmers.begin(), kmers.end()), kmer_size,
+                           prg_info);
+
+  coverage = coverage::generate::empty_structure(prg_info);
+  for (auto const &read : encoded_reads)
+    quasimap_read(read, coverage, kmer_index, prg_info, parameters);
+  read_stats.compute_base_error_rate(reads);
+  read_stats.compute_coverage_depth(coverage, prg_info.coverage_graph.par_map);
+}
+
+static std::unique_ptr<BenchSetup> make_setup(
+    SyntheticPrgParams const &prg_params) {
+  std::size_t const read_length{100};
+  uint32_t const kmer_size{11};
+  auto const prg_length = make_synthetic_prg(prg_params).size();
+  std::size_t const num_reads =
+      std::max<std::size_t>(100, prg_length * 10 / read_length);
+  return std::make_unique<BenchSetup>(prg_params, num_reads, read_length,
+                                      kmer_size);
+}
+
+BenchSetup const &gram::bench::get_setup(
+    SyntheticPrgParams const &prg_params) {
+  static std::map<SyntheticPrgParams, std::unique_ptr<BenchSetup>> setups;
+  auto &setup = setups[prg_params];
+  if (setup == nullptr) setup = make_setup(prg_params);
+  return *setup;
+}
+
+BenchSetup &gram::bench::get_mutable_setup(
+    SyntheticPrgParams const &prg_params) {
+  static std::map<SyntheticPrgParams, std::unique_ptr<BenchSetup>> setups;
+  auto &setup = setups[prg_params];
+  if (setup == nullptr) setup = make_setup(prg_params);
+  return *setup;
+}
+
+BenchSetup const &gram::bench::get_huge_pages_setup(
+    SyntheticPrgParams const &prg_params) {
+  static std::map<SyntheticPrgParams, std::unique_ptr<BenchSetup>> setups;
+  auto &setup = setups[prg_params];
+  if (setup == nullptr) {
+    huge_pages::enable(true);
+    setup = make_setup(prg_params);
+    advise_huge_pages(setup->prg_info);
+    huge_pages::enable(false);
+  }
+  return *setup;
+}
+
+SyntheticPrgParams gram::bench::prg_params_from(
+    benchmark::State const &state) {
+  SyntheticPrgParams params;
+  params.num_sites = state.range(0);
+  params.nesting_depth = state.range(1);
+  params.num_alleles = state.range(2);
+  return params;
+}
+
+void gram::bench::prg_shapes(benchmark::internal::Benchmark *bench) {
+  bench->ArgNames({"sites", "depth", "alleles"});
+  bench->Args({100, 1, 2});
+  bench->Args({1000, 1, 2});
+  bench->Args({1000, 1, 8});
+  bench->Args({1000, 3, 2});
+  bench->Args({10000, 1, 2});
+  bench->Unit(benchmark::kMicrosecond);
+}
+
+void gram::bench::set_prg_counters(benchmark::State &state,
+                                   BenchSetup const &setup) {
+  state.counters["prg_length"] = setup.prg_info.encoded_prg.size();
+  state.counters["num_sites"] = setup.prg_info.num_variant_sites;
+}
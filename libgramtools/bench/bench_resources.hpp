@@ -0,0 +1,110 @@
+/** @file
+ * Synthetic PRGs and reads for the microbenchmarks.
+ *
+ * PRGs are generated as bracketed strings (eg "AC[G,T[A,C]]GG") and encoded
+ * through `prg_string_to_ints`, so their size, nesting depth and number of
+ * alleles per site can be controlled from the benchmark arguments.
+ */
+#ifndef GRAMTOOLS_BENCH_RESOURCES_HPP
+#define GRAMTOOLS_BENCH_RESOURCES_HPP
+
+#include <memory>
+#include <random>
+#include <tuple>
+
+#include <benchmark/benchmark.h>
+
+#include "build/kmer_index/build.hpp"
+#include "genotype/parameters.hpp"
+#include "genotype/read_stats.hpp"
+
+namespace gram::bench {
+struct SyntheticPrgParams {
+  std::size_t num_sites = 100;   /**< Number of top-level sites */
+  std::size_t nesting_depth = 1; /**< 1: no nesting */
+  std::size_t num_alleles = 2;   /**< Per site, at every nesting level */
+  std::size_t allele_length = 5;
+  std::size_t invariant_length = 20; /**< Between consecutive sites */
+  uint32_t seed = 42;
+
+  bool operator<(SyntheticPrgParams const &other) const {
+    return std::tie(num_sites, nesting_depth, num_alleles, allele_length,
+                    invariant_length, seed) <
+           std::tie(other.num_sites, other.nesting_depth, other.num_alleles,
+                    other.allele_length, other.invariant_length, other.seed);
+  }
+};
+
+/**
+ * Random bracketed PRG string. In a nested PRG, the first allele of each site
+ * above the deepest level holds a site of the next level down.
+ */
+std::string make_synthetic_prg(SyntheticPrgParams const &params);
+
+/** The sequence of one random path through bracketed PRG `prg_string` */
+std::string sample_prg_path(std::string const &prg_string, std::mt19937 &gen);
+
+/**
+ * Error-free reads of length `read_length`, drawn from a few random paths
+ * through `prg_string`, in both orientations.
+ */
+GenomicRead_vector sample_reads(std::string const &prg_string,
+                                std::size_t num_reads, std::size_t read_length,
+                                uint32_t seed);
+
+/**
+ * Holds what the benchmarks need, all built in memory from a synthetic PRG.
+ * The kmer index holds all kmers of the reads, so every read seeds.
+ * Reads are mapped at construction, populating `coverage` and `read_stats`.
+ */
+class BenchSetup {
+ public:
+  SyntheticPrgParams prg_params;
+  std::string prg_string;
+  PRG_Info prg_info;
+  GenotypeParams parameters;
+  KmerIndex kmer_index;
+  Coverage coverage;
+  ReadStats read_stats;
+  GenomicRead_vector reads;
+  Sequences encoded_reads;
+
+  BenchSetup(SyntheticPrgParams const &prg_params, std::size_t num_reads,
+             std::size_t read_length, uint32_t kmer_size);
+
+  // `prg_info`'s rank and select supports point into itself
+  BenchSetup(BenchSetup const &) = delete;
+  BenchSetup &operator=(BenchSetup const &) = delete;
+};
+
+/**
+ * Setups are expensive to build, so are shared between the benchmarks run
+ * on the same PRG shape. Reads give roughly 10x coverage of the PRG.
+ */
+BenchSetup const &get_setup(SyntheticPrgParams const &prg_params);
+
+/**
+ * For benchmarks modifying the setup (eg recording coverage on its graph),
+ * a setup distinct from `get_setup`'s, so that other benchmarks' inputs do not
+ * depend on the order benchmarks are run in.
+ */
+BenchSetup &get_mutable_setup(SyntheticPrgParams const &prg_params);
+
+/**
+ * A setup whose prg is backed by huge pages: allocated with huge pages
+ * enabled, then advised as `genotype --huge_pages` does once loaded.
+ * @see advise_huge_pages()
+ */
+BenchSetup const &get_huge_pages_setup(SyntheticPrgParams const &prg_params);
+
+/** PRG shape from benchmark arguments {num_sites, nesting_depth, num_alleles}*/
+SyntheticPrgParams prg_params_from(benchmark::State const &state);
+
+/** Registers the standard set of PRG shapes as benchmark arguments */
+void prg_shapes(benchmark::internal::Benchmark *bench);
+
+/** Records the PRG's size as a benchmark counter */
+void set_prg_counters(benchmark::State &state, BenchSetup const &setup);
+}  // namespace gram::bench
+
+#endif  // GRAMTOOLS_BENCH_RESOURCES_HPP
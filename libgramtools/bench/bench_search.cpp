@@ -0,0 +1,129 @@
+/** @file
+ * vBWT search: backward base extension, variant marker jumps, and
+ * consolidation of allele-encapsulated mappings.
+ */
+#include "bench_resources.hpp"
+#include "genotype/quasimap/quasimap.hpp"
+#include "genotype/quasimap/search/BWT_search.hpp"
+#include "genotype/quasimap/search/encapsulated_search.hpp"
+#include "genotype/quasimap/search/vBWT_jump.hpp"
+
+using namespace gram;
+using namespace gram::bench;
+
+/** The `SearchState`s of all indexed kmers: where read searches start */
+static SearchStates indexed_search_states(BenchSetup const &setup) {
+  SearchStates result;
+  for (auto const &entry : setup.kmer_index)
+    result.insert(result.end(), entry.second.begin(), entry.second.end());
+  return result;
+}
+
+static void BM_base_next_sa_interval(benchmark::State &state) {
+  auto const &setup = get_setup(prg_params_from(state));
+  auto const &prg_info = setup.prg_info;
+  auto const search_states = indexed_search_states(setup);
+
+  std::array<SA_Index, 5> first_sa_indices{};
+  for (int_Base base = 1; base <= 4; ++base)
+    first_sa_indices[base] = prg_info.reduced_bwt.first_sa_index(base);
+
+  for (auto _ : state) {
+    for (auto const &search_state : search_states) {
+      for (int_Base base = 1; base <= 4; ++base) {
+        benchmark::DoNotOptimize(
+            base_next_sa_interval(base, first_sa_indices[base],
+                                  search_state.sa_interval, prg_info));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * search_states.size() * 4);
+  set_prg_counters(state, setup);
+}
+BENCHMARK(BM_base_next_sa_interval)->Apply(prg_shapes);
+
+static void BM_search_state_vBWT_jumps(benchmark::State &state) {
+  auto const &setup = get_setup(prg_params_from(state));
+  auto const search_states = indexed_search_states(setup);
+
+  for (auto _ : state) {
+    for (auto const &search_state : search_states) {
+      benchmark::DoNotOptimize(
+          search_state_vBWT_jumps(search_state, setup.prg_info));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * search_states.size());
+  set_prg_counters(state, setup);
+}
+BENCHMARK(BM_search_state_vBWT_jumps)->Apply(prg_shapes);
+
+/** Searches all seeding reads, from their 3'-most kmer */
+static void search_reads_backwards(benchmark::State &state,
+                                   BenchSetup const &setup) {
+  auto const kmer_size = setup.parameters.kmers_size;
+  std::vector<Sequence> kmers;
+  for (auto const &read : setup.encoded_reads)
+    kmers.push_back(get_kmer_from_read(kmer_size, read));
+
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kmers.size(); ++i) {
+      benchmark::DoNotOptimize(search_read_backwards(
+          setup.encoded_reads[i], kmers[i], setup.kmer_index, setup.prg_info));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kmers.size());
+  set_prg_counters(state, setup);
+}
+
+static void BM_search_read_backwards(benchmark::State &state) {
+  search_reads_backwards(state, get_setup(prg_params_from(state)));
+}
+BENCHMARK(BM_search_read_backwards)->Apply(prg_shapes);
+
+/**
+ * The same reads, on the same prg backed by huge pages. Only shows a
+ * difference if transparent huge pages are set to `madvise` or `always` in
+ * /sys/kernel/mm/transparent_hugepage/enabled.
+ */
+static void BM_search_read_backwards_huge_pages(benchmark::State &state) {
+  search_reads_backwards(state, get_huge_pages_setup(prg_params_from(state)));
+}
+BENCHMARK(BM_search_read_backwards_huge_pages)->Apply(prg_shapes);
+
+/**
+ * The `SearchStates` of each read at the end of its backward search, before
+ * allele-encapsulated states get consolidated.
+ * @see search_read_backwards()
+ */
+static std::vector<SearchStates> unconsolidated_search_states(
+    BenchSetup const &setup) {
+  std::vector<SearchStates> result;
+  auto const kmer_size = setup.parameters.kmers_size;
+  for (auto const &read : setup.encoded_reads) {
+    auto kmer = get_kmer_from_read(kmer_size, read);
+    auto found = setup.kmer_index.find(kmer);
+    if (found == setup.kmer_index.end()) continue;
+    auto search_states = found->second;
+    for (auto it = read.rbegin() + kmer_size;
+         it != read.rend() && !search_states.empty(); ++it)
+      search_states =
+          process_read_char_search_states(*it, search_states, setup.prg_info);
+    if (!search_states.empty()) result.push_back(search_states);
+  }
+  return result;
+}
+
+static void BM_handle_allele_encapsulated_states(benchmark::State &state) {
+  auto const &setup = get_setup(prg_params_from(state));
+  auto const per_read_states = unconsolidated_search_states(setup);
+
+  for (auto _ : state) {
+    for (auto const &search_states : per_read_states) {
+      benchmark::DoNotOptimize(
+          handle_allele_encapsulated_states(search_states, setup.prg_info));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * per_read_states.size());
+  set_prg_counters(state, setup);
+}
+BENCHMARK(BM_handle_allele_encapsulated_states)->Apply(prg_shapes);
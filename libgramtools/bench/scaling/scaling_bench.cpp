@@ -0,0 +1,481 @@
+/** @file
+ * End-to-end scaling benchmark of `build` and `genotype`.
+ *
+ * A synthetic PRG of configurable size and site density is written to a build
+ * directory, along with its reference; haplotypes are simulated through it
+ * using `simulate`'s `SimulationGenotyper`, and reads sampled from them.
+ * `build`, quasimapping alone and `genotype` are then each run at increasing
+ * thread counts, each run in its own forked process so that its peak RSS can
+ * be measured in isolation.
+ *
+ * Reported per stage and thread count: wall time, throughput in reads/s/core,
+ * speedup and parallel efficiency relative to one thread, and peak RSS.
+ * The quasimap stage isolates `handle_reads_buffer`'s read tasks from
+ * loading, so the thread count at which its efficiency collapses is reported.
+ */
+#include <fcntl.h>
+#include <omp.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <thread>
+
+#include "bench_resources.hpp"
+#include "build/build.hpp"
+#include "build/kmer_index/kmer_filter.hpp"
+#include "build/kmer_index/load.hpp"
+#include "common/dna_kernels.hpp"
+#include "genotype/genotype.hpp"
+#include "genotype/infer/output_specs/segment_tracker.hpp"
+#include "genotype/infer/personalised_reference.hpp"
+#include "genotype/quasimap/quasimap.hpp"
+#include "prg/coverage_graph.hpp"
+#include "prg/linearised_prg.hpp"
+#include "simulate/simulate.hpp"
+
+using namespace gram;
+using namespace gram::bench;
+using namespace gram::genotype;
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+using JSON = nlohmann::json;
+
+struct ScalingParams {
+  fs::path out_dirpath;
+  SyntheticPrgParams prg_params;
+  double sites_per_kb;
+  std::size_t num_haplotypes;
+  double coverage;
+  std::size_t read_length;
+  double error_rate;
+  uint32_t kmer_size;
+  uint32_t max_threads;
+  double efficiency_threshold;
+};
+
+/** What a stage's process reports back to the driver */
+struct StageResult {
+  double seconds;
+  uint64_t num_reads; /**< Processed; 0 for stages not processing reads */
+};
+
+struct StageRun {
+  std::string stage;
+  uint32_t threads;
+  StageResult result;
+  long peak_rss_kb;
+};
+
+static ScalingParams parse_parameters(int argc, char **argv) {
+  ScalingParams params;
+  std::string out_dirpath;
+  po::options_description description("scaling_bench options");
+  description.add_options()("help", "produce help message")(
+      "out_dir", po::value<std::string>(&out_dirpath)->required(),
+      "directory to write the synthetic data, runs and results to")(
+      "num_sites",
+      po::value<std::size_t>(&params.prg_params.num_sites)
+          ->default_value(10000),
+      "number of top-level variant sites in the PRG")(
+      "sites_per_kb",
+      po::value<double>(&params.sites_per_kb)->default_value(20),
+      "site density: top-level sites per kilobase of PRG")(
+      "nesting_depth",
+      po::value<std::size_t>(&params.prg_params.nesting_depth)
+          ->default_value(1),
+      "nesting levels per site; 1: no nesting")(
+      "num_alleles",
+      po::value<std::size_t>(&params.prg_params.num_alleles)->default_value(2),
+      "number of alleles per site")(
+      "num_haplotypes",
+      po::value<std::size_t>(&params.num_haplotypes)->default_value(2),
+      "number of haplotypes to simulate reads from")(
+      "coverage", po::value<double>(&params.coverage)->default_value(30),
+      "mean read depth")(
+      "read_length",
+      po::value<std::size_t>(&params.read_length)->default_value(150))(
+      "error_rate", po::value<double>(&params.error_rate)->default_value(0.001),
+      "per-base substitution rate in the reads")(
+      "kmer_size", po::value<uint32_t>(&params.kmer_size)->default_value(11))(
+      "max_threads",
+      po::value<uint32_t>(&params.max_threads)
+          ->default_value(std::max(1u, std::thread::hardware_concurrency())),
+      "runs at 1, 2, 4... threads up to this")(
+      "efficiency_threshold",
+      po::value<double>(&params.efficiency_threshold)->default_value(0.5),
+      "parallel efficiency below which quasimapping is reported to collapse")(
+      "seed", po::value<uint32_t>(&params.prg_params.seed)->default_value(42));
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, description), vm);
+    if (vm.count("help")) {
+      std::cout << description << std::endl;
+      exit(0);
+    }
+    po::notify(vm);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << description << std::endl;
+    exit(1);
+  }
+  if (params.sites_per_kb <= 0 || params.max_threads == 0 ||
+      params.num_haplotypes == 0 || params.read_length < params.kmer_size)
+    throw std::invalid_argument(
+        "--sites_per_kb, --max_threads and --num_haplotypes must be > 0, and "
+        "--read_length >= --kmer_size");
+
+  params.out_dirpath = fs::absolute(out_dirpath);
+  // Each site spans roughly one allele of sequence
+  auto const site_spacing =
+      static_cast<std::size_t>(1000 / params.sites_per_kb);
+  auto const allele_length = params.prg_params.allele_length;
+  params.prg_params.invariant_length =
+      site_spacing > allele_length ? site_spacing - allele_length : 1;
+  return params;
+}
+
+/**
+ * Parses `args` the way `gramtools genotype` parses its command line, so the
+ * bench runs genotype with the same parameters as the real command.
+ */
+static GenotypeParams genotype_parameters(
+    std::vector<std::string> const &args) {
+  po::options_description command_description;
+  command_description.add_options()("command", po::value<std::string>())(
+      "subargs", po::value<std::vector<std::string>>());
+  po::positional_options_description pos;
+  pos.add("command", 1).add("subargs", -1);
+  auto const parsed = po::command_line_parser(args)
+                          .options(command_description)
+                          .positional(pos)
+                          .allow_unregistered()
+                          .run();
+  po::variables_map vm;
+  po::store(parsed, vm);
+  return commands::genotype::parse_parameters(vm, parsed);
+}
+
+/** The reference: the first allele of every site */
+static std::string first_prg_path(std::string const &prg_string) {
+  std::string path;
+  std::vector<bool> emitting_stack;
+  bool emitting{true};
+  for (auto const c : prg_string) {
+    if (c == '[')
+      emitting_stack.push_back(emitting);
+    else if (c == ',')
+      emitting = false;
+    else if (c == ']') {
+      emitting = emitting_stack.back();
+      emitting_stack.pop_back();
+    } else if (emitting)
+      path.push_back(c);
+  }
+  return path;
+}
+
+/**
+ * Writes the encoded PRG and its reference to `gram_dir`, and reads simulated
+ * from random haplotypes through the PRG to `reads_fpath`.
+ * @return the number of reads written
+ */
+static uint64_t make_synthetic_data(ScalingParams const &params,
+                                    BuildParams const &build_params,
+                                    std::string const &reads_fpath) {
+  auto const prg_string = make_synthetic_prg(params.prg_params);
+  PRG_String prg{prg_string_to_ints(prg_string)};
+  prg.write(build_params.encoded_prg_fpath, endianness::little);
+
+  std::ofstream ref_fhandle(build_params.fasta_ref);
+  ref_fhandle << ">ref" << std::endl << first_prg_path(prg_string) << std::endl;
+
+  coverage_Graph cov_graph{prg};
+  SegmentTracker tracker;
+  std::vector<std::string> haplotypes;
+  for (std::size_t i = 0; i < params.num_haplotypes; ++i) {
+    simulate::SimulationGenotyper gtyper(cov_graph);
+    auto p_ref = get_personalised_ref(cov_graph.root,
+                                      gtyper.get_genotyped_records(), tracker)
+                     .at(0);
+    haplotypes.push_back(p_ref.get_sequence());
+    tracker.reset();
+  }
+
+  std::mt19937 gen(params.prg_params.seed);
+  std::uniform_int_distribution<std::size_t> haplotype_dist(
+      0, haplotypes.size() - 1);
+  std::uniform_int_distribution<int> other_base_dist(1, 3);
+  std::bernoulli_distribution error_dist(params.error_rate);
+  auto const mean_length = haplotypes.front().size();
+  auto const num_reads = static_cast<uint64_t>(
+      params.coverage * mean_length / params.read_length + 1);
+
+  std::ofstream reads_fhandle(reads_fpath);
+  Sequence encoded, reverse;
+  for (uint64_t i = 0; i < num_reads; ++i) {
+    auto const &haplotype = haplotypes[haplotype_dist(gen)];
+    auto const length = std::min(params.read_length, haplotype.size());
+    std::uniform_int_distribution<std::size_t> start_dist(
+        0, haplotype.size() - length);
+    encode_dna_bases(haplotype.substr(start_dist(gen), length), encoded);
+    for (auto &base : encoded)
+      if (error_dist(gen)) base = (base + other_base_dist(gen) - 1) % 4 + 1;
+    if (i % 2 == 1) {
+      reverse_complement_read(encoded, reverse);
+      std::swap(encoded, reverse);
+    }
+    reads_fhandle << "@read" << i << std::endl;
+    for (auto const base : encoded) reads_fhandle << decode_dna_base(base);
+    reads_fhandle << std::endl
+                  << "+" << std::endl
+                  << std::string(length, '?') << std::endl;
+  }
+  return num_reads;
+}
+
+/**
+ * Runs `stage` in a child process with `threads` OpenMP threads, its output
+ * going to `log_fpath`. The driver itself never starts an OpenMP team, which
+ * could not be used from a forked child.
+ */
+template <typename Stage>
+static StageRun run_stage(std::string const &name, uint32_t threads,
+                          fs::path const &log_fpath, Stage const &stage) {
+  std::cout << "Running " << name << " at " << threads << " thread(s)"
+            << std::endl;
+  int fds[2];
+  if (pipe(fds) != 0) throw std::runtime_error("Could not create a pipe");
+
+  std::cout.flush();
+  std::cerr.flush();
+  pid_t const pid = fork();
+  if (pid < 0) throw std::runtime_error("Could not fork " + name);
+  if (pid == 0) {
+    close(fds[0]);
+    int const log_fd = open(log_fpath.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                            0644);
+    dup2(log_fd, STDOUT_FILENO);
+    dup2(log_fd, STDERR_FILENO);
+    int exit_code{0};
+    try {
+      omp_set_num_threads(threads);
+      StageResult const result = stage();
+      if (write(fds[1], &result, sizeof(result)) != sizeof(result))
+        exit_code = 1;
+    } catch (std::exception const &e) {
+      std::cerr << e.what() << std::endl;
+      exit_code = 1;
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    _exit(exit_code);
+  }
+
+  close(fds[1]);
+  StageResult result{};
+  auto const bytes_read = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+  int status;
+  struct rusage usage {};
+  wait4(pid, &status, 0, &usage);
+  if (bytes_read != sizeof(result) || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0)
+    throw std::runtime_error(name + " failed at " + std::to_string(threads) +
+                             " thread(s), see " + log_fpath.generic_string());
+  // On Linux, ru_maxrss is in kilobytes
+  return StageRun{name, threads, result, usage.ru_maxrss};
+}
+
+template <typename Function>
+static double time_seconds(Function const &function) {
+  auto const start = std::chrono::steady_clock::now();
+  function();
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+static std::vector<uint32_t> thread_counts(uint32_t max_threads) {
+  std::vector<uint32_t> counts;
+  for (uint32_t threads = 1; threads < max_threads; threads *= 2)
+    counts.push_back(threads);
+  counts.push_back(max_threads);
+  return counts;
+}
+
+/**
+ * Prints one stage's scaling curve, and adds it to `results`.
+ * @param num_reads reads input to the stage; 0 if it does not process reads
+ * @return the lowest thread count at which parallel efficiency is below
+ * `efficiency_threshold`, or 0 if there is none
+ */
+static uint32_t report_stage(std::vector<StageRun> const &runs,
+                             uint64_t num_reads, double efficiency_threshold,
+                             JSON &results) {
+  auto const &stage = runs.front().stage;
+  double const base_seconds = runs.front().result.seconds;
+  uint32_t collapse_threads{0};
+
+  std::cout << std::endl << stage << std::endl;
+  std::cout << std::setw(8) << "threads" << std::setw(12) << "seconds"
+            << std::setw(16) << "reads/s/core" << std::setw(10) << "speedup"
+            << std::setw(12) << "efficiency" << std::setw(14) << "peak RSS (MB)"
+            << std::endl;
+  for (auto const &run : runs) {
+    double const seconds = run.result.seconds;
+    double const speedup = base_seconds / seconds;
+    double const efficiency = speedup / run.threads;
+    double const reads_per_core = num_reads / seconds / run.threads;
+    std::string const reads_column =
+        num_reads == 0 ? "-" : std::to_string(std::lround(reads_per_core));
+    if (collapse_threads == 0 && efficiency < efficiency_threshold)
+      collapse_threads = run.threads;
+
+    std::cout << std::fixed << std::setprecision(3) << std::setw(8)
+              << run.threads << std::setw(12) << seconds << std::setw(16)
+              << reads_column << std::setw(10) << std::setprecision(2)
+              << speedup << std::setw(12) << efficiency
+              << std::setw(14) << std::setprecision(1)
+              << run.peak_rss_kb / 1024.0 << std::endl;
+    JSON run_results = {{"threads", run.threads},
+                        {"seconds", seconds},
+                        {"speedup", speedup},
+                        {"parallel_efficiency", efficiency},
+                        {"peak_rss_kb", run.peak_rss_kb}};
+    if (num_reads > 0) {
+      run_results["reads_per_second_per_core"] = reads_per_core;
+      run_results["reads_processed"] = run.result.num_reads;
+    }
+    results[stage].push_back(run_results);
+  }
+  return collapse_threads;
+}
+
+int main(int argc, char **argv) {
+  auto const params = parse_parameters(argc, argv);
+  auto const gram_dirpath = params.out_dirpath / "gram_dir";
+  auto const logs_dirpath = params.out_dirpath / "logs";
+  fs::create_directories(gram_dirpath);
+  fs::create_directories(logs_dirpath);
+  auto const reads_fpath =
+      (params.out_dirpath / "reads.fastq").generic_string();
+
+  BuildParams build_params{};
+  fill_common_parameters(build_params, gram_dirpath.generic_string());
+  build_params.sdsl_memory_log_fpath =
+      full_path(gram_dirpath.generic_string(), "sdsl_memory_log");
+  build_params.fasta_ref = (params.out_dirpath / "ref.fasta").generic_string();
+  build_params.kmers_size = params.kmer_size;
+  build_params.all_kmers_flag = false;
+  build_params.max_read_size = params.read_length;
+
+  auto const simulation = run_stage(
+      "simulate", 1, logs_dirpath / "simulate.log", [&]() -> StageResult {
+        uint64_t num_reads;
+        auto const seconds = time_seconds([&]() {
+          num_reads = make_synthetic_data(params, build_params, reads_fpath);
+        });
+        return {seconds, num_reads};
+      });
+  auto const num_reads = simulation.result.num_reads;
+  std::cout << "Simulated " << num_reads << " reads of length "
+            << params.read_length << std::endl;
+
+  std::vector<StageRun> build_runs, quasimap_runs, genotype_runs;
+  for (auto const threads : thread_counts(params.max_threads)) {
+    auto const suffix = "_t" + std::to_string(threads);
+    auto parameters = build_params;
+    parameters.maximum_threads = threads;
+    build_runs.push_back(run_stage(
+        "build", threads, logs_dirpath / ("build" + suffix + ".log"),
+        [&]() -> StageResult {
+          return {time_seconds([&]() { commands::build::run(parameters); }),
+                  0};
+        }));
+  }
+
+  for (auto const threads : thread_counts(params.max_threads)) {
+    auto const suffix = "_t" + std::to_string(threads);
+    auto const run_dirpath =
+        (params.out_dirpath / ("genotype" + suffix)).generic_string();
+    fs::create_directories(run_dirpath);
+    auto const parameters = genotype_parameters(
+        {"genotype", "--gram_dir", gram_dirpath.generic_string(), "--reads",
+         reads_fpath, "--sample_id", "scaling_bench", "--ploidy", "haploid",
+         "--kmer_size", std::to_string(params.kmer_size), "--genotype_dir",
+         run_dirpath, "--max_threads", std::to_string(threads), "--seed",
+         std::to_string(params.prg_params.seed)});
+
+    quasimap_runs.push_back(run_stage(
+        "quasimap", threads, logs_dirpath / ("quasimap" + suffix + ".log"),
+        [&]() -> StageResult {
+          ReadStats readstats;
+          readstats.compute_base_error_rate(reads_fpath);
+          auto const prg_info = load_prg_info(parameters);
+          auto const kmer_index = kmer_index::load(parameters);
+          auto const kmer_filter =
+              KmerFilter::load(parameters.kmer_filter_fpath);
+          QuasimapReadsStats stats;
+          auto const seconds = time_seconds([&]() {
+            stats = quasimap_reads(parameters, kmer_index, kmer_filter,
+                                   prg_info, readstats);
+          });
+          // all_reads_count counts each read once per orientation
+          return {seconds, stats.all_reads_count / 2};
+        }));
+    genotype_runs.push_back(run_stage(
+        "genotype", threads, logs_dirpath / ("genotype" + suffix + ".log"),
+        [&]() -> StageResult {
+          return {time_seconds(
+                      [&]() { commands::genotype::run(parameters, false); }),
+                  num_reads};
+        }));
+  }
+
+  JSON results;
+  results["parameters"] = {
+      {"num_sites", params.prg_params.num_sites},
+      {"sites_per_kb", params.sites_per_kb},
+      {"nesting_depth", params.prg_params.nesting_depth},
+      {"num_alleles", params.prg_params.num_alleles},
+      {"num_haplotypes", params.num_haplotypes},
+      {"num_reads", num_reads},
+      {"read_length", params.read_length},
+      {"kmer_size", params.kmer_size},
+      {"seed", params.prg_params.seed}};
+  results["simulate"] = {{"seconds", simulation.result.seconds},
+                         {"peak_rss_kb", simulation.peak_rss_kb}};
+
+  report_stage(build_runs, 0, params.efficiency_threshold, results);
+  auto const collapse_threads = report_stage(
+      quasimap_runs, num_reads, params.efficiency_threshold, results);
+  report_stage(genotype_runs, num_reads, params.efficiency_threshold, results);
+
+  std::cout << std::endl;
+  if (collapse_threads == 0)
+    std::cout << "Quasimap parallel efficiency stays above "
+              << params.efficiency_threshold << " up to " << params.max_threads
+              << " threads" << std::endl;
+  else
+    std::cout << "Quasimap parallel efficiency falls below "
+              << params.efficiency_threshold << " at " << collapse_threads
+              << " threads" << std::endl;
+  results["quasimap_efficiency_collapse_threads"] = collapse_threads;
+
+  auto const results_fpath = params.out_dirpath / "scaling_results.json";
+  std::ofstream(results_fpath) << std::setw(4) << results << std::endl;
+  std::cout << "Results written to " << results_fpath.generic_string()
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,81 @@
+/** @file
+ * Compact approximate membership filter over the indexed kmers.
+ *
+ * During quasimap, a read orientation whose seed kmer (its 3'-most kmer) is
+ * not in the `gram::KmerIndex` cannot map. The filter lets such reads be
+ * rejected with a single cache line access, before allocating the seed kmer,
+ * reverse complementing the read or hashing into the `KmerIndex`.
+ *
+ * It is a blocked Bloom filter: each kmer sets `num_probes` bits inside one
+ * 512-bit block. There are no false negatives.
+ */
+#ifndef GRAMTOOLS_KMER_FILTER_HPP
+#define GRAMTOOLS_KMER_FILTER_HPP
+
+#include <stdexcept>
+
+#include "kmer_index_types.hpp"
+
+namespace gram {
+
+class KmerFilterException : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+class KmerFilter {
+ public:
+  static constexpr std::size_t words_per_block{8};
+  static constexpr std::size_t num_probes{6};
+
+  /** An empty filter, which lets every read through. */
+  KmerFilter() = default;
+
+  /**
+   * Builds the filter over all kmers of `kmer_index`.
+   * @param bits_per_kmer filter size; 16 gives a false positive rate of
+   * around 0.1%.
+   */
+  KmerFilter(KmerIndex const &kmer_index, uint32_t kmer_size,
+             std::size_t bits_per_kmer = 16);
+
+  bool empty() const { return blocks.empty(); }
+  uint32_t get_kmer_size() const { return kmer_size; }
+  std::size_t size_in_bytes() const { return blocks.size() * sizeof(uint64_t); }
+
+  /** False if `kmer` (of size `kmer_size`) is certainly not indexed */
+  bool may_contain(Sequence const &kmer) const;
+
+  /** False if the read's forward mapping certainly has no seed kmer */
+  bool may_seed(Sequence const &read) const;
+
+  /**
+   * Same as `may_seed`, for the reverse complement of `read`, without
+   * computing the reverse complement.
+   */
+  bool may_seed_reverse_complement(Sequence const &read) const;
+
+  void dump(std::string const &fpath) const;
+  static KmerFilter load(std::string const &fpath);
+
+  bool operator==(KmerFilter const &other) const {
+    return kmer_size == other.kmer_size && blocks == other.blocks;
+  }
+
+ private:
+  uint32_t kmer_size = 0;
+  std::vector<uint64_t> blocks;  // `words_per_block` words per block
+
+  void insert(uint64_t kmer_hash);
+  bool lookup(uint64_t kmer_hash) const;
+};
+
+/**
+ * Hashes `length` bases from `bases`; if `reverse_complement` is set, hashes
+ * the reverse complement of those bases instead.
+ */
+uint64_t hash_kmer(int_Base const *bases, std::size_t length,
+                   bool reverse_complement = false);
+
+}  // namespace gram
+
+#endif  // GRAMTOOLS_KMER_FILTER_HPP
@@ -28,7 +28,8 @@ namespace gram {
  */
 sdsl::int_vector<> generate_allele_mask(const marker_vec &encoded_prg);
 
-sdsl::int_vector<> load_allele_mask(CommonParameters const &parameters);
+/** Mapped read-only if `parameters.map_artefacts` */
+SharedIntVector<> load_allele_mask(CommonParameters const &parameters);
 
 /**
  * Generates an integer vector into the prg of the site number at all indices
@@ -37,7 +38,8 @@ sdsl::int_vector<> load_allele_mask(CommonParameters const &parameters);
  */
 sdsl::int_vector<> generate_sites_mask(const marker_vec &encoded_prg);
 
-sdsl::int_vector<> load_sites_mask(CommonParameters const &parameters);
+/** Mapped read-only if `parameters.map_artefacts` */
+SharedIntVector<> load_sites_mask(CommonParameters const &parameters);
 
 /**
  * Bit vector for variant marker presence in the prg.
@@ -15,6 +15,8 @@ class BuildParams : public CommonParameters {
   uint32_t max_read_size;
   bool all_kmers_flag;
   std::string fasta_ref;
+  uint64_t sa_memory_budget_mb; /**< For suffix array construction; 0:
+                                   unlimited */
 };
 
 namespace commands::build {
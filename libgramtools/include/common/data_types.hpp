@@ -8,6 +8,8 @@
 #include <sdsl/suffix_arrays.hpp>
 #include <sdsl/wavelet_trees.hpp>
 
+#include "common/mapped_files.hpp"
+
 #define FIRST_ALLELE 0
 #define ALLELE_UNKNOWN -1  // This signifier must NEVER be a possible allele ID
 
@@ -36,18 +38,6 @@ using FM_Index =
                  16777216>; /**< The two numbers are the sampling densities for
                                SA and ISA. 1 means all SA entries are stored.*/
 
-/**
- * One bit vector per nucleotide in the BWT of the linearised PRG.
- * We use this to avoid rank/select queries on the BWT itself, which has an
- * extended alphabet due to variant markers.
- */
-struct DNA_BWT_Masks {
-  sdsl::bit_vector mask_a;
-  sdsl::bit_vector mask_c;
-  sdsl::bit_vector mask_g;
-  sdsl::bit_vector mask_t;
-};
-
 // coverage-related
 using CovCount = uint16_t;
 using PerBaseCoverage = std::vector<CovCount>;   /**< Number of reads mapped to
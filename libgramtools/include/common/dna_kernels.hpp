@@ -0,0 +1,43 @@
+/** @file
+ * Bulk DNA encoding and reverse complementation of reads.
+ *
+ * Both kernels write into caller-owned buffers, so that the per-read
+ * allocations can be amortised across reads. On x86-64, AVX2 and SSE4.1
+ * versions are selected at runtime based on CPU support; a table-driven scalar
+ * version is used otherwise. All versions produce identical output.
+ */
+#ifndef GRAMTOOLS_DNA_KERNELS_HPP
+#define GRAMTOOLS_DNA_KERNELS_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "common/utils.hpp"
+
+namespace gram {
+enum class SimdLevel { scalar, sse4, avx2 };
+
+/** Highest instruction set level supported by the running CPU */
+SimdLevel best_simd_level();
+
+/**
+ * Encodes `length` characters of `dna` into `out` (range: 1-4), resizing it
+ * but keeping its capacity. If any character is not in {A,C,G,T} (upper or
+ * lower case), `out` is cleared and false is returned.
+ */
+bool encode_dna_bases(char const *dna, std::size_t length, Sequence &out,
+                      SimdLevel level = best_simd_level());
+
+inline bool encode_dna_bases(std::string const &dna_str, Sequence &out) {
+  return encode_dna_bases(dna_str.data(), dna_str.size(), out);
+}
+
+/**
+ * Writes the reverse complement of `read` into `out`, resizing it but keeping
+ * its capacity. Bases outside of the range 1-4 are complemented to 0.
+ */
+void reverse_complement_read(Sequence const &read, Sequence &out,
+                             SimdLevel level = best_simd_level());
+}  // namespace gram
+
+#endif  // GRAMTOOLS_DNA_KERNELS_HPP
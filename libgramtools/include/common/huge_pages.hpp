@@ -0,0 +1,82 @@
+/** @file
+ * Transparent huge page backing of the structures queried while mapping reads.
+ *
+ * Backward search and suffix array lookups access the prg's structures almost
+ * randomly, so with 4kB pages most of them miss the TLB. Backed by 2MB pages,
+ * the same structures need 512 times fewer TLB entries.
+ * The structures we allocate ourselves get huge-page aligned allocations,
+ * advised before they are first written; those allocated by `sdsl` or `boost`
+ * can only be advised once loaded, and get collapsed into huge pages by the
+ * kernel in the background.
+ * Linux only: elsewhere, advice does nothing.
+ */
+#ifndef GRAMTOOLS_HUGE_PAGES_HPP
+#define GRAMTOOLS_HUGE_PAGES_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace gram::huge_pages {
+constexpr std::size_t page_size = std::size_t{2} << 20;
+
+/** Whether allocations and `advise` ask for huge pages; off by default */
+void enable(bool enabled);
+bool enabled();
+
+/**
+ * If enabled, asks for the pages in [data, data + num_bytes) to be huge pages,
+ * and to be read in now rather than when first accessed. Does nothing
+ * otherwise.
+ */
+void advise(void const *data, std::size_t num_bytes);
+
+/** Asks for huge pages over a whole huge-page aligned allocation */
+void advise_allocation(void *data, std::size_t num_bytes);
+
+/**
+ * Allocates blocks of at least one huge page aligned on huge pages, so that
+ * they can be wholly backed by them; smaller blocks are allocated as usual.
+ */
+template <typename T>
+struct Allocator {
+  using value_type = T;
+
+  Allocator() = default;
+  template <typename U>
+  Allocator(Allocator<U> const &) {}
+
+  T *allocate(std::size_t n) {
+    auto num_bytes = n * sizeof(T);
+    if (num_bytes < page_size)
+      return static_cast<T *>(::operator new(num_bytes));
+    num_bytes = (num_bytes + page_size - 1) / page_size * page_size;
+    auto data = std::aligned_alloc(page_size, num_bytes);
+    if (data == nullptr) throw std::bad_alloc();
+    advise_allocation(data, num_bytes);
+    return static_cast<T *>(data);
+  }
+
+  void deallocate(T *data, std::size_t n) {
+    if (n * sizeof(T) < page_size)
+      ::operator delete(data);
+    else
+      std::free(data);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(Allocator<T> const &, Allocator<U> const &) {
+  return true;
+}
+template <typename T, typename U>
+bool operator!=(Allocator<T> const &, Allocator<U> const &) {
+  return false;
+}
+
+template <typename T>
+using Vector = std::vector<T, Allocator<T>>;
+}  // namespace gram::huge_pages
+
+#endif  // GRAMTOOLS_HUGE_PAGES_HPP
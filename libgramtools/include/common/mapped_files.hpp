@@ -0,0 +1,42 @@
+/** @file
+ * Loading of the `sdsl` vectors stored by `build`, either copied into memory
+ * or mapped read-only from their files.
+ *
+ * Mapped files are shared: all processes mapping the same file, eg several
+ * `genotype` runs against one `gram_dir`, use the same physical pages, and
+ * pages are only read in when first accessed.
+ */
+#ifndef GRAMTOOLS_MAPPED_FILES_HPP
+#define GRAMTOOLS_MAPPED_FILES_HPP
+
+#include <memory>
+#include <sdsl/int_vector_mapper.hpp>
+#include <sdsl/vectors.hpp>
+#include <string>
+
+namespace gram {
+template <uint8_t width = 0>
+using SharedIntVector = std::shared_ptr<sdsl::int_vector<width> const>;
+using SharedBitVector = SharedIntVector<1>;
+
+/**
+ * @return the vector stored at `fpath`, mapped read-only. It stays mapped
+ * while the returned pointer, or any copy of it, lives.
+ */
+template <uint8_t width = 0>
+SharedIntVector<width> map_int_vector(std::string const &fpath) {
+  auto mapper = std::make_shared<sdsl::read_only_mapper<width>>(fpath);
+  return SharedIntVector<width>(mapper, &mapper->wrapper());
+}
+
+/** @param mapped whether to map the vector, rather than copy it */
+template <uint8_t width = 0>
+SharedIntVector<width> load_int_vector(std::string const &fpath, bool mapped) {
+  if (mapped) return map_int_vector<width>(fpath);
+  auto vector = std::make_shared<sdsl::int_vector<width>>();
+  sdsl::load_from_file(*vector, fpath);
+  return vector;
+}
+}  // namespace gram
+
+#endif  // GRAMTOOLS_MAPPED_FILES_HPP
@@ -0,0 +1,82 @@
+/** @file
+ * NUMA placement of the read-only data structures mapping reads, and of the
+ * threads mapping them.
+ *
+ * On a multi-socket host, memory gets allocated on the node of the thread that
+ * first touches it, so structures loaded by one thread all sit on its node and
+ * the threads of the other nodes query them remotely. Interleaving their pages
+ * over all nodes spreads that remote traffic evenly, and pinning threads keeps
+ * them on the node the scheduler started them on.
+ * Linux only: elsewhere, or on single-node hosts, all of this does nothing.
+ */
+#ifndef GRAMTOOLS_NUMA_HPP
+#define GRAMTOOLS_NUMA_HPP
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gram::numa {
+/** Parses a sysfs list such as "0-3,8,10-11" */
+std::vector<int> parse_list(std::string const &list);
+
+/** The online NUMA nodes; {0} if unknown */
+std::vector<int> online_nodes();
+
+/** The CPUs of a node; empty if unknown */
+std::vector<int> node_cpus(int node);
+
+/**
+ * While in scope, interleaves the pages allocated by the calling thread and by
+ * the threads of OpenMP parallel regions over all online nodes. A memory
+ * policy belongs to a thread: threads created meanwhile inherit that of the
+ * thread creating them, and other threads keep theirs.
+ */
+class ScopedInterleave {
+ public:
+  /** @param enabled if false, does nothing */
+  explicit ScopedInterleave(bool enabled);
+  ~ScopedInterleave() { stop(); }
+  ScopedInterleave(ScopedInterleave const &) = delete;
+  ScopedInterleave &operator=(ScopedInterleave const &) = delete;
+
+  /** Allocations get the default, local, policy again */
+  void stop();
+
+ private:
+  bool interleaving = false;
+};
+
+/**
+ * While in scope, pins the threads of OpenMP parallel regions to nodes:
+ * consecutive thread numbers to the same node, as many threads to each node.
+ * The calling thread, which runs thread number 0, is pinned too.
+ */
+class ScopedPinning {
+ public:
+  /** @param enabled if false, does nothing */
+  explicit ScopedPinning(bool enabled);
+  ~ScopedPinning() { stop(); }
+  ScopedPinning(ScopedPinning const &) = delete;
+  ScopedPinning &operator=(ScopedPinning const &) = delete;
+
+  /** All threads get the CPUs the calling thread had before pinning again */
+  void stop();
+
+ private:
+  bool pinned = false;
+  std::vector<int> original_cpus;
+};
+
+/**
+ * Resident memory per node, in kilobytes, as listed in a `numa_maps` file.
+ */
+std::map<int, uint64_t> resident_kb_per_node(std::istream &numa_maps);
+
+/** Resident memory of this process per node; empty if unknown */
+std::map<int, uint64_t> resident_kb_per_node();
+}  // namespace gram::numa
+
+#endif  // GRAMTOOLS_NUMA_HPP
@@ -41,18 +41,29 @@ class CommonParameters {
   std::string prg_coords_fpath;
   std::string fm_index_fpath;
   std::string cov_graph_fpath;
+  std::string end_positions_fpath;
+  std::string sa_locus_runs_fpath;
+  std::string reduced_bwt_fpath;
   std::string sites_mask_fpath;
   std::string allele_mask_fpath;
 
   // kmer index file paths
   std::string kmer_index_fpath;
   std::string kmers_fpath;
+  std::string kmer_filter_fpath;
   std::string kmers_stats_fpath;
   std::string sa_intervals_fpath;
   std::string paths_fpath;
 
   uint32_t kmers_size;
   uint32_t maximum_threads;
+  /** Map the reduced BWT and BWT markers mask (and masks loaded through
+   * `load_allele_mask`/`load_sites_mask`) read-only, rather than copy them into
+   * memory. The FM index and kmer index, the largest structures, are still
+   * loaded into memory. */
+  bool map_artefacts = false;
+  bool huge_pages = false; /**< Back the structures mapping reads with
+                              transparent huge pages */
 };
 
 std::string full_path(const std::string& base_dirpath,
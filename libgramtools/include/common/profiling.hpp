@@ -0,0 +1,137 @@
+/** @file
+ * Profiling of a gramtools run, serialised to json.
+ *
+ * Three kinds of measurements are recorded:
+ * * Stages: coarse, nested phases of a run (eg loading, quasimapping,
+ * genotyping). They are opened and closed on the main thread, and record wall
+ * time, resident set size (RSS) and, if enabled, hardware counters summed over
+ * all threads.
+ * * Timers: fine-grained scoped timers in the mapping hot path (eg seeding,
+ * extension, vBWT jumps). They nest per thread and are merged across threads.
+ * As they time every call, they are off unless detailed profiling is enabled.
+ * * Counters: per-thread counts of events (eg reads seeded, vBWT jumps taken).
+ */
+#ifndef GRAMTOOLS_PROFILING_HPP
+#define GRAMTOOLS_PROFILING_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace gram::profiling {
+using JSON = nlohmann::json;
+
+enum class Counter : std::size_t {
+  reads_seeded,          /**< Reads whose seed kmer has search states */
+  search_states_created, /**< By extending search states by one base */
+  sa_entries_touched,    /**< Suffix array entries scanned for markers */
+  vBWT_jumps,            /**< Variant markers jumped across */
+  num_counters
+};
+constexpr std::size_t num_counters =
+    static_cast<std::size_t>(Counter::num_counters);
+using Counts = std::array<uint64_t, num_counters>;
+
+std::string counter_name(Counter counter);
+
+struct TimerNode;
+
+namespace detail {
+/** Counts and timers of one thread. Defined in the translation unit. */
+struct ThreadProfile;
+
+extern std::atomic<bool> detailed_enabled;
+extern thread_local Counts *this_thread_counts;
+
+/**
+ * Registers the calling thread, the first time it records anything.
+ * @return the thread's counts
+ */
+Counts *register_thread();
+}  // namespace detail
+
+/**
+ * Turns on timers and, if `hardware_counters`, cycle and cache miss counters
+ * from `perf_event_open`. Hardware counters are skipped, with a warning, where
+ * the kernel does not allow them.
+ */
+void enable_detailed(bool hardware_counters);
+
+/**
+ * Restarts the kernel's peak RSS at the start of each stage, so that a stage's
+ * peak is its own rather than that of the run so far. This lowers the peak
+ * that `getrusage` and /proc/self/status report for the whole process: leave
+ * it off when measuring those.
+ */
+void enable_peak_rss_per_stage();
+
+inline bool detailed_enabled() {
+  return detail::detailed_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Clears all recorded measurements, and disables detailed profiling and peak
+ * RSS per stage. Must not be called while stages or timers are open.
+ */
+void reset();
+
+inline void increment(Counter counter, uint64_t amount = 1) {
+  auto *counts = detail::this_thread_counts;
+  if (counts == nullptr) counts = detail::register_thread();
+  (*counts)[static_cast<std::size_t>(counter)] += amount;
+}
+
+/** Opens a stage nested in the currently open stage. Main thread only. */
+void begin_stage(std::string name);
+
+/** Closes the innermost open stage. Main thread only. */
+void end_stage();
+
+class ScopedStage {
+ public:
+  explicit ScopedStage(std::string name) { begin_stage(std::move(name)); }
+  ~ScopedStage() { end_stage(); }
+  ScopedStage(ScopedStage const &) = delete;
+  ScopedStage &operator=(ScopedStage const &) = delete;
+};
+
+/**
+ * Times its scope, nested in the calling thread's innermost open timer.
+ * @param name identifies the timer among its siblings: pass a string literal.
+ */
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(char const *name) {
+    if (detailed_enabled()) start(name);
+  }
+  ~ScopedTimer() {
+    if (node != nullptr) stop();
+  }
+  ScopedTimer(ScopedTimer const &) = delete;
+  ScopedTimer &operator=(ScopedTimer const &) = delete;
+
+ private:
+  void start(char const *name);
+  void stop();
+
+  detail::ThreadProfile *profile = nullptr;
+  TimerNode *node = nullptr;
+  std::chrono::steady_clock::time_point start_time;
+};
+
+/** Resident set size of the process, in kilobytes; 0 if unavailable */
+uint64_t current_rss_kb();
+
+/**
+ * All measurements: stages, timers merged across threads, and counters per
+ * thread and in total.
+ */
+JSON to_json();
+
+void write_json(std::string const &fpath);
+}  // namespace gram::profiling
+
+#endif  // GRAMTOOLS_PROFILING_HPP
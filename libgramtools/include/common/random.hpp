@@ -1,6 +1,7 @@
 #ifndef GRAMTOOLS_RANDOM_HPP
 #define GRAMTOOLS_RANDOM_HPP
 
+#include <array>
 #include <cstdint>
 
 namespace gram {
@@ -26,6 +27,37 @@ class RandomInclusiveInt : public RandomGenerator {
  private:
   uint32_t random_seed;
 };
+
+/**
+ * Counter-based random numbers: Philox4x32-10 (Salmon et al., "Parallel random
+ * numbers: as easy as 1, 2, 3", 2011). Each draw is a pure function of a key
+ * and a counter, so that the draws of different counters are independent of
+ * each other, and of the order and thread they are made in. Construction costs
+ * nothing.
+ */
+class CounterRandom : public RandomGenerator {
+ public:
+  using Counter = std::array<uint32_t, 4>;
+  using Key = std::array<uint32_t, 2>;
+
+  /**
+   * @param seed the key
+   * @param stream numbers the sequence of draws; its last word is overwritten
+   * by the draw number
+   */
+  CounterRandom(uint64_t seed, Counter const &stream)
+      : key{uint32_t(seed), uint32_t(seed >> 32)}, counter(stream) {}
+
+  /** Successive calls make successive draws */
+  uint32_t generate(uint32_t min, uint32_t max) const override;
+
+  static Counter philox(Counter counter, Key key);
+
+ private:
+  Key key;
+  Counter counter;
+  mutable uint32_t num_draws = 0;
+};
 }  // namespace gram
 
 #endif  // GRAMTOOLS_RANDOM_HPP
@@ -0,0 +1,85 @@
+/** @file
+ * A set stored as a sorted array.
+ *
+ * Selecting the mapping instance of a read builds many small sets of sites and
+ * loci: a read crosses a handful of them. Kept sorted in one vector, they
+ * allocate once rather than once per element, are scanned linearly, and keep
+ * their storage when cleared for the next read.
+ */
+#ifndef GRAMTOOLS_SORTED_ARRAY_HPP
+#define GRAMTOOLS_SORTED_ARRAY_HPP
+
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
+namespace gram {
+template <typename T>
+class SortedArray {
+ public:
+  using value_type = T;
+  using const_iterator = typename std::vector<T>::const_iterator;
+  using iterator = const_iterator;
+
+  SortedArray() = default;
+
+  SortedArray(std::initializer_list<T> elements) : elements(elements) {
+    std::sort(this->elements.begin(), this->elements.end());
+    this->elements.erase(
+        std::unique(this->elements.begin(), this->elements.end()),
+        this->elements.end());
+  }
+
+  /** @return false if `element` was already in */
+  bool insert(T const &element) {
+    auto const position =
+        std::lower_bound(elements.begin(), elements.end(), element);
+    if (position != elements.end() && *position == element) return false;
+    elements.insert(position, element);
+    return true;
+  }
+
+  /** Inserts all elements of `other`, in one pass over both */
+  void merge(SortedArray const &other) {
+    if (other.empty()) return;
+    auto const middle = elements.size();
+    elements.insert(elements.end(), other.begin(), other.end());
+    std::inplace_merge(elements.begin(), elements.begin() + middle,
+                       elements.end());
+    elements.erase(std::unique(elements.begin(), elements.end()),
+                   elements.end());
+  }
+
+  const_iterator find(T const &element) const {
+    auto const position =
+        std::lower_bound(elements.begin(), elements.end(), element);
+    if (position != elements.end() && *position == element) return position;
+    return elements.end();
+  }
+
+  bool contains(T const &element) const { return find(element) != end(); }
+
+  /** Empties the array, keeping its storage */
+  void clear() { elements.clear(); }
+
+  std::size_t size() const { return elements.size(); }
+  bool empty() const { return elements.empty(); }
+  const_iterator begin() const { return elements.begin(); }
+  const_iterator end() const { return elements.end(); }
+  T const &operator[](std::size_t index) const { return elements[index]; }
+
+  bool operator==(SortedArray const &other) const {
+    return elements == other.elements;
+  }
+  bool operator!=(SortedArray const &other) const { return !(*this == other); }
+  /** Lexicographic, as for `std::set` */
+  bool operator<(SortedArray const &other) const {
+    return elements < other.elements;
+  }
+
+ private:
+  std::vector<T> elements;
+};
+}  // namespace gram
+
+#endif  // GRAMTOOLS_SORTED_ARRAY_HPP
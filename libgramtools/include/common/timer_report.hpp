@@ -6,6 +6,7 @@
 namespace gram {
 class TimerReport {
  public:
+  /** Also opens a profiling stage named `note`, closed by `stop` */
   void start(std::string note);
 
   void stop();
@@ -0,0 +1,201 @@
+/** @file
+ * Columnar binary store of genotyped PRG sites, for many samples.
+ *
+ * Sites are keyed by their index in the PRG. Each site holds a dictionary of
+ * its alleles; samples refer to alleles by dictionary index. The dictionary is
+ * append-only, so adding a sample never rewrites the samples already stored.
+ *
+ * Each sample's GT, HAPG, COV, DP and GT_CONF are stored as separate
+ * variable-length (varint) encoded columns, with an offset every `block_size`
+ * sites. A reader can thus load one sample's columns, or decode one site
+ * across all samples, without reading the rest of the file.
+ */
+#ifndef GTYPE_STORE_HPP
+#define GTYPE_STORE_HPP
+
+#include <array>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "genotype/infer/types.hpp"
+#include "json_prg_spec.hpp"
+
+namespace gram::genotype {
+class SegmentTracker;
+}
+
+namespace gram::genotype::output_spec {
+using namespace gram::genotype::infer;
+
+class GenotypeStoreException : public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * A site's position, segment and allele dictionary
+ */
+struct stored_site {
+  std::size_t pos;
+  std::string segment;
+  strings alleles;  // First allele is the site's reference allele
+
+  bool operator==(stored_site const& other) const {
+    return pos == other.pos && segment == other.segment &&
+           alleles == other.alleles;
+  }
+};
+
+/**
+ * One sample's genotype call at one site
+ */
+struct stored_call {
+  GtypedIndices genotype;  // Indices into the site's alleles; {-1} if null
+  AlleleIds haplogroups;
+  allele_coverages allele_covs;  // One per site allele
+  std::size_t total_coverage = 0;
+  double gt_conf = 0.;
+
+  bool is_null() const { return genotype.size() > 0 && genotype.at(0) == -1; }
+  bool operator==(stored_call const& other) const {
+    return genotype == other.genotype && haplogroups == other.haplogroups &&
+           allele_covs == other.allele_covs &&
+           total_coverage == other.total_coverage && gt_conf == other.gt_conf;
+  }
+};
+using stored_calls = std::vector<stored_call>;
+
+enum class StoreColumn { GT, HAPG, COV, DP, GT_CONF };
+constexpr std::size_t num_store_columns{5};
+
+/**
+ * Encoded column of one sample: bytes, plus the byte offset at which each
+ * block of `block_size` sites starts.
+ */
+struct store_column {
+  std::string bytes;
+  std::vector<uint64_t> block_offsets;
+};
+using sample_columns = std::array<store_column, num_store_columns>;
+
+namespace store_encoding {
+void put_varint(std::string& out, uint64_t val);
+uint64_t get_varint(char const*& ptr, char const* end);
+void put_double(std::string& out, double val);
+double get_double(char const*& ptr, char const* end);
+uint64_t zigzag(int64_t val);
+int64_t unzigzag(uint64_t val);
+
+/** Encodes one call into each of the columns */
+void encode_call(stored_call const& call, sample_columns& columns);
+/** Decodes the call of column `col` at `ptr` into `call`, advancing `ptr` */
+void decode_column_entry(StoreColumn col, char const*& ptr, char const* end,
+                         stored_call& call, std::size_t num_alleles);
+}  // namespace store_encoding
+
+class GenotypeStoreReader;
+
+/**
+ * Accumulates samples in columnar form, and writes them to disk.
+ * Samples are added all or none: if an input throws, the store is left as it
+ * was.
+ */
+class GenotypeStore {
+ private:
+  std::size_t block_size;
+  std::string model;
+  std::vector<stored_site> sites;
+  std::vector<std::unordered_map<std::string, std::size_t>> allele_indices;
+  strings sample_names;
+  std::vector<sample_columns> columns;
+
+  /**
+   * Checks `pos`, `segment` and reference allele against stored site number
+   * `site_index` (or initialises it if this is the first sample), and returns
+   * the dictionary index of each of `alleles`, adding those not yet seen.
+   */
+  std::vector<std::size_t> register_alleles(std::size_t site_index,
+                                            std::size_t pos,
+                                            std::string const& segment,
+                                            strings const& alleles);
+  /** Allele dictionary sizes, to roll back to with `truncate_alleles` */
+  std::vector<std::size_t> num_alleles_per_site() const;
+  /** Drops the sites and alleles registered past `num_alleles` */
+  void truncate_alleles(std::vector<std::size_t> const& num_alleles);
+  void check_compatible(std::size_t num_input_sites,
+                        std::string const& input_model);
+  void add_call(sample_columns& sample_cols, std::size_t site_index,
+                stored_call const& call);
+
+ public:
+  explicit GenotypeStore(std::size_t block_size = 256)
+      : block_size(block_size == 0 ? 1 : block_size) {}
+
+  /** Adds all samples of a (possibly combined) JSON PRG */
+  void add_samples(json::Json_Prg& json_prg);
+
+  /**
+   * Adds one sample straight from genotyped sites, as `add_samples` would from
+   * their JSON PRG. `tracker` must be at the start of the prg.
+   */
+  void add_sample(std::string const& sample_name, gt_sites const& sites,
+                  SegmentTracker& tracker, std::string const& gtyping_model);
+
+  /** Merges in all samples of an on-disk store */
+  void add_samples(GenotypeStoreReader& reader);
+
+  std::size_t num_sites() const { return sites.size(); }
+  std::size_t num_samples() const { return sample_names.size(); }
+
+  void write(std::string const& fpath) const;
+  void write(std::ostream& out) const;
+};
+
+/**
+ * Random access into a store written by `GenotypeStore`, by site and by
+ * sample. Only the header, site dictionaries and column directory are loaded
+ * upfront.
+ */
+class GenotypeStoreReader {
+ private:
+  std::ifstream fhandle;
+  std::size_t block_size;
+  std::string model;
+  std::vector<stored_site> sites;
+  strings sample_names;
+  struct column_entry {
+    std::vector<uint64_t> block_offsets;
+    uint64_t data_offset, length;
+  };
+  std::vector<std::array<column_entry, num_store_columns>> directory;
+  std::streampos data_start;
+
+  void read_header();
+  std::string read_column_bytes(column_entry const& entry, uint64_t start,
+                                uint64_t end);
+  void decode_column(StoreColumn col, column_entry const& entry,
+                     std::size_t first_site, std::size_t last_site,
+                     stored_calls& calls);
+
+ public:
+  explicit GenotypeStoreReader(std::string const& fpath);
+
+  std::size_t num_sites() const { return sites.size(); }
+  std::size_t num_samples() const { return sample_names.size(); }
+  std::string const& get_model() const { return model; }
+  strings const& get_sample_names() const { return sample_names; }
+  stored_site const& get_site(std::size_t site_index) const {
+    return sites.at(site_index);
+  }
+
+  /** One sample's call at one site */
+  stored_call get_call(std::size_t site_index, std::size_t sample_index);
+  /** All samples' calls at one site */
+  stored_calls get_site_calls(std::size_t site_index);
+  /** One sample's calls at all sites */
+  stored_calls get_sample_calls(std::size_t sample_index);
+};
+}  // namespace gram::genotype::output_spec
+
+#endif  // GTYPE_STORE_HPP
@@ -1,9 +1,11 @@
 #ifndef PRG_JSON_SPEC
 #define PRG_JSON_SPEC
 
+#include <ostream>
 #include <utility>
 
 #include "fields.hpp"
+#include "json_site_spec.hpp"
 
 namespace gram::json {
 
@@ -24,6 +26,50 @@ class Json_Prg {
   JSON& get_prg() { return json_prg; }
   void set_prg(JSON const& input_json);
 };
+
+/**
+ * Throws if two JSON PRGs cannot be combined (different models, PRGs, site
+ * fields or number of sites).
+ */
+void check_combinable(JSON const& first, JSON const& second);
+
+/**
+ * Merges N JSON PRGs in one pass over sites, instead of folding them pairwise
+ * through `Json_Prg::combine_with` (which rescales every already-combined
+ * sample at each step, making N samples O(N^2)).
+ * Each site's allele union is built once from all inputs, and the combined
+ * JSON is written out in chunks of sites, merged in parallel.
+ */
+class Json_Prg_Merger {
+ private:
+  JSON header;  // Everything but "Sites", with the combined "Samples"
+  std::vector<JSON> inputs;
+  std::size_t num_sites;
+
+  void combine_samples(bool force);
+
+ public:
+  explicit Json_Prg_Merger(std::vector<JSON> input_jsons, bool force = false);
+
+  std::size_t get_num_sites() const { return num_sites; }
+  JSON const& get_header() const { return header; }
+
+  /**
+   * Combines site number `site_index` across all inputs; the inputs' copies of
+   * that site are consumed. Different sites can be merged concurrently.
+   */
+  Json_Site merge_site(std::size_t site_index);
+
+  /**
+   * Streams the combined JSON to `out`, merging `chunk_size` sites at a time
+   * in parallel. Output is the same as `merge()`'s; see
+   * `Json_Site::combine_all` for how it differs from pairwise combining.
+   */
+  void write(std::ostream& out, std::size_t chunk_size = 1000);
+
+  /** Builds the whole combined JSON in memory. */
+  JSON merge();
+};
 }  // namespace gram::json
 
 #endif  // PRG_JSON_SPEC
@@ -25,7 +25,7 @@ class Json_Site {
     json_site.emplace("SEG", "");
   }
 
-  Json_Site(JSON const input_json) : json_site(input_json) {}
+  Json_Site(JSON input_json) : json_site(std::move(input_json)) {}
 
   // ____Functions implementing site combining____
   void build_allele_combi_map(JSON const &json_site, allele_combi_map &m);
@@ -36,6 +36,18 @@ class Json_Site {
                                        std::string const gtyping_model);
   void combine_with(Json_Site &other, std::string const &gtyping_model = "");
 
+  /**
+   * Combines any number of sites in a single pass: the union of called alleles
+   * is built once over all sites, and each site's entries are rescaled once.
+   * Differs from folding the sites through `combine_with` in one way: if a
+   * later site calls an allele no earlier site called, the fold has already
+   * dropped the earlier sites' COV for it (leaving 0), whereas here every
+   * site keeps its COV for every allele in the union.
+   * The input sites are consumed.
+   */
+  static Json_Site combine_all(std::vector<Json_Site> &sites,
+                               std::string const &gtyping_model = "");
+
   JSON const &get_site() const { return json_site; }
   JSON &get_site() { return json_site; }
 
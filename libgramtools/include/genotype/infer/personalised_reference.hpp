@@ -17,10 +17,15 @@ class Fasta {
   std::string sequence;
 
  public:
-  std::string const& get_sequence() { return sequence; }
+  std::string const& get_sequence() const { return sequence; }
   void set_ID(std::string new_ID) { this->ID = new_ID; }
   void set_desc(std::string new_desc) { this->desc = new_desc; }
   void add_sequence(std::string const& seq) { sequence += seq; }
+  void add_sequence(std::string const& seq, std::size_t start,
+                    std::size_t length) {
+    sequence.append(seq, start, length);
+  }
+  void reserve(std::size_t length) { sequence.reserve(length); }
 
   friend bool operator<(const Fasta& first, const Fasta& second);
   friend std::ostream& operator<<(std::ostream& out_stream, const Fasta& input);
@@ -37,12 +42,54 @@ class InconsistentPloidyException : public std::exception {
   }
 };
 
+/**
+ * A stretch of a personalised reference: either a substring of an invariant
+ * coverage graph node, or (if `node` is null) the genotyped alleles of a site.
+ */
+struct ref_piece {
+  covG_ptr node;
+  std::size_t start, length;
+  std::size_t site_index;
+};
+
+struct ref_segment {
+  std::string ID;
+  std::vector<ref_piece> pieces;
+};
+using ref_plan = std::vector<ref_segment>;
+
 allele_vector get_all_alleles_to_paste(gt_site_ptr const& site,
                                        std::size_t ploidy);
+
+/**
+ * Walks the coverage graph once, recording for each segment which node
+ * substrings and sites make it up, without copying any sequence.
+ */
+ref_plan plan_personalised_ref(covG_ptr graph_root,
+                               gt_sites const& genotyped_records,
+                               SegmentTracker& tracker);
+
+/** Builds the `ploidy` personalised references of one planned segment */
+Fastas build_segment(ref_segment const& segment,
+                     gt_sites const& genotyped_records, std::size_t ploidy);
+
 Fastas get_personalised_ref(covG_ptr graph_root,
                             gt_sites const& genotyped_records,
                             SegmentTracker& tracker);
 
+/**
+ * Streams the personalised references to `out`, one batch of segments at a
+ * time, with segments in a batch built in parallel. Only the first of
+ * identical sequences is written. Written sequences are recorded by hash and
+ * length, and rebuilt to compare if need be, so the whole reference is never
+ * held in memory.
+ * @return the number of sequences written
+ */
+std::size_t write_personalised_ref(std::ostream& out, covG_ptr graph_root,
+                                   gt_sites const& genotyped_records,
+                                   SegmentTracker& tracker,
+                                   std::string const& desc);
+
 void add_description(Fastas& p_refs, std::string const& desc);
 }  // namespace gram::genotype
 
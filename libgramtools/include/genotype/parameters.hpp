@@ -19,16 +19,26 @@ class GenotypeParams : public CommonParameters {
   std::string allele_base_coverage_fpath;
   std::string grouped_allele_counts_fpath;
   std::string read_stats_fpath;
+  std::string quasimap_progress_fpath;
 
   Ploidy ploidy;
   std::string sample_id;
   std::string genotyped_json_fpath;
   std::string genotyped_vcf_fpath;
+  std::string genotyped_store_fpath;
   std::string personalised_ref_fpath;
 
   std::string debug_fpath;
+  std::string profile_fpath;
 
   uint32_t seed;
+  bool profile = false; /**< Record fine-grained timers and hardware counters */
+  bool numa = false; /**< Interleave loaded structures over NUMA nodes, and pin
+                        mapping threads to nodes */
+  uint64_t read_cache_mb = 0; /**< Memory budget of the `ReadCache`; 0 turns
+                                 it off */
+  uint64_t suffix_cache_mb = 0; /**< Memory budget of the `SuffixCache`; 0
+                                   turns it off */
 };
 
 namespace commands::genotype {
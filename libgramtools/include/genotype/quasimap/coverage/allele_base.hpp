@@ -31,7 +31,8 @@ namespace record {
  * `SearchStates`, can have different mapping instances going through the same
  * `VariantLocus`.
  */
-void allele_base(PRG_Info const& prg_info, SearchStates const& search_states,
+void allele_base(PRG_Info const& prg_info,
+                 SearchStateViews const& search_states,
                  uint64_t const& read_length);
 }  // namespace record
 
@@ -134,7 +135,8 @@ class Traverser {
  public:
   Traverser() {}
 
-  Traverser(node_access start_point, VariantSitePath traversed_loci,
+  /** `traversed_loci` is viewed, not copied: it must outlive the traversal */
+  Traverser(node_access start_point, VariantSitePath const& traversed_loci,
             std::size_t read_size);
 
   std::optional<covG_ptr> next_Node();
@@ -176,7 +178,7 @@ class Traverser {
  private:
   covG_ptr cur_Node;
   std::size_t bases_remaining;
-  VariantSitePath traversed_loci;
+  VariantSitePath const* traversed_loci;
   uint32_t traversed_index;
   bool first_node;
   node_coordinate start_pos;
@@ -191,6 +193,8 @@ class PbCovRecorder {
  public:
   PbCovRecorder(PRG_Info const& prg_info, SearchStates const& search_states,
                 std::size_t read_size);
+  PbCovRecorder(PRG_Info const& prg_info,
+                SearchStateViews const& search_states, std::size_t read_size);
 
   // Testing-related constructors
   PbCovRecorder() = default;
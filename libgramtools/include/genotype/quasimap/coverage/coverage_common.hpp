@@ -8,6 +8,7 @@
 #ifndef GRAMTOOLS_TEST_RESOURCES_HPP
 #define GRAMTOOLS_TEST_RESOURCES_HPP
 
+#include "common/sorted_array.hpp"
 #include "genotype/parameters.hpp"
 #include "genotype/quasimap/coverage/types.hpp"
 #include "genotype/quasimap/search/types.hpp"
@@ -15,6 +16,16 @@
 
 namespace gram {
 
+/**
+ * Identifies an orientation of a read among all the reads mapped: the random
+ * selection of its mapping instance depends on it and the seed only, not on
+ * the thread count or the order reads get mapped in.
+ */
+struct ReadID {
+  uint64_t ordinal = 0; /**< In the order reads are read in */
+  bool reverse_complement = false;
+};
+
 /**
  * Each type of coverage operation (record, generate, dump) operates on each
  * level of coverage information.
@@ -26,7 +37,8 @@ namespace coverage::record {
  */
 void search_states(Coverage &coverage, const SearchStates &search_states,
                    const uint64_t &read_length, const PRG_Info &prg_info,
-                   const uint32_t &random_seed = 0);
+                   const uint32_t &random_seed = 0,
+                   ReadID const &read_id = {});
 }  // namespace coverage::record
 
 namespace coverage::generate {
@@ -44,7 +56,7 @@ namespace coverage::dump {
 void all(const Coverage &coverage, const GenotypeParams &parameters);
 }  // namespace coverage::dump
 
-using SitePath = std::set<Marker>;
+using SitePath = SortedArray<Marker>;
 
 class RandomGenerator;
 
@@ -54,8 +66,8 @@ using rand_ptr = RandomGenerator *const;
  * A set of site marker IDs signalling non-nested bubbles. One set defines an
  * equivalence class.
  */
-using level0_Sites = std::set<Marker>;
-using uniqueLoci = std::set<VariantLocus>;
+using level0_Sites = SortedArray<Marker>;
+using uniqueLoci = SortedArray<VariantLocus>;
 
 using info_ptr = PRG_Info const *const;
 
@@ -67,18 +79,29 @@ using info_ptr = PRG_Info const *const;
  * equivalence class.
  *  - unique_loci: this is a set of `VariantLocus` that the processed
  * `SearchState` is compatible with (data struct: `uniqueLoci`).
+ *
+ * The `SearchState` is viewed, not copied: it must outlive the `LocusFinder`.
  */
 class LocusFinder {
  public:
-  LocusFinder() : search_state(), prg_info(nullptr){};
+  LocusFinder() : search_state(nullptr), prg_info(nullptr){};
 
-  LocusFinder(SearchState search_state, info_ptr prg_info);
+  explicit LocusFinder(info_ptr prg_info)
+      : search_state(nullptr), prg_info(prg_info){};
+
+  LocusFinder(SearchState const &search_state, info_ptr prg_info);
+
+  /**
+   * Finds the loci of `search_state` in place of the previous ones, reusing
+   * their storage.
+   */
+  void find_loci(SearchState const &search_state);
 
   /** Sanity check: are all variant site markers in the `SearchState` different?
    */
   void check_site_uniqueness(SearchState const &search_state);
 
-  void check_site_uniqueness() { check_site_uniqueness(this->search_state); }
+  void check_site_uniqueness() { check_site_uniqueness(*this->search_state); }
 
   /**
    * Takes a `VariantLocus` and registers it as well as all sites it is nested
@@ -94,14 +117,14 @@ class LocusFinder {
                               info_ptr prg_info);
 
   void assign_traversing_loci() {
-    assign_traversing_loci(this->search_state, this->prg_info);
+    assign_traversing_loci(*this->search_state, this->prg_info);
   }
 
   void assign_traversed_loci(SearchState const &search_state,
                              info_ptr prg_info);
 
   void assign_traversed_loci() {
-    assign_traversed_loci(this->search_state, this->prg_info);
+    assign_traversed_loci(*this->search_state, this->prg_info);
   }
 
   level0_Sites base_sites; /**< Form the basis for `SearchState` selection */
@@ -109,7 +132,7 @@ class LocusFinder {
                               processed */
   uniqueLoci unique_loci;  /**< For grouped allele counts coverage recording */
  private:
-  SearchState const search_state;
+  SearchState const *search_state;
   info_ptr prg_info;
 };
 
@@ -118,20 +141,32 @@ class LocusFinder {
  * with the same level 0 sites. The second member, `uniqueLoci`, is the set of
  * all `VariantLocus` that the `SearchStates` are compatible with.
  */
-using traversal_info = std::pair<SearchStates, uniqueLoci>;
+using traversal_info = std::pair<SearchStateViews, uniqueLoci>;
 /**
  * Models a set of equivalence classes: each `level0_Sites` is a set of site
  * markers at level 0, ie non-nested bubbles. This data structure is the basis
  * for: -Dispatching `SearchState`s into their equivalence class -Random
  * selection of one equivalence class.
+ * Kept sorted by `level0_Sites`, which gives each class its selection index.
  */
-using uniqueSitePaths = std::map<level0_Sites, traversal_info>;
+using uniqueSitePaths = std::vector<std::pair<level0_Sites, traversal_info>>;
 
+/** The equivalence class of `sites` in `usps`; nullptr if there is none */
+traversal_info const *find_site_path(uniqueSitePaths const &usps,
+                                     level0_Sites const &sites);
+
+/**
+ * Views the selected equivalence class: valid until its
+ * `MappingInstanceSelector` selects again or goes out of scope. Both members
+ * are null if a non-variant mapping instance got selected.
+ */
 struct SelectedMapping {
-  SearchStates
-      navigational_search_states;    /**< Use: recording per base coverage*/
-  uniqueLoci equivalence_class_loci; /**< Use: recording grouped allele count
-                                        and allele sum coverage*/
+  /** Use: recording per base coverage */
+  SearchStateViews const *navigational_search_states = nullptr;
+  /** Use: recording grouped allele count and allele sum coverage */
+  uniqueLoci const *equivalence_class_loci = nullptr;
+
+  bool empty() const { return navigational_search_states == nullptr; }
 };
 
 /**
@@ -139,27 +174,39 @@ struct SelectedMapping {
  * randomly selects equivalent mapping instances of the read.
  *
  * The basis for selection is the set of `level0_Sites` in `usps`.
+ * `SearchState`s are viewed, not copied: they must outlive the selection. A
+ * selector can be reused across reads with `select()`, keeping the storage of
+ * its equivalence classes: selecting then allocates nothing once the largest
+ * read has been seen.
  */
 class MappingInstanceSelector {
  public:
   uniqueSitePaths usps; /**< Key dispatching and selection object.*/
 
   // Constructor
-  MappingInstanceSelector(SearchStates const search_states, info_ptr prg_info,
+  MappingInstanceSelector(SearchStates const &search_states, info_ptr prg_info,
                           rand_ptr rand_generator);
 
   // Constructors for testing
-  MappingInstanceSelector() : prg_info(nullptr), rand_generator(nullptr) {}
+  MappingInstanceSelector()
+      : locus_finder(nullptr), prg_info(nullptr), rand_generator(nullptr) {}
 
   MappingInstanceSelector(info_ptr prg_info)
-      : prg_info(prg_info), rand_generator(nullptr) {}
+      : locus_finder(prg_info), prg_info(prg_info), rand_generator(nullptr) {}
 
   MappingInstanceSelector(info_ptr prg_info, rand_ptr rand_g)
-      : prg_info(prg_info), rand_generator(rand_g) {}
+      : locus_finder(prg_info), prg_info(prg_info), rand_generator(rand_g) {}
+
+  /**
+   * Forgets the previous read's equivalence classes and selection, then
+   * dispatches and selects among `search_states` using `rand_generator`.
+   */
+  void select(SearchStates const &search_states,
+              RandomGenerator &rand_generator);
 
   void process_searchstates(SearchStates const &all_ss);
 
-  void set_searchstates(SearchStates const &ss) { input_search_states = ss; }
+  void set_searchstates(SearchStates const &ss) { input_search_states = &ss; }
 
   /**
    * Dispatches a `SearchState` into `usps` using `LocusFinder`.
@@ -179,13 +226,18 @@ class MappingInstanceSelector {
 
   void apply_selection(int32_t selected_index);
 
-  SelectedMapping get_selection() { return selected; }
+  SelectedMapping get_selection() const { return selected; }
 
  private:
-  SearchStates input_search_states;
+  /** Empties `usps`, keeping the storage of its classes in `spare_classes` */
+  void clear_site_paths();
+
+  SearchStates const *input_search_states = nullptr;
   SelectedMapping selected; /**< stores the choice made*/
+  LocusFinder locus_finder;
+  uniqueSitePaths spare_classes;
   info_ptr prg_info;
-  rand_ptr rand_generator;
+  RandomGenerator *rand_generator;
 };
 }  // namespace gram
 
@@ -0,0 +1,117 @@
+/** @file
+ * Live progress of quasimapping.
+ *
+ * Mapping threads record the reads they process in per-thread atomic
+ * counters. A reporter thread periodically aggregates them into throughput,
+ * mapped fraction of the orientations searched and an estimated time to
+ * completion, printed to stdout and written to a json status file that can be
+ * polled while `genotype` runs.
+ */
+#ifndef GRAMTOOLS_QUASIMAP_PROGRESS_HPP
+#define GRAMTOOLS_QUASIMAP_PROGRESS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gram {
+class QuasimapProgress {
+ public:
+  using JSON = nlohmann::json;
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @param reads_fpaths the files to be mapped, in order; their sizes give the
+   * estimated time to completion.
+   * @param status_fpath where to write the status; if empty, none is written.
+   * @param report_interval time between two reports; the reporter thread
+   * starts with the first call to `start`.
+   */
+  QuasimapProgress(std::vector<std::string> const &reads_fpaths,
+                   std::string status_fpath,
+                   std::chrono::milliseconds report_interval =
+                       std::chrono::seconds(10));
+
+  /** Stops the reporter thread, if `stop` was not called */
+  ~QuasimapProgress();
+
+  QuasimapProgress(QuasimapProgress const &) = delete;
+  QuasimapProgress &operator=(QuasimapProgress const &) = delete;
+
+  void start();
+
+  /** Stops the reporter thread, then reports and writes the final status */
+  void stop();
+
+  /**
+   * Called by mapping threads, once per read.
+   * @param orientations_searched number of the read's orientations (forward,
+   * reverse complement) searched, ie let through by the kmer prefilter
+   * @param orientations_mapped number of those that mapped
+   */
+  void record_read(bool skipped, uint32_t orientations_searched,
+                   uint32_t orientations_mapped);
+
+  /**
+   * Called by mapping threads for an orientation that mapped after its read
+   * got recorded, when the orientations are mapped apart.
+   */
+  void record_orientation_mapped();
+
+  /** The reads file at `file_index` in `reads_fpaths` starts being read */
+  void start_file(std::size_t file_index);
+
+  /**
+   * Bytes of the current reads file consumed so far; for compressed files,
+   * compressed bytes. Negative if unknown.
+   */
+  void set_input_offset(long offset);
+
+  /** A new buffer of `num_reads` reads has been loaded for mapping */
+  void set_buffer_loaded(uint64_t num_reads);
+
+  /** Snapshot of the progress, as written to the status file */
+  JSON status() const;
+
+ private:
+  /** Own cache line each, as every mapping thread writes to its own */
+  struct alignas(64) ThreadCounts {
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> skipped{0};
+    std::atomic<uint64_t> orientations_searched{0};
+    std::atomic<uint64_t> orientations_mapped{0};
+  };
+
+  void report_loop();
+  void report(bool done);
+
+  std::vector<uint64_t> file_sizes;
+  std::string status_fpath;
+  std::chrono::milliseconds report_interval;
+
+  std::vector<ThreadCounts> thread_counts;
+  Clock::time_point start_time;
+
+  std::atomic<std::size_t> current_file{0};
+  std::atomic<long> input_offset{0};
+  std::atomic<uint64_t> buffer_loaded{0};
+  std::atomic<uint64_t> reads_at_buffer_load{0};
+
+  std::thread reporter;
+  std::mutex mutex;
+  std::condition_variable stop_requested;
+  bool stopping = false;
+
+  // Used by the reporter thread only, for the rate since the last report
+  uint64_t last_reported_reads = 0;
+  Clock::time_point last_report_time;
+  bool status_write_failed = false;
+};
+}  // namespace gram
+
+#endif  // GRAMTOOLS_QUASIMAP_PROGRESS_HPP
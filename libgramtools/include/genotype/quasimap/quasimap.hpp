@@ -8,8 +8,12 @@
 #include "genotype/parameters.hpp"
 #include "sequence_read/seqread.hpp"
 
+#include "build/kmer_index/kmer_filter.hpp"
 #include "build/kmer_index/kmer_index_types.hpp"
 #include "genotype/quasimap/coverage/coverage_common.hpp"
+#include "genotype/quasimap/progress.hpp"
+#include "genotype/quasimap/read_cache.hpp"
+#include "genotype/quasimap/suffix_cache.hpp"
 #include "genotype/read_stats.hpp"
 
 #include "search/encapsulated_search.hpp"
@@ -20,35 +24,62 @@ struct QuasimapReadsStats {
   uint64_t all_reads_count = 0;
   uint64_t skipped_reads_count = 0;
   uint64_t mapped_reads_count = 0;
+  uint64_t prefiltered_reads_count =
+      0; /**< Rejected by the `KmerFilter`: no indexed seed kmer */
+  uint64_t read_cache_lookups = 0;
+  uint64_t read_cache_hits = 0;
+  uint64_t suffix_cache_lookups = 0;
+  uint64_t suffix_cache_hits = 0;
   Coverage coverage = {};
 };
 
+/**
+ * The caches shared by the threads mapping reads; those left null are not
+ * used.
+ */
+struct QuasimapCaches {
+  ReadCache *reads = nullptr; /**< Repeated reads reuse their first search */
+  SuffixCache *suffixes =
+      nullptr; /**< Reads resume their search from cached 3' suffixes */
+};
+
 /**
  * For each read file, quasimap reads.
  */
 QuasimapReadsStats quasimap_reads(const GenotypeParams &parameters,
                                   const KmerIndex &kmer_index,
+                                  const KmerFilter &kmer_filter,
                                   const PRG_Info &prg_info,
                                   ReadStats &readstats);
 
 /**
  * Load and process (ie map) reads from a given read file using a buffer to
  * reduce disk I/O calls
+ * @param progress records the reads processed and the input consumed
  */
 void handle_read_file(QuasimapReadsStats &quasimap_stats,
                       const std::string &reads_fpath,
                       const GenotypeParams &parameters,
-                      const KmerIndex &kmer_index, const PRG_Info &prg_info);
+                      const KmerIndex &kmer_index,
+                      const KmerFilter &kmer_filter, const PRG_Info &prg_info,
+                      QuasimapProgress &progress,
+                      QuasimapCaches const &caches = {});
 
 /**
  * Calls quasimapping routine on a given read (forward mapping), and its reverse
- * complement (reverse mapping)
+ * complement (reverse mapping). Each orientation whose seed kmer is rejected by
+ * `kmer_filter` is not searched; its reverse complement is not computed.
+ * @param read_ordinal the read's `ReadID::ordinal`
+ * @return the number of orientations that mapped
  */
-void quasimap_forward_reverse(QuasimapReadsStats &quasimap_stats,
-                              const Sequence &read,
-                              const GenotypeParams &parameters,
-                              const KmerIndex &kmer_index,
-                              const PRG_Info &prg_info);
+uint32_t quasimap_forward_reverse(QuasimapReadsStats &quasimap_stats,
+                                  const Sequence &read,
+                                  const GenotypeParams &parameters,
+                                  const KmerIndex &kmer_index,
+                                  const KmerFilter &kmer_filter,
+                                  const PRG_Info &prg_info,
+                                  uint64_t read_ordinal = 0,
+                                  QuasimapCaches const &caches = {});
 
 /**
  * Map a read to the prg, starting from the precomputed set of search states
@@ -58,11 +89,16 @@ void quasimap_forward_reverse(QuasimapReadsStats &quasimap_stats,
  * first kmer in the read will be seeded this way.
  * @param prg_info object holding all data structures necessary for vBWT,
  * including `gram::FM_Index`.
+ * @param read_id keys the random selection of the read's mapping instance
+ * @param caches the read's `SearchStates` are taken from `caches.reads` if
+ * cached there, and cached otherwise. Coverage gets recorded either way.
  * @return
  */
 bool quasimap_read(const Sequence &read, Coverage &coverage,
                    const KmerIndex &kmer_index, const PRG_Info &prg_info,
-                   const GenotypeParams &parameters);
+                   const GenotypeParams &parameters,
+                   ReadID const &read_id = {},
+                   QuasimapCaches const &caches = {});
 
 Sequence get_kmer_from_read(const uint32_t &kmer_size, const Sequence &read);
 
@@ -70,12 +106,16 @@ Sequence get_kmer_from_read(const uint32_t &kmer_size, const Sequence &read);
  * Generates a list of `SearchState`s from a read and a kmer, which is 3'-most
  * kmer in the read. The kmer_index is queried to generate an initial set of
  * `SearchState`s (precomputed at `build` stage) to start from.
+ * @param suffix_cache if not null, the search resumes from the read's longest
+ * cached 3' suffix, and the suffixes it extends get cached. `kmer` must then
+ * be the read's 3'-most kmer.
  * @return SearchStates: a list of `SearchState`s, which at core are an SA
  * interval and a path through the prg (marker-allele ID pairs)
  */
 SearchStates search_read_backwards(const Sequence &read, const Sequence &kmer,
                                    const KmerIndex &kmer_index,
-                                   const PRG_Info &prg_info);
+                                   const PRG_Info &prg_info,
+                                   SuffixCache *suffix_cache = nullptr);
 
 /**
  * **The key read mapping procedure**.
@@ -0,0 +1,77 @@
+/** @file
+ * A cache of the `SearchStates` reads map to, keyed by read sequence.
+ *
+ * Amplicon and high-depth runs hold many identical reads, which all search the
+ * prg the same way: a repeated read takes its final `SearchStates` from the
+ * cache, and only gets its coverage recorded. Reads that did not map are
+ * cached too.
+ * The cache is split into shards, each with its own lock and an equal share of
+ * the memory budget; once a shard's share is full, it evicts its oldest reads.
+ */
+#ifndef GRAMTOOLS_READ_CACHE_HPP
+#define GRAMTOOLS_READ_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+#include "common/utils.hpp"
+#include "genotype/quasimap/search/types.hpp"
+
+namespace gram {
+class ReadCache {
+ public:
+  /** @param max_bytes the memory budget of the cache; 0 caches nothing */
+  explicit ReadCache(uint64_t max_bytes);
+
+  ReadCache(ReadCache const &) = delete;
+  ReadCache &operator=(ReadCache const &) = delete;
+
+  /**
+   * Thread-safe.
+   * @return whether `read` was cached; if so, its `SearchStates` are copied
+   * into `search_states`
+   */
+  bool find(Sequence const &read, SearchStates &search_states);
+
+  /**
+   * Thread-safe. Caches the `SearchStates` `read` maps to, unless already
+   * cached or on its own larger than a shard's budget.
+   */
+  void insert(Sequence const &read, SearchStates const &search_states);
+
+  uint64_t hits() const { return num_hits; }
+  uint64_t misses() const { return num_misses; }
+
+  /** The number of reads cached */
+  std::size_t size();
+
+  /** The estimated memory used by the cached reads */
+  uint64_t bytes();
+
+  /** The estimated memory used by caching `search_states` for `read` */
+  static uint64_t entry_bytes(Sequence const &read,
+                              SearchStates const &search_states);
+
+ private:
+  static constexpr std::size_t num_shards = 64;
+
+  struct Shard {
+    std::mutex mutex;
+    SequenceHashMap<Sequence, SearchStates> entries;
+    /** Point to the keys of `entries`, which rehashing does not move */
+    std::deque<Sequence const *> insertion_order;
+    uint64_t bytes{0};
+  };
+
+  Shard &shard_of(Sequence const &read);
+
+  uint64_t shard_budget;
+  std::array<Shard, num_shards> shards;
+  std::atomic<uint64_t> num_hits{0};
+  std::atomic<uint64_t> num_misses{0};
+};
+}  // namespace gram
+
+#endif  // GRAMTOOLS_READ_CACHE_HPP
@@ -1,10 +1,9 @@
 /** @file
  * Procedures supporting variant aware backward searching through the prg.
- * @note `char2comp` attribute of `fm_index` gives the lexicographic ordering of
- * the queried symbol. This allows for finding symbol's first occurrence in the
- * SA using the `C` array. For eg, we do not assume that site marker '5' is the
- * 5th element of the `C` array, because we can be given a prg which can have
- * discontinuous integers marking variant sites.
+ * @note Ranks and the first occurrence of symbols in the SA come from
+ * `prg_info.reduced_bwt`, not from the `fm_index`: its `C` array is indexed by
+ * the symbol itself, so it holds even if variant site markers are
+ * discontinuous.
  */
 
 #ifndef GRAMTOOLS_SEARCH_HPP
@@ -39,7 +38,7 @@ SearchStates search_base_backwards(const int_Base &pattern_char,
  * Update the current SA interval to include the next character.
  * This is a backward search. SA interval is updated using rank queries on the
  * bwt.
- * @param next_char the next character to look for.
+ * @param next_char the next character to look for: a DNA base.
  * @param next_char_first_sa_index the position of the first occurrence of
  * `next_char` in the SA.
  */
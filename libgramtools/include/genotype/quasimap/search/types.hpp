@@ -57,6 +57,8 @@ struct SearchState {
 };
 
 using SearchStates = std::list<SearchState>;
+/** Views of `SearchState`s held elsewhere, for passing them on uncopied */
+using SearchStateViews = std::vector<SearchState const *>;
 }  // namespace gram
 
 #endif  // GRAMTOOLS_SEARCH_TYPES_HPP
@@ -20,14 +20,9 @@ struct Locus_and_SearchState {
 using Locus_and_SearchStates = std::vector<Locus_and_SearchState>;
 
 /**
- * Computes the full SA interval of a given allele marker.
- * Note that the way this is computed is robust to variant markers not being
- * continuous: eg, could have site with markers 5/6 & another with 9/10 without
- * a site with 7/8.
- *
- * `sigma`: the alphabet size
- * `char2comp`: maps a symbol of the alphabet to a positive integer in
- * [0...sigma - 1] `comp2char`: the inverse mapping of above
+ * Computes the full SA interval of a given allele marker. Search itself reads
+ * it from `PRG_Info::jump_tables`.
+ * @see get_marker_sa_interval()
  */
 SA_Interval get_allele_marker_sa_interval(const Marker &allele_marker_char,
                                           const PRG_Info &prg_info);
@@ -0,0 +1,105 @@
+/** @file
+ * A cache of the `SearchStates` read suffixes extend to, beyond the kmer
+ * index's seeds.
+ *
+ * The kmer index holds the `SearchStates` of each read's 3'-most kmer; reads
+ * sharing a longer 3' suffix (as in targeted and amplicon data) then all repeat
+ * the same base by base extension. This caches the `SearchStates` of suffixes
+ * extending the kmer by a few checkpoint lengths, so that a read can resume
+ * its search from its longest cached suffix.
+ *
+ * Thread-safe, and bounded in memory: each of its shards evicts its least
+ * recently used suffixes past its share of the budget. It adapts to the reads:
+ * a checkpoint whose suffixes rarely recur stops being looked up and filled.
+ */
+#ifndef GRAMTOOLS_SUFFIX_CACHE_HPP
+#define GRAMTOOLS_SUFFIX_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <mutex>
+
+#include "common/utils.hpp"
+#include "genotype/quasimap/search/types.hpp"
+
+namespace gram {
+class SuffixCache {
+ public:
+  using Checkpoints = std::vector<std::size_t>;
+
+  /**
+   * @param max_bytes the memory budget of the cache; 0 caches nothing
+   * @param extensions the checkpoints: numbers of bases past the kmer whose
+   * suffixes get cached, in increasing order
+   * @param min_hit_rate below which, once looked up `min_lookups` times, a
+   * checkpoint is turned off
+   */
+  explicit SuffixCache(uint64_t max_bytes,
+                       Checkpoints extensions = {8, 16, 32, 64},
+                       double min_hit_rate = 0.01,
+                       uint64_t min_lookups = 10000);
+
+  SuffixCache(SuffixCache const &) = delete;
+  SuffixCache &operator=(SuffixCache const &) = delete;
+
+  /**
+   * Looks up the suffixes of `read` at each active checkpoint, longest first.
+   * @param kmer_size the read's 3'-most `kmer_size` bases are its seed kmer
+   * @return the number of bases past the kmer of the longest suffix cached,
+   * whose `SearchStates` are copied into `search_states`; 0 if none is cached
+   */
+  std::size_t find(Sequence const &read, std::size_t kmer_size,
+                   SearchStates &search_states);
+
+  /**
+   * If `extension` is an active checkpoint, caches the `SearchStates` of the
+   * suffix of `read` extending its kmer by `extension` bases.
+   */
+  void insert(Sequence const &read, std::size_t kmer_size,
+              std::size_t extension, SearchStates const &search_states);
+
+  /** The number of reads looked up, and found, in the cache */
+  uint64_t lookups() const { return num_lookups; }
+  uint64_t hits() const { return num_hits; }
+
+  /** The checkpoints still looked up and filled */
+  Checkpoints active_checkpoints() const;
+
+ private:
+  static constexpr std::size_t num_shards = 64;
+
+  using Entry = std::pair<Sequence, SearchStates>;
+  /** Most recently used first */
+  using Entries = std::list<Entry>;
+
+  struct Shard {
+    std::mutex mutex;
+    Entries entries;
+    SequenceHashMap<Sequence, Entries::iterator> index;
+    uint64_t bytes{0};
+  };
+
+  struct Checkpoint {
+    std::size_t extension;
+    std::atomic<bool> active{true};
+    std::atomic<uint64_t> lookups{0};
+    std::atomic<uint64_t> hits{0};
+  };
+
+  Shard &shard_of(Sequence const &suffix);
+
+  /** Turns `checkpoint` off if its suffixes rarely get found */
+  void adapt(Checkpoint &checkpoint);
+
+  uint64_t shard_budget;
+  double min_hit_rate;
+  uint64_t min_lookups;
+  std::vector<Checkpoint> checkpoints;
+  std::array<Shard, num_shards> shards;
+  std::atomic<uint64_t> num_lookups{0};
+  std::atomic<uint64_t> num_hits{0};
+};
+}  // namespace gram
+
+#endif  // GRAMTOOLS_SUFFIX_CACHE_HPP
@@ -74,7 +74,7 @@ class coverage_Node {
    * Getters
    */
   std::size_t get_pos() const { return pos; }
-  std::string get_sequence() const { return sequence; }
+  std::string const& get_sequence() const { return sequence; }
   std::size_t get_sequence_size() const { return sequence.size(); }
   int get_coverage_space() const { return coverage.size(); }
   PerBaseCoverage const& get_coverage() const { return coverage; }
@@ -237,6 +237,10 @@ class coverage_Graph {
 /**
  * A class in charge of mechanics of building coverage graph
  * It is designed for use by DEVELOPER only
+ *
+ * The `PRG_String` is cut at the entries of top-level sites into pieces, which
+ * are built independently and in parallel, then stitched back together in
+ * order.
  */
 class cov_Graph_Builder {
  public:
@@ -254,60 +258,87 @@ class cov_Graph_Builder {
   access_vec random_access;
   target_m target_map;
 
-  void make_root(); /**< Start state: set up the globals such as `cur_Node` &
-                       `backWire` */
-  void make_sink(); /**< End state: final wiring & pointers to null */
+  /**
+   * The state for building one piece of the graph, spanning positions
+   * [`start`, `end`) of the `PRG_String`. Node positions are relative to the
+   * piece's start until stitching.
+   */
+  struct Piece {
+    std::size_t start, end;
+    covG_ptr entry; /**< Placeholder, wired to the piece's first node */
+    covG_ptr backWire;  // Pointer to the most recent node needing edge building
+    covG_ptr cur_Node;
+
+    // For assigning position to nodes
+    std::size_t cur_pos{0};
+    bool first_allele{false};
+
+    VariantLocus cur_Locus{0, ALLELE_UNKNOWN};  // For building parental map
+
+    std::vector<covG_ptr> nodes; /**< All made, for offsetting positions */
+    marker_to_node bubble_starts;
+    marker_to_node bubble_ends;
+    parental_map par_map;
+    target_m target_map;
+  };
+
+  /** @return the start of each piece: 0, then entries of top-level sites */
+  std::vector<std::size_t> find_piece_starts() const;
+  void build_piece(Piece& piece);
+  /** Places the pieces' nodes and bubbles, and wires each to the previous */
+  void stitch(std::vector<Piece>& pieces);
+
+  void make_root(Piece& piece); /**< Start state: set up `cur_Node` &
+                                   `backWire` */
+  void make_sink(Piece& piece); /**< End state: final wiring & pointers to
+                                   null */
   /**
    * Function call dispatcher based on marker at position @param pos.
-   * Called once per element in `PRG_String`.
+   * Called once per variant marker in `PRG_String`.
    * @param pos index into the `PRG_String`
    */
-  void process_marker(uint32_t const& pos);
-  void setup_random_access(uint32_t const& pos);
-  void add_sequence(Marker const& m);
-  marker_type find_marker_type(uint32_t const& pos);
-  void enter_site(Marker const& m);
-  void end_allele(Marker const& m);
-  void exit_site(Marker const& m);
+  void process_marker(Piece& piece, uint32_t const& pos);
+  void setup_random_access(Piece& piece, uint32_t const& pos);
+  /** Appends the nucleotides at positions [`start`, `end`) in one go */
+  void add_sequence(Piece& piece, std::size_t start, std::size_t end);
+  marker_type find_marker_type(uint32_t const& pos) const;
+  void enter_site(Piece& piece, Marker const& m);
+  void end_allele(Piece& piece, Marker const& m);
+  void exit_site(Piece& piece, Marker const& m);
   /**
    * A convenience function for reaching the end of an allele: called by both
    * `end_allele` & `exit_site`
    */
-  covG_ptr reach_allele_end(Marker const& m);
+  covG_ptr reach_allele_end(Piece& piece, Marker const& m);
 
-  void wire(covG_ptr const& target); /** Build 1 or 2 edges depending on whether
-                                        `cur_Node` contains sequence. */
+  /** Build 1 or 2 edges depending on whether `cur_Node` contains sequence. */
+  static void wire(covG_ptr const& backWire, covG_ptr const& cur_Node,
+                   covG_ptr const& target);
 
   /**
    * Makes the map of marker targets used during mapping
    */
-  void map_targets();
-  void make_site_entry_target(marker_type prev_t, Marker prev_m, Marker cur_m);
-  void make_site_exit_target(marker_type prev_t, Marker prev_m, Marker cur_m,
-                             AlleleId cur_allele_ID);
-  void make_allele_end_target(marker_type prev_t, Marker prev_m, Marker cur_m,
-                              AlleleId cur_allele_ID);
+  void map_targets(Piece& piece);
+  void make_site_entry_target(Piece& piece, marker_type prev_t, Marker prev_m,
+                              Marker cur_m);
+  void make_site_exit_target(Piece& piece, marker_type prev_t, Marker prev_m,
+                             Marker cur_m, AlleleId cur_allele_ID);
+  void make_allele_end_target(Piece& piece, marker_type prev_t, Marker prev_m,
+                              Marker cur_m, AlleleId cur_allele_ID);
   /**
    * Site exit points can point to different variant markers (site start & end)
    * Here we test for prior presence of the allele marker in the `target_map`
    * and insert or update accordingly
    */
-  void add_exit_target(Marker cur_m, targeted_marker const new_t_m);
+  static void add_exit_target(target_m& target_map, Marker cur_m,
+                              targeted_marker const new_t_m);
 
   /*
    * variables & data structures
    */
   marker_vec linear_prg;
   std::unordered_map<Marker, int> end_positions;
-
-  covG_ptr backWire;  // Pointer to the most recent node needing edge building
-  covG_ptr cur_Node;
-
-  // For assigning position to nodes
-  std::size_t cur_pos{0};
-  bool first_allele{false};
-
-  VariantLocus cur_Locus;  // For building parental map
+  std::vector<marker_type> marker_types; /**< One per `PRG_String` position */
 
   marker_to_node bubble_starts;
   marker_to_node bubble_ends;
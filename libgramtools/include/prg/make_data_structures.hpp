@@ -9,6 +9,7 @@
 
 #include "build/parameters.hpp"
 #include "prg/linearised_prg.hpp"
+#include "prg/prg_info.hpp"
 #include "prg/types.hpp"
 
 namespace gram {
@@ -19,6 +20,10 @@ namespace gram {
  */
 FM_Index generate_fm_index(BuildParams const &parameters);
 
+/**
+ * Always copied into memory: unlike plain sdsl vectors, the FM index cannot be
+ * mapped.
+ */
 FM_Index load_fm_index(CommonParameters const &parameters);
 
 /**************
@@ -28,6 +33,46 @@ FM_Index load_fm_index(CommonParameters const &parameters);
 coverage_Graph generate_cov_graph(CommonParameters const &parameters,
                                   PRG_String const &prg_string);
 
+/**
+ * Serialises the positions where sites end in the prg, so that they can be
+ * loaded without parsing the prg.
+ */
+void store_end_positions(CommonParameters const &parameters,
+                         PRG_String const &prg_string);
+
+/**
+ * Loads the positions stored by `store_end_positions`. If they were not stored,
+ * gets them from the prg.
+ */
+std::unordered_map<Marker, int> load_end_positions(
+    CommonParameters const &parameters);
+
+/**
+ * Derives the run-length encoded loci of the suffix array from the FM index and
+ * the coverage graph, and stores them.
+ */
+void generate_sa_locus_runs(PRG_Info &prg_info,
+                            CommonParameters const &parameters);
+
+/**
+ * Loads the runs stored by `generate_sa_locus_runs`. If they were not stored,
+ * derives them.
+ */
+void load_sa_locus_runs(PRG_Info &prg_info, CommonParameters const &parameters);
+
+/**
+ * Derives the reduced BWT from the FM index and the encoded prg, and stores it.
+ */
+void generate_reduced_bwt(PRG_Info &prg_info, marker_vec const &encoded_prg,
+                          CommonParameters const &parameters);
+
+/**
+ * Loads the BWT stored by `generate_reduced_bwt`, mapping it read-only if
+ * `parameters.map_artefacts`. If it was not stored, reads it off the FM
+ * index's suffix array and the encoded prg.
+ */
+void load_reduced_bwt(PRG_Info &prg_info, CommonParameters const &parameters);
+
 /**
  * Build child_map from parental_map
  */
@@ -38,19 +83,17 @@ child_map build_child_map(parental_map const &par_map);
  **************/
 
 /**
- * Generate BWT bit vector masks for each of A,C,G and T in the BWT of the prg.
+ * Generates the bit mask flagging variant markers in the BWT of the prg, from
+ * `prg_info.reduced_bwt`, and stores it to disk.
  */
-DNA_BWT_Masks generate_bwt_masks(FM_Index const &fm_index,
-                                 CommonParameters const &parameters);
-
-DNA_BWT_Masks load_dna_bwt_masks(const FM_Index &fm_index,
-                                 CommonParameters const &parameters);
+void generate_bwt_masks(PRG_Info &prg_info, CommonParameters const &parameters);
 
 /**
- * Bit vector for variant marker presence in the BWT of the prg.
- * @param fm_index which contains the bwt characters.
+ * Loads the mask stored by `generate_bwt_masks`, mapping it read-only if
+ * `parameters.map_artefacts`. Derives it from `prg_info.reduced_bwt` if it was
+ * not stored.
  */
-sdsl::bit_vector generate_bwt_markers_mask(const FM_Index &fm_index);
+void load_bwt_masks(PRG_Info &prg_info, CommonParameters const &parameters);
 
 }  // namespace gram
 
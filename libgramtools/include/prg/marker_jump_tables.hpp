@@ -0,0 +1,102 @@
+/** @file
+ * Flat tables of everything vBWT jumps look up about variant markers, indexed
+ * by site: the SA intervals of site and allele markers, site end positions in
+ * the prg, and the markers each marker jumps to next.
+ *
+ * Site and allele markers are dense (site `s` has markers `s` and `s + 1`), so
+ * `(marker - 5) / 2` indexes either kind. Built once per `PRG_Info`, the tables
+ * spare reads crossing sites any hashing or FM-index arithmetic.
+ */
+#ifndef GRAMTOOLS_MARKER_JUMP_TABLES_HPP
+#define GRAMTOOLS_MARKER_JUMP_TABLES_HPP
+
+#include <unordered_map>
+#include <vector>
+
+#include "common/data_types.hpp"
+#include "genotype/quasimap/search/types.hpp"
+#include "prg/coverage_graph.hpp"
+
+namespace gram {
+/**
+ * Computes the full SA interval of a given marker.
+ * Note that the way this is computed is robust to variant markers not being
+ * continuous: eg, could have site with markers 5/6 & another with 9/10 without
+ * a site with 7/8.
+ *
+ * `sigma`: the alphabet size
+ * `char2comp`: maps a symbol of the alphabet to a positive integer in
+ * [0...sigma - 1] `comp2char`: the inverse mapping of above
+ */
+SA_Interval get_marker_sa_interval(Marker const &marker,
+                                   FM_Index const &fm_index);
+
+/** The markers targeted by an allele marker, stored contiguously */
+struct TargetedMarkers {
+  targeted_marker const *first = nullptr;
+  targeted_marker const *last = nullptr;
+  targeted_marker const *begin() const { return first; }
+  targeted_marker const *end() const { return last; }
+  bool empty() const { return first == last; }
+};
+
+class MarkerJumpTables {
+ public:
+  MarkerJumpTables() = default;
+
+  /**
+   * @param last_allele_positions the prg position of each site's last allele
+   * marker
+   */
+  MarkerJumpTables(
+      FM_Index const &fm_index, coverage_Graph const &coverage_graph,
+      std::unordered_map<Marker, int> const &last_allele_positions);
+
+  /** The SA index of the (single) occurrence of a site marker */
+  SA_Index site_sa_index(Marker const &site_marker) const {
+    return site_sa_indexes[index(site_marker)];
+  }
+  SA_Interval const &allele_sa_interval(Marker const &allele_marker) const {
+    return allele_sa_intervals[index(allele_marker)];
+  }
+  uint64_t site_end_position(Marker const &marker) const {
+    return site_end_positions[index(marker)];
+  }
+
+  /**
+   * The marker reached when exiting the site of `site_marker`: an allele
+   * marker for an adjacent site entry, the parent site for a double exit, or
+   * 0 if sequence follows.
+   */
+  Marker exit_target(Marker const &site_marker) const {
+    return exit_targets[index(site_marker)];
+  }
+  /** The locus a nested site is in; {0, ALLELE_UNKNOWN} for level 1 sites */
+  VariantLocus const &parent_locus(Marker const &site_marker) const {
+    return parent_loci[index(site_marker)];
+  }
+  /** Direct deletions and double entries reached on entering a site */
+  TargetedMarkers entry_targets(Marker const &allele_marker) const {
+    auto const i = index(allele_marker);
+    return TargetedMarkers{entry_target_list.data() + entry_target_offsets[i],
+                           entry_target_list.data() +
+                               entry_target_offsets[i + 1]};
+  }
+
+  std::size_t num_sites() const { return site_sa_indexes.size(); }
+
+ private:
+  static std::size_t index(Marker const &marker) { return (marker - 5) / 2; }
+
+  std::vector<SA_Index> site_sa_indexes;
+  std::vector<SA_Interval> allele_sa_intervals;
+  std::vector<uint64_t> site_end_positions;
+  std::vector<Marker> exit_targets;
+  std::vector<VariantLocus> parent_loci;
+  /** Site `i`'s entry targets are at [offsets[i], offsets[i + 1]) */
+  std::vector<uint32_t> entry_target_offsets;
+  std::vector<targeted_marker> entry_target_list;
+};
+}  // namespace gram
+
+#endif  // GRAMTOOLS_MARKER_JUMP_TABLES_HPP
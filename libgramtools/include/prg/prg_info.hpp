@@ -12,6 +12,9 @@
 
 #include "common/parameters.hpp"
 #include "prg/coverage_graph.hpp"
+#include "prg/marker_jump_tables.hpp"
+#include "prg/reduced_bwt.hpp"
+#include "prg/sa_locus_runs.hpp"
 
 namespace gram {
 
@@ -25,24 +28,21 @@ struct PRG_Info {
                         suffix array. */
   marker_vec encoded_prg;
   std::unordered_map<Marker, int> last_allele_positions;
+  MarkerJumpTables jump_tables; /**< Needs `fm_index`, `coverage_graph` and
+                                   `last_allele_positions` to be built */
+
+  SALocusRuns sa_locus_runs; /**< The (site, allele) of each SA index */
 
   mutable coverage_Graph
       coverage_graph;  // Can pass PRG_Info as const but still mutate this
                        // (record pb coverage)
 
-  sdsl::bit_vector bwt_markers_mask; /**< Bit vector flagging variant site
-                                        marker presence in bwt.*/
+  ReducedBWT reduced_bwt; /**< The bwt over DNA, with sparse markers. Used
+                             for rank queries during backward search. */
+  SharedBitVector bwt_markers_mask; /**< Bit vector flagging variant site
+                                       marker presence in bwt.*/
   uint64_t markers_mask_count_set_bits;
 
-  DNA_BWT_Masks
-      dna_bwt_masks; /**<Holds bit masks over the bwt for dna nucleotides. Used
-                        for rank queries to BWT during backward search. */
-  // Rank support will be provided for each bit mask held in structure above.
-  sdsl::rank_support_v<1> rank_bwt_a;
-  sdsl::rank_support_v<1> rank_bwt_c;
-  sdsl::rank_support_v<1> rank_bwt_g;
-  sdsl::rank_support_v<1> rank_bwt_t;
-
   uint64_t num_variant_sites;
 
   // Only used for kmer indexing without `all-kmers`
@@ -67,6 +67,14 @@ struct PRG_Info {
  */
 PRG_Info load_prg_info(CommonParameters const &parameters);
 
+/**
+ * Asks for the structures of `prg_info` randomly accessed during backward
+ * search, and not allocated on huge pages in the first place, to be moved to
+ * huge pages and read in. Does nothing unless huge pages are enabled.
+ * @see huge_pages::advise()
+ */
+void advise_huge_pages(PRG_Info const &prg_info);
+
 }  // namespace gram
 
 #endif  // GRAMTOOLS_PRG_INFO_HPP
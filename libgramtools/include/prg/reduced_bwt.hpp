@@ -0,0 +1,152 @@
+/** @file
+ * The BWT of the prg, stored for its reduced alphabet: DNA bases.
+ *
+ * The prg's alphabet holds every site and allele marker, but backward search
+ * only ranks DNA. Bases are packed two bits each, with the counts of each base
+ * before every block of them; the markers, which are few in the BWT, are kept
+ * as a sparse position -> marker array; and the first SA index of each symbol
+ * (the `C` array) is a flat table indexed by the symbol itself.
+ * None of it needs the FM index's wavelet tree, whose depth grows with the
+ * number of markers.
+ * Counts and positions are 32-bit, as `SA_Index` is: longer BWTs are rejected.
+ * Stored, it can be mapped read-only rather than loaded, its arrays then
+ * pointing into the mapped file.
+ */
+#ifndef GRAMTOOLS_REDUCED_BWT_HPP
+#define GRAMTOOLS_REDUCED_BWT_HPP
+
+#include <functional>
+#include <memory>
+#include <sdsl/util.hpp>
+
+#include "common/data_types.hpp"
+#include "common/huge_pages.hpp"
+#include "genotype/quasimap/search/types.hpp"
+
+namespace gram {
+/** A read-only array, owned elsewhere */
+template <typename T>
+class ArrayView {
+ public:
+  using value_type = T;
+
+  ArrayView() = default;
+  ArrayView(T const *data, uint64_t size)
+      : elements(data), num_elements(size) {}
+  template <typename Vector>
+  explicit ArrayView(Vector const &vector)
+      : ArrayView(vector.data(), vector.size()) {}
+
+  T const &operator[](uint64_t index) const { return elements[index]; }
+  uint64_t size() const { return num_elements; }
+  bool empty() const { return num_elements == 0; }
+  T const *data() const { return elements; }
+  T const *begin() const { return elements; }
+  T const *end() const { return elements + num_elements; }
+
+ private:
+  T const *elements = nullptr;
+  uint64_t num_elements = 0;
+};
+
+class ReducedBWT {
+ public:
+  ReducedBWT() = default;
+  ReducedBWT(ReducedBWT const &other) { *this = other; }
+  ReducedBWT &operator=(ReducedBWT const &other);
+  // Vectors keep their storage when moved, so views stay valid
+  ReducedBWT(ReducedBWT &&) noexcept = default;
+  ReducedBWT &operator=(ReducedBWT &&) noexcept = default;
+
+  /**
+   * Reads the BWT one block at a time, in parallel: `read_symbols(first, last,
+   * symbols)` writes the symbols at [first, last) to `symbols`.
+   * @throws std::length_error if `size` does not fit an `SA_Index`
+   */
+  ReducedBWT(uint64_t size,
+             std::function<void(uint64_t, uint64_t, Marker *)> const
+                 &read_symbols);
+
+  /**
+   * Reads the BWT off the suffix array and the prg: the BWT symbol of a suffix
+   * is the prg symbol before it. Both are plain arrays, unlike the wavelet
+   * tree: prefer this when the prg is at hand.
+   */
+  ReducedBWT(FM_Index const &fm_index, marker_vec const &encoded_prg);
+
+  /** Decodes the BWT from the FM index's wavelet tree */
+  explicit ReducedBWT(FM_Index const &fm_index);
+
+  uint64_t size() const { return bwt_size; }
+
+  /** The BWT symbol at `index` */
+  Marker operator[](uint64_t index) const;
+
+  /**
+   * @param dna_base in [1, 4]; other symbols are never counted
+   * @return the number of occurrences of `dna_base` in the BWT, up to (and
+   * excluding) `upper_index`
+   */
+  uint64_t rank(uint64_t upper_index, int_Base dna_base) const;
+
+  /** The first SA index of the suffixes starting with `symbol` */
+  SA_Index first_sa_index(Marker symbol) const { return starts[symbol]; }
+
+  /**
+   * The SA interval of the suffixes starting with `symbol`; invalid (i, i - 1)
+   * if `symbol` is not in the prg.
+   */
+  SA_Interval sa_interval(Marker symbol) const {
+    return SA_Interval{starts[symbol], starts[symbol + 1] - 1};
+  }
+
+  /** The BWT indexes holding a variant marker, in increasing order */
+  ArrayView<uint32_t> marker_positions() const { return marker_index_view; }
+
+  // sdsl-style serialisation, for `sdsl::store_to_file` and `load_from_file`
+  uint64_t serialize(std::ostream &out,
+                     sdsl::structure_tree_node *v = nullptr,
+                     std::string name = "") const;
+  void load(std::istream &in);
+
+  /**
+   * Maps the BWT stored at `fpath` read-only, in place of loading it. It stays
+   * mapped while this, or any copy of it, lives.
+   */
+  void map(std::string const &fpath);
+
+ private:
+  static constexpr uint64_t block_size = 256;
+  static constexpr uint64_t bases_per_word = 32;
+  static constexpr uint64_t words_per_block = block_size / bases_per_word;
+
+  struct Block {
+    uint32_t base_counts[4]; /**< Of each base before the block */
+    uint32_t first_marker;   /**< Into `marker_indexes` */
+  };
+
+  uint64_t bwt_size{0};
+  uint64_t terminator_index{0}; /**< Where the BWT holds the prg's 0 */
+  // Ranked at random positions: on huge pages if enabled
+  /** Two bits per base, A to T as 0 to 3; markers and terminator are 0 */
+  huge_pages::Vector<uint64_t> base_codes;
+  /** One more than there are blocks: the last holds the total base counts */
+  huge_pages::Vector<Block> blocks;
+  std::vector<uint32_t> marker_indexes;
+  std::vector<Marker> marker_symbols;
+  std::vector<SA_Index> symbol_starts; /**< The `C` array, by symbol */
+
+  /** Points the views at the vectors above */
+  void view_owned_arrays();
+
+  // Queries read these: either the vectors above, or a mapped file
+  ArrayView<uint64_t> codes;
+  ArrayView<Block> block_view;
+  ArrayView<uint32_t> marker_index_view;
+  ArrayView<Marker> marker_symbol_view;
+  ArrayView<SA_Index> starts;
+  std::shared_ptr<void const> mapping; /**< Set if mapped */
+};
+}  // namespace gram
+
+#endif  // GRAMTOOLS_REDUCED_BWT_HPP
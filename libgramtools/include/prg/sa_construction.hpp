@@ -0,0 +1,50 @@
+/** @file
+ * Parallel, semi-external suffix array construction over the integer-encoded
+ * PRG.
+ *
+ * Suffixes are sorted in parallel by prefix doubling, in a number of rounds
+ * logarithmic in the longest repeat of the prg. It holds three words per
+ * suffix: when that does not fit in the memory budget, suffixes are instead
+ * distributed to on-disk partitions, delimited by splitter suffixes sampled
+ * from the text; each partition is then sorted on its own, by direct
+ * comparison in the text, and emitted in order. Only the text and one
+ * partition are held in memory. Direct comparisons scan the prefix two suffixes
+ * share, so on repetitive prgs the partitioned sort is much slower.
+ */
+#ifndef GRAMTOOLS_SA_CONSTRUCTION_HPP
+#define GRAMTOOLS_SA_CONSTRUCTION_HPP
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "common/data_types.hpp"
+
+namespace gram {
+class SAConstructionException : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+struct SAConstructionParams {
+  uint32_t num_threads = 1;
+  uint64_t memory_budget_bytes = 0; /**< For suffix array entries being
+                                       sorted; 0: unlimited */
+  std::string tmp_dirpath;          /**< Holds partitions, if any */
+};
+
+using SuffixIndex = uint64_t;
+using SuffixBlock = std::vector<SuffixIndex>;
+
+/**
+ * Sorts the suffixes of `text`, passing them to `emit` in blocks, in suffix
+ * array order.
+ * @param text must end with a unique, smallest symbol: sdsl's terminating 0.
+ */
+void construct_suffix_array(
+    marker_vec const &text, SAConstructionParams const &params,
+    std::function<void(SuffixBlock const &)> const &emit);
+}  // namespace gram
+
+#endif  // GRAMTOOLS_SA_CONSTRUCTION_HPP
@@ -0,0 +1,75 @@
+/** @file
+ * The variant locus of each suffix array (SA) position, run-length encoded.
+ *
+ * The locus of an SA index is the (site, allele) of the coverage graph node
+ * its suffix starts in; it is {0, ALLELE_UNKNOWN} outside of sites. Suffixes
+ * starting in the same allele tend to sort together, so the loci form few
+ * runs in SA order. Any SA interval then splits into per-locus sub-intervals
+ * in time proportional to the number of runs it overlaps.
+ */
+#ifndef GRAMTOOLS_SA_LOCUS_RUNS_HPP
+#define GRAMTOOLS_SA_LOCUS_RUNS_HPP
+
+#include <algorithm>
+#include <sdsl/bit_vectors.hpp>
+#include <sdsl/vectors.hpp>
+
+#include "common/data_types.hpp"
+#include "genotype/quasimap/search/types.hpp"
+#include "prg/coverage_graph.hpp"
+
+namespace gram {
+class SALocusRuns {
+ public:
+  SALocusRuns() = default;
+  /** Derives the runs from the suffix array, in parallel */
+  SALocusRuns(FM_Index const &fm_index, coverage_Graph const &coverage_graph);
+
+  // The rank and select supports point to `run_heads`: copies re-point them.
+  SALocusRuns(SALocusRuns const &other);
+  SALocusRuns(SALocusRuns &&other) noexcept;
+  SALocusRuns &operator=(SALocusRuns const &other);
+  SALocusRuns &operator=(SALocusRuns &&other) noexcept;
+
+  /**
+   * Calls `f(sub_interval, locus)` for each run overlapping `sa_interval`, in
+   * SA order; runs get clipped to `sa_interval`.
+   */
+  template <typename F>
+  void for_each_run(SA_Interval const &sa_interval, F &&f) const {
+    if (sa_interval.first > sa_interval.second) return;
+    auto run = run_heads_rank(sa_interval.first + 1) - 1;
+    SA_Index start = sa_interval.first;
+    while (start <= sa_interval.second) {
+      uint64_t const next_head = run + 1 < num_runs()
+                                     ? run_heads_select(run + 2)
+                                     : run_heads.size();
+      SA_Index const end =
+          std::min<uint64_t>(next_head - 1, sa_interval.second);
+      f(SA_Interval{start, end},
+        VariantLocus{run_sites[run], AlleleId(run_alleles[run]) - 1});
+      start = end + 1;
+      ++run;
+    }
+  }
+
+  uint64_t num_runs() const { return run_sites.size(); }
+
+  // sdsl-style serialisation, for `sdsl::store_to_file` and `load_from_file`
+  uint64_t serialize(std::ostream &out,
+                     sdsl::structure_tree_node *v = nullptr,
+                     std::string name = "") const;
+  void load(std::istream &in);
+
+ private:
+  void attach_supports();
+
+  sdsl::bit_vector run_heads; /**< Flags the first SA index of each run */
+  sdsl::rank_support_v<1> run_heads_rank;
+  sdsl::select_support_mcl<1> run_heads_select;
+  sdsl::int_vector<> run_sites;
+  sdsl::int_vector<> run_alleles; /**< Offset by one: ALLELE_UNKNOWN is 0 */
+};
+}  // namespace gram
+
+#endif  // GRAMTOOLS_SA_LOCUS_RUNS_HPP
@@ -162,6 +162,16 @@ class SeqRead {
 
   SeqIterator end() { return SeqIterator(this, -1); }
 
+  /**
+   * Bytes of the input file consumed so far, compressed bytes for gzipped
+   * files. -1 if unknown (sam/bam input).
+   */
+  long input_offset() const {
+    if (file->gz_file != NULL) return gzoffset(file->gz_file);
+    if (file->f_file != NULL) return ftell(file->f_file);
+    return -1;
+  }
+
   GenomicRead *next() {
     if (seq_read(file, read) > 0) {
       gr->name = read->name.b;
@@ -1,5 +1,6 @@
 #include "build/build.hpp"
 #include "build/check_ref.hpp"
+#include "build/kmer_index/kmer_filter.hpp"
 #include "build/parameters.hpp"
 #include "common/file_read.hpp"
 
@@ -19,6 +20,7 @@ void commands::build::run(BuildParams const &parameters) {
             << ps.size() << std::endl;
 
   prg_info.last_allele_positions = ps.get_end_positions();
+  store_end_positions(parameters, ps);
 
   std::cout << "Generating coverage graph" << std::endl;
   timer.start("Generate Coverage Graph");
@@ -47,18 +49,17 @@ void commands::build::run(BuildParams const &parameters) {
   std::cout << "Generating FM-Index" << std::endl;
   timer.start("Generate FM-Index");
   prg_info.fm_index = generate_fm_index(parameters);
+  prg_info.jump_tables =
+      MarkerJumpTables(prg_info.fm_index, prg_info.coverage_graph,
+                       prg_info.last_allele_positions);
   timer.stop();
 
   std::cout << "Generating PRG masks" << std::endl;
   timer.start("Generating PRG masks");
 
-  prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index);
-
-  prg_info.dna_bwt_masks = generate_bwt_masks(prg_info.fm_index, parameters);
-  prg_info.rank_bwt_a = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_a);
-  prg_info.rank_bwt_c = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_c);
-  prg_info.rank_bwt_g = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_g);
-  prg_info.rank_bwt_t = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_t);
+  generate_reduced_bwt(prg_info, ps.get_PRG_string(), parameters);
+  generate_bwt_masks(prg_info, parameters);
+  generate_sa_locus_runs(prg_info, parameters);
   timer.stop();
 
   std::cout << "Building kmer index"
@@ -66,6 +67,8 @@ void commands::build::run(BuildParams const &parameters) {
   timer.start("Building kmer index");
   auto kmer_index = kmer_index::build(parameters, prg_info);
   kmer_index::dump(kmer_index, parameters);
+  KmerFilter(kmer_index, parameters.kmers_size)
+      .dump(parameters.kmer_filter_fpath);
   timer.stop();
 
   timer.report();
@@ -0,0 +1,114 @@
+#include <fstream>
+
+#include "build/kmer_index/kmer_filter.hpp"
+
+using namespace gram;
+
+/** splitmix64 finaliser */
+static uint64_t mix(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+uint64_t gram::hash_kmer(int_Base const *bases, std::size_t length,
+                         bool reverse_complement) {
+  // Packs 2 bits per base, folding every 32 bases so any kmer size is handled
+  uint64_t packed = length;
+  for (std::size_t i = 0; i < length; ++i) {
+    int_Base base = reverse_complement ? 5 - bases[length - 1 - i] : bases[i];
+    packed = (packed << 2) | ((base - 1) & 3);
+    if ((i + 1) % 32 == 0) packed = mix(packed);
+  }
+  return mix(packed);
+}
+
+KmerFilter::KmerFilter(KmerIndex const &kmer_index, uint32_t kmer_size,
+                       std::size_t bits_per_kmer)
+    : kmer_size(kmer_size) {
+  std::size_t const bits_per_block = words_per_block * 64;
+  std::size_t num_blocks =
+      (kmer_index.size() * bits_per_kmer + bits_per_block - 1) /
+      bits_per_block;
+  blocks.resize(std::max<std::size_t>(num_blocks, 1) * words_per_block, 0);
+  for (auto const &entry : kmer_index) {
+    auto const &kmer = entry.first;
+    if (kmer.size() != kmer_size)
+      throw KmerFilterException("Indexed kmer of size " +
+                                std::to_string(kmer.size()) +
+                                " does not match kmer size " +
+                                std::to_string(kmer_size));
+    insert(hash_kmer(kmer.data(), kmer.size()));
+  }
+}
+
+/**
+ * The top 32 bits of the hash pick the block, by multiply-shift rather than
+ * modulo; 9 bits per probe of a second hash pick the bit inside the block.
+ */
+static std::size_t block_start(uint64_t kmer_hash, std::size_t num_words) {
+  uint64_t num_blocks = num_words / KmerFilter::words_per_block;
+  return ((kmer_hash >> 32) * num_blocks >> 32) * KmerFilter::words_per_block;
+}
+
+void KmerFilter::insert(uint64_t kmer_hash) {
+  auto *block = blocks.data() + block_start(kmer_hash, blocks.size());
+  uint64_t probe_bits = mix(kmer_hash);
+  for (std::size_t i = 0; i < num_probes; ++i, probe_bits >>= 9)
+    block[(probe_bits >> 6) & 7] |= 1ULL << (probe_bits & 63);
+}
+
+bool KmerFilter::lookup(uint64_t kmer_hash) const {
+  auto const *block = blocks.data() + block_start(kmer_hash, blocks.size());
+  uint64_t probe_bits = mix(kmer_hash);
+  bool found = true;
+  for (std::size_t i = 0; i < num_probes; ++i, probe_bits >>= 9)
+    found &= (block[(probe_bits >> 6) & 7] >> (probe_bits & 63)) & 1;
+  return found;
+}
+
+bool KmerFilter::may_contain(Sequence const &kmer) const {
+  if (empty()) return true;
+  if (kmer.size() != kmer_size) return false;
+  return lookup(hash_kmer(kmer.data(), kmer.size()));
+}
+
+bool KmerFilter::may_seed(Sequence const &read) const {
+  if (empty()) return true;
+  if (read.size() < kmer_size) return false;
+  return lookup(hash_kmer(read.data() + read.size() - kmer_size, kmer_size));
+}
+
+bool KmerFilter::may_seed_reverse_complement(Sequence const &read) const {
+  if (empty()) return true;
+  if (read.size() < kmer_size) return false;
+  // The reverse complement's last kmer is the reverse complement of the first
+  return lookup(hash_kmer(read.data(), kmer_size, true));
+}
+
+void KmerFilter::dump(std::string const &fpath) const {
+  std::ofstream fhandle(fpath, std::ios::binary);
+  uint64_t num_words = blocks.size();
+  fhandle.write(reinterpret_cast<char const *>(&kmer_size), sizeof(kmer_size));
+  fhandle.write(reinterpret_cast<char const *>(&num_words), sizeof(num_words));
+  fhandle.write(reinterpret_cast<char const *>(blocks.data()),
+                num_words * sizeof(uint64_t));
+  if (!fhandle) throw KmerFilterException("Could not write " + fpath);
+}
+
+KmerFilter KmerFilter::load(std::string const &fpath) {
+  KmerFilter filter;
+  std::ifstream fhandle(fpath, std::ios::binary);
+  uint64_t num_words{0};
+  fhandle.read(reinterpret_cast<char *>(&filter.kmer_size),
+               sizeof(filter.kmer_size));
+  fhandle.read(reinterpret_cast<char *>(&num_words), sizeof(num_words));
+  if (!fhandle || num_words % words_per_block != 0)
+    throw KmerFilterException("Could not read kmer filter from " + fpath);
+  filter.blocks.resize(num_words);
+  fhandle.read(reinterpret_cast<char *>(filter.blocks.data()),
+               num_words * sizeof(uint64_t));
+  if (!fhandle)
+    throw KmerFilterException("Could not read kmer filter from " + fpath);
+  return filter;
+}
@@ -1,44 +1,55 @@
 #include "build/kmer_index/kmers.hpp"
+
+#include <omp.h>
+
 #include <build/parameters.hpp>
 
 using namespace gram;
 
 std::vector<PrgIndexRange> gram::get_boundary_marker_indexes(
     const PRG_Info &prg_info) {
-  std::vector<PrgIndexRange> boundary_marker_indexes;
-
   using MarkerIndex = uint64_t;
-  // Need maps in order to have numeric ordering.
-  std::map<Marker, MarkerIndex> site_start_indexes;
-  std::map<Marker, MarkerIndex> allele_last_indexes;
-
   // Loop over all markers (allele and site markers).
   // We don't loop through all indices of the prg to minimise calls to
-  // `encoded_prg`.
-  for (uint64_t marker_count = 1;
-       marker_count <= prg_info.markers_mask_count_set_bits; ++marker_count) {
-    auto marker_index = prg_info.prg_markers_select(marker_count);
-    auto marker_char = prg_info.encoded_prg[marker_index];
+  // `encoded_prg`. Select queries are the costly part, so run in parallel.
+  std::vector<MarkerIndex> marker_indexes(
+      prg_info.markers_mask_count_set_bits);
+  Marker max_marker{0};
+#pragma omp parallel for schedule(static) reduction(max : max_marker)
+  for (uint64_t i = 0; i < marker_indexes.size(); ++i) {
+    marker_indexes[i] = prg_info.prg_markers_select(i + 1);
+    max_marker = std::max<Marker>(max_marker,
+                                  prg_info.encoded_prg[marker_indexes[i]]);
+  }
+
+  // Indexed by site number, (site marker - 5) / 2, for numeric ordering.
+  auto const num_sites = max_marker < 5 ? 0 : (max_marker - 5) / 2 + 1;
+  std::vector<bool> site_seen(num_sites, false);
+  std::vector<MarkerIndex> site_start_indexes(num_sites, 0);
+  std::vector<MarkerIndex> allele_last_indexes(num_sites, 0);
+  for (auto const &marker_index : marker_indexes) {
+    Marker marker_char = prg_info.encoded_prg[marker_index];
+    auto site_number = (marker_char - 5) / 2;
 
     auto marker_is_site_boundary = marker_char % 2 != 0;
     // If we have an allele marker, update last allele pos, & keep going.
     if (not marker_is_site_boundary) {
-      allele_last_indexes[marker_char] = marker_index;
+      allele_last_indexes[site_number] = marker_index;
       continue;
     }
 
     // If we have a site marker, it is always the first time we see it.
-    site_start_indexes[marker_char] = marker_index;
+    site_start_indexes[site_number] = marker_index;
+    site_seen[site_number] = true;
   }
 
   // Loop through all site markers seen, and extract the site start and end
   // positions.
-  for (auto it = site_start_indexes.begin(); it != site_start_indexes.end();
-       ++it) {
-    uint32_t site_marker = it->first;
-    auto start_index = it->second;
-    auto end_index = allele_last_indexes[site_marker + 1];
-    boundary_marker_indexes.emplace_back(PrgIndexRange{start_index, end_index});
+  std::vector<PrgIndexRange> boundary_marker_indexes;
+  for (std::size_t site_number = 0; site_number < num_sites; ++site_number) {
+    if (not site_seen[site_number]) continue;
+    boundary_marker_indexes.emplace_back(PrgIndexRange{
+        site_start_indexes[site_number], allele_last_indexes[site_number]});
   }
   return boundary_marker_indexes;
 }
@@ -102,17 +113,19 @@ uint64_t get_kmer_region_end_index(const uint64_t end_marker_index,
 std::vector<PrgIndexRange> gram::get_kmer_region_ranges(
     std::vector<PrgIndexRange> &boundary_marker_indexes,
     const uint64_t &max_read_size, const PRG_Info &prg_info) {
-  std::vector<PrgIndexRange> kmer_region_ranges;
+  std::vector<PrgIndexRange> kmer_region_ranges(
+      boundary_marker_indexes.size());
   // Unpack each variant site region, and extend it to the right in the prg.
-  for (const auto &marker_indexes_range : boundary_marker_indexes) {
-    auto &start_marker_index = marker_indexes_range.first;
-    auto &end_marker_index = marker_indexes_range.second;
+#pragma omp parallel for schedule(static)
+  for (std::size_t i = 0; i < boundary_marker_indexes.size(); ++i) {
+    auto &start_marker_index = boundary_marker_indexes[i].first;
+    auto &end_marker_index = boundary_marker_indexes[i].second;
 
     auto kmer_region_start_index = start_marker_index;
     auto kmer_region_end_index =
         get_kmer_region_end_index(end_marker_index, max_read_size, prg_info);
-    kmer_region_ranges.emplace_back(
-        PrgIndexRange{kmer_region_start_index, kmer_region_end_index});
+    kmer_region_ranges[i] =
+        PrgIndexRange{kmer_region_start_index, kmer_region_end_index};
   }
   return kmer_region_ranges;
 }
@@ -785,10 +798,19 @@ ordered_vector_set<Sequence> gram::get_prg_reverse_kmers(
 
   // this data structure orders the kmers
   ordered_vector_set<Sequence> all_kmers = {};
-  for (const auto &kmer_region_range : kmer_region_ranges) {
-    auto reverse_kmers = get_region_range_reverse_kmers(
-        kmer_region_range, parameters.kmers_size, prg_info);
-    all_kmers.insert(reverse_kmers.begin(), reverse_kmers.end());
+  // The regions do not overlap, so they are processed independently: each
+  // thread orders its own kmers, which then get spliced into the global set.
+#pragma omp parallel
+  {
+    ordered_vector_set<Sequence> thread_kmers = {};
+#pragma omp for schedule(dynamic, 1) nowait
+    for (std::size_t i = 0; i < kmer_region_ranges.size(); ++i) {
+      auto reverse_kmers = get_region_range_reverse_kmers(
+          kmer_region_ranges[i], parameters.kmers_size, prg_info);
+      thread_kmers.insert(reverse_kmers.begin(), reverse_kmers.end());
+    }
+#pragma omp critical(merge_region_kmers)
+    all_kmers.merge(thread_kmers);
   }
   return all_kmers;
 }
@@ -45,10 +45,9 @@ sdsl::int_vector<> gram::generate_allele_mask(const marker_vec &encoded_prg) {
   return allele_mask;
 }
 
-sdsl::int_vector<> gram::load_allele_mask(CommonParameters const &parameters) {
-  sdsl::int_vector<> allele_mask;
-  sdsl::load_from_file(allele_mask, parameters.allele_mask_fpath);
-  return allele_mask;
+SharedIntVector<> gram::load_allele_mask(CommonParameters const &parameters) {
+  return load_int_vector(parameters.allele_mask_fpath,
+                         parameters.map_artefacts);
 }
 
 sdsl::int_vector<> gram::generate_sites_mask(const marker_vec &encoded_prg) {
@@ -90,10 +89,9 @@ sdsl::int_vector<> gram::generate_sites_mask(const marker_vec &encoded_prg) {
   return sites_mask;
 }
 
-sdsl::int_vector<> gram::load_sites_mask(CommonParameters const &parameters) {
-  sdsl::int_vector<> sites_mask;
-  sdsl::load_from_file(sites_mask, parameters.sites_mask_fpath);
-  return sites_mask;
+SharedIntVector<> gram::load_sites_mask(CommonParameters const &parameters) {
+  return load_int_vector(parameters.sites_mask_fpath,
+                         parameters.map_artefacts);
 }
 
 sdsl::bit_vector gram::generate_prg_markers_mask(
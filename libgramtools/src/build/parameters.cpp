@@ -1,6 +1,7 @@
 #include <boost/program_options/parsers.hpp>
 #include <boost/program_options/variables_map.hpp>
 #include <iostream>
+#include <omp.h>
 
 #include "common/parameters.hpp"
 
@@ -29,7 +30,10 @@ BuildParams commands::build::parse_parameters(
       "generate all kmers of given size (as opposed to inspecting PRG for min "
       "set)")("max_read_size",
               po::value<uint32_t>(&max_read_size)->default_value(0),
-              "read maximum size for the set of reads used when quasimaping");
+              "read maximum size for the set of reads used when quasimaping")(
+      "sa_memory_budget_mb", po::value<uint64_t>()->default_value(0),
+      "memory budget (MB) for sorting the prg's suffixes; beyond it, they are "
+      "sorted in partitions on disk. 0: no budget");
 
   std::vector<std::string> opts =
       po::collect_unrecognized(parsed.options, po::include_positional);
@@ -55,6 +59,8 @@ BuildParams commands::build::parse_parameters(
   parameters.all_kmers_flag = vm["all_kmers"].as<bool>();
   parameters.max_read_size = vm["max_read_size"].as<uint32_t>();
   parameters.maximum_threads = vm["max_threads"].as<uint32_t>();
+  parameters.sa_memory_budget_mb = vm["sa_memory_budget_mb"].as<uint64_t>();
+  omp_set_num_threads(parameters.maximum_threads);
 
   if (!parameters.all_kmers_flag and parameters.max_read_size == 0)
     throw std::invalid_argument(
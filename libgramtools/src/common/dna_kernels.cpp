@@ -0,0 +1,209 @@
+#include <array>
+
+#include "common/dna_kernels.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define GRAM_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace gram;
+
+namespace {
+using byte_table = std::array<int_Base, 256>;
+
+constexpr byte_table make_encoding_table() {
+  byte_table table{};
+  table['A'] = table['a'] = 1;
+  table['C'] = table['c'] = 2;
+  table['G'] = table['g'] = 3;
+  table['T'] = table['t'] = 4;
+  return table;
+}
+
+constexpr byte_table make_complement_table() {
+  byte_table table{};
+  for (int_Base base = 1; base <= 4; ++base) table[base] = 5 - base;
+  return table;
+}
+
+constexpr byte_table encoding_table = make_encoding_table();
+constexpr byte_table complement_table = make_complement_table();
+
+bool encode_scalar(char const *dna, std::size_t length, int_Base *out) {
+  int_Base all_dna = 1;
+  for (std::size_t i = 0; i < length; ++i) {
+    out[i] = encoding_table[static_cast<unsigned char>(dna[i])];
+    all_dna &= out[i] != 0;
+  }
+  return all_dna;
+}
+
+void reverse_complement_scalar(int_Base const *read, std::size_t length,
+                               int_Base *out) {
+  for (std::size_t i = 0; i < length; ++i)
+    out[i] = complement_table[read[length - 1 - i]];
+}
+
+#ifdef GRAM_X86_KERNELS
+/*
+ * Encoding: upper-case each character by clearing bit 5 (only 'a'-'t' alias
+ * onto 'A'-'T' this way), compare against each base, and OR together the
+ * per-base codes. Any lane matching no base means the read is not pure DNA.
+ * Reverse complementation: byte-reverse each vector, then look up complements
+ * in a 16-entry shuffle table, zeroing lanes holding values above 4.
+ */
+__attribute__((target("sse4.1"))) bool encode_sse4(char const *dna,
+                                                    std::size_t length,
+                                                    int_Base *out) {
+  __m128i const case_mask = _mm_set1_epi8(static_cast<char>(0xDF));
+  __m128i const A = _mm_set1_epi8('A'), C = _mm_set1_epi8('C'),
+                G = _mm_set1_epi8('G'), T = _mm_set1_epi8('T');
+  std::size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i chars = _mm_and_si128(
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(dna + i)),
+        case_mask);
+    __m128i is_a = _mm_cmpeq_epi8(chars, A), is_c = _mm_cmpeq_epi8(chars, C),
+            is_g = _mm_cmpeq_epi8(chars, G), is_t = _mm_cmpeq_epi8(chars, T);
+    __m128i is_dna =
+        _mm_or_si128(_mm_or_si128(is_a, is_c), _mm_or_si128(is_g, is_t));
+    if (_mm_movemask_epi8(is_dna) != 0xFFFF) return false;
+    __m128i codes = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(is_a, _mm_set1_epi8(1)),
+                     _mm_and_si128(is_c, _mm_set1_epi8(2))),
+        _mm_or_si128(_mm_and_si128(is_g, _mm_set1_epi8(3)),
+                     _mm_and_si128(is_t, _mm_set1_epi8(4))));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), codes);
+  }
+  return encode_scalar(dna + i, length - i, out + i);
+}
+
+__attribute__((target("avx2"))) bool encode_avx2(char const *dna,
+                                                  std::size_t length,
+                                                  int_Base *out) {
+  __m256i const case_mask = _mm256_set1_epi8(static_cast<char>(0xDF));
+  __m256i const A = _mm256_set1_epi8('A'), C = _mm256_set1_epi8('C'),
+                G = _mm256_set1_epi8('G'), T = _mm256_set1_epi8('T');
+  std::size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i chars = _mm256_and_si256(
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dna + i)),
+        case_mask);
+    __m256i is_a = _mm256_cmpeq_epi8(chars, A),
+            is_c = _mm256_cmpeq_epi8(chars, C),
+            is_g = _mm256_cmpeq_epi8(chars, G),
+            is_t = _mm256_cmpeq_epi8(chars, T);
+    __m256i is_dna = _mm256_or_si256(_mm256_or_si256(is_a, is_c),
+                                     _mm256_or_si256(is_g, is_t));
+    if (_mm256_movemask_epi8(is_dna) != -1) return false;
+    __m256i codes = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(is_a, _mm256_set1_epi8(1)),
+                        _mm256_and_si256(is_c, _mm256_set1_epi8(2))),
+        _mm256_or_si256(_mm256_and_si256(is_g, _mm256_set1_epi8(3)),
+                        _mm256_and_si256(is_t, _mm256_set1_epi8(4))));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), codes);
+  }
+  return encode_sse4(dna + i, length - i, out + i);
+}
+
+__attribute__((target("sse4.1"))) void reverse_complement_sse4(
+    int_Base const *read, std::size_t length, int_Base *out) {
+  __m128i const reverse =
+      _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  __m128i const complements =
+      _mm_setr_epi8(0, 4, 3, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  __m128i const max_base = _mm_set1_epi8(4);
+  std::size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i bases = _mm_shuffle_epi8(
+        _mm_loadu_si128(
+            reinterpret_cast<__m128i const *>(read + length - i - 16)),
+        reverse);
+    __m128i in_range = _mm_cmpeq_epi8(_mm_min_epu8(bases, max_base), bases);
+    __m128i result =
+        _mm_and_si128(_mm_shuffle_epi8(complements, bases), in_range);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), result);
+  }
+  reverse_complement_scalar(read, length - i, out + i);
+}
+
+__attribute__((target("avx2"))) void reverse_complement_avx2(
+    int_Base const *read, std::size_t length, int_Base *out) {
+  // _mm256_shuffle_epi8 works within 128-bit lanes: reverse each lane, then
+  // swap the lanes.
+  __m256i const reverse = _mm256_setr_epi8(
+      15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11,
+      10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  __m256i const complements =
+      _mm256_setr_epi8(0, 4, 3, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 3,
+                       2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  __m256i const max_base = _mm256_set1_epi8(4);
+  std::size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i bases = _mm256_shuffle_epi8(
+        _mm256_loadu_si256(
+            reinterpret_cast<__m256i const *>(read + length - i - 32)),
+        reverse);
+    bases = _mm256_permute2x128_si256(bases, bases, 0x01);
+    __m256i in_range =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(bases, max_base), bases);
+    __m256i result =
+        _mm256_and_si256(_mm256_shuffle_epi8(complements, bases), in_range);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), result);
+  }
+  reverse_complement_sse4(read, length - i, out + i);
+}
+#endif
+}  // namespace
+
+SimdLevel gram::best_simd_level() {
+#ifdef GRAM_X86_KERNELS
+  static SimdLevel const level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::avx2;
+    if (__builtin_cpu_supports("sse4.1")) return SimdLevel::sse4;
+    return SimdLevel::scalar;
+  }();
+  return level;
+#else
+  return SimdLevel::scalar;
+#endif
+}
+
+bool gram::encode_dna_bases(char const *dna, std::size_t length,
+                            Sequence &out, SimdLevel level) {
+  out.resize(length);
+  bool is_dna;
+  switch (level) {
+#ifdef GRAM_X86_KERNELS
+    case SimdLevel::avx2:
+      is_dna = encode_avx2(dna, length, out.data());
+      break;
+    case SimdLevel::sse4:
+      is_dna = encode_sse4(dna, length, out.data());
+      break;
+#endif
+    default:
+      is_dna = encode_scalar(dna, length, out.data());
+  }
+  if (!is_dna) out.clear();
+  return is_dna;
+}
+
+void gram::reverse_complement_read(Sequence const &read, Sequence &out,
+                                   SimdLevel level) {
+  out.resize(read.size());
+  switch (level) {
+#ifdef GRAM_X86_KERNELS
+    case SimdLevel::avx2:
+      reverse_complement_avx2(read.data(), read.size(), out.data());
+      break;
+    case SimdLevel::sse4:
+      reverse_complement_sse4(read.data(), read.size(), out.data());
+      break;
+#endif
+    default:
+      reverse_complement_scalar(read.data(), read.size(), out.data());
+  }
+}
@@ -0,0 +1,39 @@
+#include <atomic>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "common/huge_pages.hpp"
+
+using namespace gram;
+
+static std::atomic<bool> huge_pages_enabled{false};
+
+void huge_pages::enable(bool enabled) { huge_pages_enabled = enabled; }
+
+bool huge_pages::enabled() { return huge_pages_enabled; }
+
+void huge_pages::advise(void const *data, std::size_t num_bytes) {
+#ifdef __linux__
+  if (!enabled() || data == nullptr) return;
+  // `madvise` takes whole pages: the ones starting within the range
+  std::uintptr_t const os_page_size = sysconf(_SC_PAGESIZE);
+  auto const start = reinterpret_cast<std::uintptr_t>(data);
+  auto const first = (start + os_page_size - 1) / os_page_size * os_page_size;
+  auto const last = (start + num_bytes) / os_page_size * os_page_size;
+  if (first >= last) return;
+  auto const page = reinterpret_cast<void *>(first);
+  // Not all mappings can take huge pages (eg files): ignore failures
+  madvise(page, last - first, MADV_HUGEPAGE);
+  madvise(page, last - first, MADV_WILLNEED);
+#endif
+}
+
+void huge_pages::advise_allocation(void *data, std::size_t num_bytes) {
+#ifdef __linux__
+  if (enabled()) madvise(data, num_bytes, MADV_HUGEPAGE);
+#endif
+}
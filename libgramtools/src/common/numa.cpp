@@ -0,0 +1,180 @@
+#include <omp.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "common/numa.hpp"
+
+using namespace gram;
+
+std::vector<int> numa::parse_list(std::string const &list) {
+  std::vector<int> result;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") continue;
+    auto const dash = range.find('-');
+    try {
+      int const first = std::stoi(range.substr(0, dash));
+      int const last =
+          dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int i = first; i <= last; ++i) result.push_back(i);
+    } catch (std::exception const &) {
+      return {};
+    }
+  }
+  return result;
+}
+
+/** The first line of a sysfs file; empty if it cannot be read */
+static std::string read_sysfs(std::string const &fpath) {
+  std::ifstream fhandle(fpath);
+  std::string line;
+  std::getline(fhandle, line);
+  return line;
+}
+
+std::vector<int> numa::online_nodes() {
+  auto nodes = parse_list(read_sysfs("/sys/devices/system/node/online"));
+  if (nodes.empty()) nodes.push_back(0);
+  return nodes;
+}
+
+std::vector<int> numa::node_cpus(int node) {
+  return parse_list(read_sysfs("/sys/devices/system/node/node" +
+                               std::to_string(node) + "/cpulist"));
+}
+
+/** Sets the policy of the calling thread's future allocations */
+static bool set_memory_policy(int mode, std::vector<int> const &nodes) {
+#ifdef __linux__
+  constexpr std::size_t word_bits = 8 * sizeof(unsigned long);
+  std::size_t num_bits{0};
+  for (auto const &node : nodes)
+    num_bits = std::max<std::size_t>(num_bits, node + 1);
+  std::vector<unsigned long> mask(num_bits / word_bits + 1, 0);
+  for (auto const &node : nodes)
+    mask[node / word_bits] |= 1UL << (node % word_bits);
+  // The kernel counts one more node than there are bits in the mask
+  unsigned long const max_node = nodes.empty() ? 0 : num_bits + 1;
+  return syscall(SYS_set_mempolicy, mode, nodes.empty() ? nullptr : mask.data(),
+                 max_node) == 0;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Sets the policy in the calling thread and in each thread of an OpenMP
+ * parallel region, which the calling thread joins as thread number 0.
+ */
+static bool set_threads_memory_policy(int mode, std::vector<int> const &nodes) {
+  bool all_set{true};
+#pragma omp parallel reduction(&& : all_set)
+  all_set = set_memory_policy(mode, nodes);
+  return all_set;
+}
+
+numa::ScopedInterleave::ScopedInterleave(bool enabled) {
+#ifdef __linux__
+  if (!enabled) return;
+  auto const nodes = online_nodes();
+  if (nodes.size() < 2) return;
+  interleaving = set_threads_memory_policy(MPOL_INTERLEAVE, nodes);
+  if (!interleaving)
+    std::cerr << "Warning: could not interleave memory over NUMA nodes"
+              << std::endl;
+#endif
+}
+
+void numa::ScopedInterleave::stop() {
+#ifdef __linux__
+  if (!interleaving) return;
+  set_threads_memory_policy(MPOL_DEFAULT, {});
+  interleaving = false;
+#endif
+}
+
+#ifdef __linux__
+/** Pins the calling thread to `cpus`, if any */
+static void set_cpus(std::vector<int> const &cpus) {
+  if (cpus.empty()) return;
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (auto const &cpu : cpus) CPU_SET(cpu, &cpu_set);
+  // Pins the calling thread only
+  sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+}
+#endif
+
+numa::ScopedPinning::ScopedPinning(bool enabled) {
+#ifdef __linux__
+  if (!enabled) return;
+  auto const nodes = online_nodes();
+  if (nodes.size() < 2) return;
+  cpu_set_t cpu_set;
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) return;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    if (CPU_ISSET(cpu, &cpu_set)) original_cpus.push_back(cpu);
+  std::vector<std::vector<int>> cpus;
+  for (auto const &node : nodes) cpus.push_back(node_cpus(node));
+
+#pragma omp parallel
+  set_cpus(
+      cpus[omp_get_thread_num() * cpus.size() / omp_get_num_threads()]);
+  pinned = true;
+#endif
+}
+
+void numa::ScopedPinning::stop() {
+#ifdef __linux__
+  if (!pinned) return;
+#pragma omp parallel
+  set_cpus(original_cpus);
+  pinned = false;
+#endif
+}
+
+std::map<int, uint64_t> numa::resident_kb_per_node(std::istream &numa_maps) {
+  std::map<int, uint64_t> result;
+  std::string line;
+  while (std::getline(numa_maps, line)) {
+    std::stringstream ss(line);
+    std::string field;
+    uint64_t page_kb{4};
+    std::map<int, uint64_t> pages;
+    while (ss >> field) {
+      auto const equals = field.find('=');
+      if (equals == std::string::npos) continue;
+      auto const key = field.substr(0, equals);
+      auto const value = field.substr(equals + 1);
+      try {
+        if (key == "kernelpagesize_kB")
+          page_kb = std::stoull(value);
+        else if (key.size() > 1 && key[0] == 'N' &&
+                 key.find_first_not_of("0123456789", 1) == std::string::npos)
+          pages[std::stoi(key.substr(1))] += std::stoull(value);
+      } catch (std::exception const &) {
+        continue;
+      }
+    }
+    for (auto const &entry : pages)
+      result[entry.first] += entry.second * page_kb;
+  }
+  return result;
+}
+
+std::map<int, uint64_t> numa::resident_kb_per_node() {
+  std::ifstream numa_maps("/proc/self/numa_maps");
+  if (!numa_maps) return {};
+  return resident_kb_per_node(numa_maps);
+}
@@ -29,11 +29,15 @@ void gram::fill_common_parameters(CommonParameters& parameters,
   parameters.prg_coords_fpath = full_path(gram_dirpath, "prg_coords.tsv");
   parameters.fm_index_fpath = full_path(gram_dirpath, "fm_index");
   parameters.cov_graph_fpath = full_path(gram_dirpath, "cov_graph");
+  parameters.end_positions_fpath = full_path(gram_dirpath, "prg_end_positions");
+  parameters.sa_locus_runs_fpath = full_path(gram_dirpath, "sa_locus_runs");
+  parameters.reduced_bwt_fpath = full_path(gram_dirpath, "reduced_bwt");
   parameters.sites_mask_fpath = full_path(gram_dirpath, "variant_site_mask");
   parameters.allele_mask_fpath = full_path(gram_dirpath, "allele_mask");
 
   parameters.kmer_index_fpath = full_path(gram_dirpath, "kmer_index");
   parameters.kmers_fpath = full_path(gram_dirpath, "kmers");
+  parameters.kmer_filter_fpath = full_path(gram_dirpath, "kmer_filter");
   parameters.kmers_stats_fpath = full_path(gram_dirpath, "kmers_stats");
   parameters.sa_intervals_fpath = full_path(gram_dirpath, "sa_intervals");
   parameters.paths_fpath = full_path(gram_dirpath, "paths");
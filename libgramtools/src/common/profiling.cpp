@@ -0,0 +1,399 @@
+#include <unistd.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#include "common/profiling.hpp"
+
+using namespace gram;
+using namespace gram::profiling;
+
+namespace gram::profiling {
+struct TimerNode {
+  char const *name;
+  TimerNode *parent;
+  uint64_t nanoseconds = 0;
+  uint64_t calls = 0;
+  std::vector<std::unique_ptr<TimerNode>> children;
+
+  TimerNode(char const *name, TimerNode *parent)
+      : name(name), parent(parent) {}
+
+  TimerNode *child(char const *child_name) {
+    for (auto const &child : children)
+      if (child->name == child_name ||
+          std::string(child->name) == child_name)
+        return child.get();
+    children.push_back(std::make_unique<TimerNode>(child_name, this));
+    return children.back().get();
+  }
+};
+
+/** Hardware event counts: cycles, then cache misses */
+using HardwareCounts = std::array<uint64_t, 2>;
+}  // namespace gram::profiling
+
+namespace gram::profiling::detail {
+struct ThreadProfile {
+  std::size_t id;
+  pid_t tid;
+  Counts counts{};
+  TimerNode root{"", nullptr};
+  TimerNode *current = &root;
+  std::array<int, 2> perf_fds{-1, -1};
+};
+
+std::atomic<bool> detailed_enabled{false};
+thread_local Counts *this_thread_counts = nullptr;
+}  // namespace gram::profiling::detail
+
+using detail::ThreadProfile;
+
+static thread_local ThreadProfile *this_thread_profile = nullptr;
+
+static ThreadProfile *get_thread_profile() {
+  if (this_thread_profile == nullptr) detail::register_thread();
+  return this_thread_profile;
+}
+
+namespace {
+struct StageRecord {
+  std::string name;
+  double seconds = 0;
+  uint64_t rss_start_kb = 0;
+  uint64_t rss_end_kb = 0;
+  uint64_t peak_rss_kb = 0;
+  HardwareCounts hardware_start{}, hardware_end{};
+  std::chrono::steady_clock::time_point start_time;
+  std::list<StageRecord> children;
+};
+
+/** Profiles persist once registered: threads hold pointers to them */
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadProfile>> threads;
+  bool hardware_counters = false;
+
+  StageRecord root_stage;
+  std::vector<StageRecord *> open_stages{&root_stage};
+  bool peak_rss_per_stage = false;
+};
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+pid_t get_tid() {
+#ifdef __linux__
+  return static_cast<pid_t>(syscall(SYS_gettid));
+#else
+  return getpid();
+#endif
+}
+
+/**
+ * Opens cycle and cache miss counters for thread `tid`, counting user space
+ * only. Leaves the file descriptors at -1 if the kernel refuses them.
+ */
+void open_hardware_counters(ThreadProfile &profile) {
+#ifdef __linux__
+  std::array<uint64_t, 2> const configs{PERF_COUNT_HW_CPU_CYCLES,
+                                        PERF_COUNT_HW_CACHE_MISSES};
+  for (std::size_t i = 0; i < configs.size(); ++i) {
+    if (profile.perf_fds[i] >= 0) continue;
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    profile.perf_fds[i] = static_cast<int>(
+        syscall(SYS_perf_event_open, &attr, profile.tid, -1, -1, 0));
+  }
+#endif
+}
+
+void close_hardware_counters(ThreadProfile &profile) {
+  for (auto &fd : profile.perf_fds) {
+    if (fd >= 0) close(fd);
+    fd = -1;
+  }
+}
+
+/** Summed over all registered threads. Caller must hold the registry lock. */
+HardwareCounts read_hardware_counters(Registry const &reg) {
+  HardwareCounts result{};
+  for (auto const &profile : reg.threads)
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      uint64_t value;
+      if (profile->perf_fds[i] >= 0 &&
+          read(profile->perf_fds[i], &value, sizeof(value)) == sizeof(value))
+        result[i] += value;
+    }
+  return result;
+}
+
+/** From a /proc/self/status line such as "VmHWM:  1234 kB" */
+uint64_t read_status_kb(std::string const &field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+    if (line.compare(0, field.size(), field) == 0)
+      return std::stoull(line.substr(field.size() + 1));
+  return 0;
+}
+
+/**
+ * Makes the kernel's peak RSS restart from the current RSS, so that peaks can
+ * be attributed to stages. Only possible on Linux >= 4.0.
+ */
+bool reset_peak_rss() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5" << std::flush;
+  return clear_refs.good();
+}
+
+/**
+ * Folds the peak RSS since the last reset, or since the process started, into
+ * all open stages
+ */
+void update_open_stages_peak_rss(Registry &reg) {
+  auto const peak_rss_kb = read_status_kb("VmHWM:");
+  for (auto *stage : reg.open_stages)
+    stage->peak_rss_kb = std::max(stage->peak_rss_kb, peak_rss_kb);
+}
+
+JSON stage_to_json(StageRecord const &stage, bool hardware_counters) {
+  JSON result{{"name", stage.name},
+              {"seconds", stage.seconds},
+              {"rss_start_kb", stage.rss_start_kb},
+              {"rss_end_kb", stage.rss_end_kb},
+              {"peak_rss_kb", stage.peak_rss_kb}};
+  if (hardware_counters) {
+    result["cycles"] = stage.hardware_end[0] - stage.hardware_start[0];
+    result["cache_misses"] = stage.hardware_end[1] - stage.hardware_start[1];
+  }
+  if (!stage.children.empty()) {
+    result["stages"] = JSON::array();
+    for (auto const &child : stage.children)
+      result["stages"].push_back(stage_to_json(child, hardware_counters));
+  }
+  return result;
+}
+
+/** Timers of all threads, summed by their path from the root */
+struct MergedTimer {
+  uint64_t nanoseconds = 0;
+  uint64_t calls = 0;
+  std::map<std::string, MergedTimer> children;
+
+  void merge(TimerNode const &node) {
+    nanoseconds += node.nanoseconds;
+    calls += node.calls;
+    for (auto const &child : node.children)
+      children[child->name].merge(*child);
+  }
+
+  JSON children_to_json() const {
+    JSON result = JSON::array();
+    for (auto const &child : children) {
+      JSON entry{{"name", child.first},
+                 {"seconds", child.second.nanoseconds * 1e-9},
+                 {"calls", child.second.calls}};
+      if (!child.second.children.empty())
+        entry["timers"] = child.second.children_to_json();
+      result.push_back(entry);
+    }
+    return result;
+  }
+};
+
+JSON counts_to_json(Counts const &counts) {
+  JSON result;
+  for (std::size_t i = 0; i < num_counters; ++i)
+    result[counter_name(static_cast<Counter>(i))] = counts[i];
+  return result;
+}
+
+void clear_timers(TimerNode &root) {
+  root.children.clear();
+  root.nanoseconds = root.calls = 0;
+}
+}  // namespace
+
+std::string gram::profiling::counter_name(Counter counter) {
+  switch (counter) {
+    case Counter::reads_seeded:
+      return "reads_seeded";
+    case Counter::search_states_created:
+      return "search_states_created";
+    case Counter::sa_entries_touched:
+      return "sa_entries_touched";
+    case Counter::vBWT_jumps:
+      return "vBWT_jumps";
+    default:
+      return "unknown";
+  }
+}
+
+Counts *gram::profiling::detail::register_thread() {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  auto profile = std::make_unique<ThreadProfile>();
+  profile->id = reg.threads.size();
+  profile->tid = get_tid();
+  if (reg.hardware_counters) open_hardware_counters(*profile);
+  this_thread_profile = profile.get();
+  this_thread_counts = &profile->counts;
+  reg.threads.push_back(std::move(profile));
+  return this_thread_counts;
+}
+
+void gram::profiling::enable_detailed(bool hardware_counters) {
+  get_thread_profile();
+  auto &reg = registry();
+  if (hardware_counters) {
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.hardware_counters = true;
+    for (auto &profile : reg.threads) open_hardware_counters(*profile);
+    if (reg.threads.front()->perf_fds[0] < 0) {
+      std::cerr << "Warning: hardware counters unavailable (see "
+                   "/proc/sys/kernel/perf_event_paranoid); profiling without "
+                   "them"
+                << std::endl;
+      for (auto &profile : reg.threads) close_hardware_counters(*profile);
+      reg.hardware_counters = false;
+    }
+  }
+  detail::detailed_enabled.store(true, std::memory_order_relaxed);
+}
+
+void gram::profiling::enable_peak_rss_per_stage() {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  reg.peak_rss_per_stage = true;
+}
+
+void gram::profiling::reset() {
+  detail::detailed_enabled.store(false, std::memory_order_relaxed);
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for (auto &profile : reg.threads) {
+    profile->counts.fill(0);
+    clear_timers(profile->root);
+    profile->current = &profile->root;
+    close_hardware_counters(*profile);
+  }
+  reg.hardware_counters = false;
+  reg.peak_rss_per_stage = false;
+  reg.root_stage.children.clear();
+  reg.open_stages = {&reg.root_stage};
+}
+
+void gram::profiling::begin_stage(std::string name) {
+  get_thread_profile();
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+
+  update_open_stages_peak_rss(reg);
+  if (reg.peak_rss_per_stage) reg.peak_rss_per_stage = reset_peak_rss();
+
+  auto &stage = reg.open_stages.back()->children.emplace_back();
+  stage.name = std::move(name);
+  stage.rss_start_kb = current_rss_kb();
+  stage.peak_rss_kb = stage.rss_start_kb;
+  if (reg.hardware_counters) stage.hardware_start = read_hardware_counters(reg);
+  reg.open_stages.push_back(&stage);
+  stage.start_time = std::chrono::steady_clock::now();
+}
+
+void gram::profiling::end_stage() {
+  auto const end_time = std::chrono::steady_clock::now();
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  if (reg.open_stages.size() == 1) {
+    std::cerr << "Profiling: end_stage called with no open stage" << std::endl;
+    return;
+  }
+
+  auto &stage = *reg.open_stages.back();
+  std::chrono::duration<double> const elapsed = end_time - stage.start_time;
+  stage.seconds = elapsed.count();
+  if (reg.hardware_counters) stage.hardware_end = read_hardware_counters(reg);
+  stage.rss_end_kb = current_rss_kb();
+  update_open_stages_peak_rss(reg);
+  reg.open_stages.pop_back();
+}
+
+void ScopedTimer::start(char const *name) {
+  profile = get_thread_profile();
+  node = profile->current->child(name);
+  profile->current = node;
+  start_time = std::chrono::steady_clock::now();
+}
+
+void ScopedTimer::stop() {
+  auto const elapsed = std::chrono::steady_clock::now() - start_time;
+  node->nanoseconds +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  ++node->calls;
+  profile->current = node->parent;
+}
+
+uint64_t gram::profiling::current_rss_kb() {
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size_pages, resident_pages;
+  if (!(statm >> size_pages >> resident_pages)) return 0;
+  return resident_pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+JSON gram::profiling::to_json() {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+
+  JSON result;
+  result["detailed"] = detailed_enabled();
+  result["hardware_counters"] = reg.hardware_counters;
+  result["peak_rss_per_stage"] = reg.peak_rss_per_stage;
+  result["stages"] = JSON::array();
+  for (auto const &stage : reg.root_stage.children)
+    result["stages"].push_back(stage_to_json(stage, reg.hardware_counters));
+
+  MergedTimer merged;
+  Counts total_counts{};
+  result["threads"] = JSON::array();
+  for (auto const &profile : reg.threads) {
+    merged.merge(profile->root);
+    uint64_t timed_nanoseconds{0};
+    for (auto const &timer : profile->root.children)
+      timed_nanoseconds += timer->nanoseconds;
+    for (std::size_t i = 0; i < num_counters; ++i)
+      total_counts[i] += profile->counts[i];
+    JSON thread{{"thread", profile->id},
+                {"timed_seconds", timed_nanoseconds * 1e-9},
+                {"counters", counts_to_json(profile->counts)}};
+    result["threads"].push_back(thread);
+  }
+  result["timers"] = merged.children_to_json();
+  result["counters"] = counts_to_json(total_counts);
+  return result;
+}
+
+void gram::profiling::write_json(std::string const &fpath) {
+  std::ofstream fhandle(fpath);
+  if (!fhandle.is_open())
+    throw std::ios_base::failure("Could not open: " + fpath);
+  fhandle << std::setw(4) << to_json() << std::endl;
+}
@@ -16,4 +16,30 @@ uint32_t RandomInclusiveInt::generate(uint32_t min, uint32_t max) const {
   std::uniform_int_distribution<std::mt19937_64::result_type> range(min, max);
   return range(random_number_generator);
 }
+
+CounterRandom::Counter CounterRandom::philox(Counter counter, Key key) {
+  constexpr uint64_t multipliers[2] = {0xD2511F53, 0xCD9E8D57};
+  constexpr uint32_t key_increments[2] = {0x9E3779B9, 0xBB67AE85};
+  for (int round = 0; round < 10; ++round) {
+    uint64_t const product0 = multipliers[0] * counter[0];
+    uint64_t const product1 = multipliers[1] * counter[2];
+    counter = {uint32_t(product1 >> 32) ^ counter[1] ^ key[0],
+               uint32_t(product1),
+               uint32_t(product0 >> 32) ^ counter[3] ^ key[1],
+               uint32_t(product0)};
+    key[0] += key_increments[0];
+    key[1] += key_increments[1];
+  }
+  return counter;
+}
+
+uint32_t CounterRandom::generate(uint32_t min, uint32_t max) const {
+  auto draw_counter = counter;
+  draw_counter[3] = num_draws++;
+  auto const bits = philox(draw_counter, key);
+  uint64_t const draw = uint64_t(bits[0]) << 32 | bits[1];
+  // Scales the draw to the range: biased by at most range / 2^64
+  uint64_t const range = uint64_t(max) - min + 1;
+  return min + uint32_t((unsigned __int128)draw * range >> 64);
+}
 }  // namespace gram
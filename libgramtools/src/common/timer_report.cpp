@@ -3,18 +3,22 @@
 #include <iostream>
 #include <vector>
 
+#include "common/profiling.hpp"
 #include "common/timer_report.hpp"
 
 using namespace gram;
 
 void gram::TimerReport::start(std::string note) {
   this->note = note;
+  profiling::begin_stage(note);
   timer.start();
 }
 
 void TimerReport::stop() {
   if (this->note.empty())
     std::cerr << "TimerReport stop called with empty note" << std::endl;
+  else
+    profiling::end_stage();
   boost::timer::cpu_times times = timer.elapsed();
   double elapsed_time = (times.user + times.system) * 1e-9;
   Entry entry = std::make_pair(note, elapsed_time);
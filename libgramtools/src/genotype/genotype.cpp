@@ -1,8 +1,12 @@
 #include "genotype/genotype.hpp"
 
 #include "build/kmer_index/load.hpp"
+#include "common/huge_pages.hpp"
+#include "common/numa.hpp"
+#include "common/profiling.hpp"
 #include "common/timer_report.hpp"
 #include "genotype/infer/level_genotyping/runner.hpp"
+#include "genotype/infer/output_specs/genotype_store.hpp"
 #include "genotype/infer/output_specs/make_json.hpp"
 #include "genotype/infer/output_specs/make_vcf.hpp"
 #include "genotype/infer/output_specs/segment_tracker.hpp"
@@ -12,17 +16,13 @@
 using namespace gram;
 using namespace gram::genotype;
 
-namespace gram::genotype {
-void write_deduped_p_refs(Fastas const& p_refs, std::string const& fpath) {
-  unique_Fastas deduped_p_refs{p_refs.begin(), p_refs.end()};
-  std::ofstream pers_ref_fhandle(fpath);
-  for (auto& p_ref : deduped_p_refs) pers_ref_fhandle << p_ref << std::endl;
-  pers_ref_fhandle.close();
-}
-}  // namespace gram::genotype
-
 void gram::commands::genotype::run(GenotypeParams const& parameters,
                                    bool const& debug) {
+  if (parameters.profile) {
+    profiling::enable_detailed(true);
+    profiling::enable_peak_rss_per_stage();
+  }
+  huge_pages::enable(parameters.huge_pages);
   auto timer = TimerReport();
   /**
    * Quasimap
@@ -34,16 +34,36 @@ void gram::commands::genotype::run(GenotypeParams const& parameters,
   readstats.compute_base_error_rate(first_reads_fpath);
 
   timer.start("Load data");
+  // Queried by the mapping threads of all nodes
+  numa::ScopedInterleave interleave(parameters.numa);
   std::cout << "Loading PRG data" << std::endl;
-  const auto prg_info = load_prg_info(parameters);
+  const auto prg_info = [&] {
+    profiling::ScopedStage stage("Load PRG");
+    return load_prg_info(parameters);
+  }();
   std::cout << "Loading kmer index data" << std::endl;
-  const auto kmer_index = kmer_index::load(parameters);
+  const auto kmer_index = [&] {
+    profiling::ScopedStage stage("Load kmer index");
+    return kmer_index::load(parameters);
+  }();
+  // Build directories predating the kmer filter: build it from the index
+  const auto kmer_filter =
+      fs::exists(parameters.kmer_filter_fpath)
+          ? KmerFilter::load(parameters.kmer_filter_fpath)
+          : KmerFilter(kmer_index, parameters.kmers_size);
+  interleave.stop();
+  if (parameters.numa) {
+    std::cout << "Resident memory per NUMA node:";
+    for (auto const& entry : numa::resident_kb_per_node())
+      std::cout << " node" << entry.first << " " << entry.second << " kB;";
+    std::cout << std::endl;
+  }
   timer.stop();
 
   std::cout << "Running quasimap" << std::endl;
   timer.start("Quasimap");
   auto quasimap_stats =
-      quasimap_reads(parameters, kmer_index, prg_info, readstats);
+      quasimap_reads(parameters, kmer_index, kmer_filter, prg_info, readstats);
 
   // Commit the read stats into quasimap output dir.
   std::cout << "Writing read stats to " << parameters.read_stats_fpath
@@ -60,6 +80,19 @@ void gram::commands::genotype::run(GenotypeParams const& parameters,
             << std::endl;
   std::cout << "Count mapped reads: " << quasimap_stats.mapped_reads_count
             << std::endl;
+  auto const searched_reads_count = quasimap_stats.all_reads_count -
+                                    quasimap_stats.skipped_reads_count -
+                                    quasimap_stats.prefiltered_reads_count;
+  std::cout << "Count reads without a seed kmer (prefiltered): "
+            << quasimap_stats.prefiltered_reads_count << std::endl;
+  std::cout << "Count reads searched from a candidate seed kmer: "
+            << searched_reads_count << std::endl;
+  std::cout << "Count reads found in the read cache: "
+            << quasimap_stats.read_cache_hits << " of "
+            << quasimap_stats.read_cache_lookups << std::endl;
+  std::cout << "Count reads resumed from a cached suffix: "
+            << quasimap_stats.suffix_cache_hits << " of "
+            << quasimap_stats.suffix_cache_lookups << std::endl;
   timer.stop();
 
   /**
@@ -78,41 +111,66 @@ void gram::commands::genotype::run(GenotypeParams const& parameters,
   }
 
   std::cout << "Running genotyping model" << std::endl;
-  LevelGenotyper genotyper{prg_info.coverage_graph,
-                           quasimap_stats.coverage.grouped_allele_counts,
-                           readstats,
-                           parameters.ploidy,
-                           true,
-                           debug_file};
+  auto genotyper = [&] {
+    profiling::ScopedStage stage("Genotyping model");
+    return LevelGenotyper{prg_info.coverage_graph,
+                          quasimap_stats.coverage.grouped_allele_counts,
+                          readstats,
+                          parameters.ploidy,
+                          true,
+                          debug_file};
+  }();
 
   std::ifstream coords_file(parameters.prg_coords_fpath);
   SegmentTracker tracker(coords_file);
   coords_file.close();
 
   std::cout << "Producing json vcf" << std::endl;
-  std::ofstream geno_json_fhandle(parameters.genotyped_json_fpath);
   auto gtyper = std::make_shared<LevelGenotyper>(genotyper);
-  auto sample_json = make_json_prg(gtyper, tracker);
-  sample_json->set_sample_info(parameters.sample_id,
-                               "made by gramtools genotype");
-  geno_json_fhandle << sample_json->get_prg() << std::endl;
-  geno_json_fhandle.close();
+  auto sample_json = [&] {
+    profiling::ScopedStage stage("Write json");
+    std::ofstream geno_json_fhandle(parameters.genotyped_json_fpath);
+    auto sample_json = make_json_prg(gtyper, tracker);
+    sample_json->set_sample_info(parameters.sample_id,
+                                 "made by gramtools genotype");
+    geno_json_fhandle << sample_json->get_prg() << std::endl;
+    return sample_json;
+  }();
+
+  std::cout << "Producing genotype store" << std::endl;
+  {
+    profiling::ScopedStage stage("Write genotype store");
+    // Straight from the genotyped sites, as the json would be parsed back
+    tracker.reset();
+    GenotypeStore gtype_store;
+    gtype_store.add_sample(parameters.sample_id,
+                           genotyper.get_genotyped_records(), tracker,
+                           sample_json->get_prg().at("Model"));
+    gtype_store.write(parameters.genotyped_store_fpath);
+  }
 
   std::cout << "Producing personalised reference" << std::endl;
-  auto sites = genotyper.get_genotyped_records();
-  tracker.reset();
-  auto p_refs =
-      get_personalised_ref(prg_info.coverage_graph.root, sites, tracker);
-  std::string desc = parameters.sample_id +
-                     " personalised reference made by gramtools genotype";
-  add_description(p_refs, desc);
-
-  write_deduped_p_refs(p_refs, parameters.personalised_ref_fpath);
+  {
+    profiling::ScopedStage stage("Write personalised reference");
+    auto sites = genotyper.get_genotyped_records();
+    tracker.reset();
+    std::string desc = parameters.sample_id +
+                       " personalised reference made by gramtools genotype";
+    std::ofstream pers_ref_fhandle(parameters.personalised_ref_fpath);
+    write_personalised_ref(pers_ref_fhandle, prg_info.coverage_graph.root,
+                           sites, tracker, desc);
+  }
 
   std::cout << "Producing vcf" << std::endl;
-  tracker.reset();
-  write_vcf(parameters, gtyper, tracker);
+  {
+    profiling::ScopedStage stage("Write vcf");
+    tracker.reset();
+    write_vcf(parameters, gtyper, tracker);
+  }
 
   timer.stop();
   timer.report();
+
+  std::cout << "Writing profile to " << parameters.profile_fpath << std::endl;
+  profiling::write_json(parameters.profile_fpath);
 }
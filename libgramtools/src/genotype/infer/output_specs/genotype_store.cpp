@@ -0,0 +1,540 @@
+#include <cstring>
+
+#include "genotype/infer/interfaces.hpp"
+#include "genotype/infer/output_specs/fields.hpp"
+#include "genotype/infer/output_specs/genotype_store.hpp"
+#include "genotype/infer/output_specs/segment_tracker.hpp"
+
+using namespace gram::genotype::output_spec;
+using namespace gram::genotype::output_spec::store_encoding;
+
+static char const store_magic[] = "gramgts1";
+static std::size_t const store_magic_size{8};
+
+void store_encoding::put_varint(std::string& out, uint64_t val) {
+  while (val >= 0x80) {
+    out.push_back(static_cast<char>((val & 0x7f) | 0x80));
+    val >>= 7;
+  }
+  out.push_back(static_cast<char>(val));
+}
+
+uint64_t store_encoding::get_varint(char const*& ptr, char const* end) {
+  uint64_t result{0};
+  int shift{0};
+  while (true) {
+    if (ptr >= end || shift > 63)
+      throw GenotypeStoreException("Truncated or corrupt varint");
+    auto const byte = static_cast<uint8_t>(*ptr++);
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) break;
+    shift += 7;
+  }
+  return result;
+}
+
+void store_encoding::put_double(std::string& out, double val) {
+  char buf[sizeof(double)];
+  std::memcpy(buf, &val, sizeof(double));
+  out.append(buf, sizeof(double));
+}
+
+double store_encoding::get_double(char const*& ptr, char const* end) {
+  if (end - ptr < static_cast<std::ptrdiff_t>(sizeof(double)))
+    throw GenotypeStoreException("Truncated double");
+  double result;
+  std::memcpy(&result, ptr, sizeof(double));
+  ptr += sizeof(double);
+  return result;
+}
+
+uint64_t store_encoding::zigzag(int64_t val) {
+  return (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63);
+}
+
+int64_t store_encoding::unzigzag(uint64_t val) {
+  return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1);
+}
+
+void store_encoding::encode_call(stored_call const& call,
+                                 sample_columns& columns) {
+  auto& gt_bytes = columns.at(static_cast<int>(StoreColumn::GT)).bytes;
+  put_varint(gt_bytes, call.genotype.size());
+  // 0 encodes a null call, so that indices stay unsigned
+  for (auto const& gt : call.genotype) put_varint(gt_bytes, gt + 1);
+
+  auto& hapg_bytes = columns.at(static_cast<int>(StoreColumn::HAPG)).bytes;
+  put_varint(hapg_bytes, call.haplogroups.size());
+  for (auto const& hapg : call.haplogroups)
+    put_varint(hapg_bytes, zigzag(hapg));
+
+  // Coverages are sparse: only alleles with non-zero coverage are stored
+  auto& cov_bytes = columns.at(static_cast<int>(StoreColumn::COV)).bytes;
+  std::size_t num_nonzero{0};
+  for (auto const& cov : call.allele_covs) num_nonzero += (cov != 0.);
+  put_varint(cov_bytes, num_nonzero);
+  for (std::size_t i{0}; i < call.allele_covs.size(); i++) {
+    if (call.allele_covs.at(i) == 0.) continue;
+    put_varint(cov_bytes, i);
+    put_double(cov_bytes, call.allele_covs.at(i));
+  }
+
+  put_varint(columns.at(static_cast<int>(StoreColumn::DP)).bytes,
+             call.total_coverage);
+  put_double(columns.at(static_cast<int>(StoreColumn::GT_CONF)).bytes,
+             call.gt_conf);
+}
+
+void store_encoding::decode_column_entry(StoreColumn col, char const*& ptr,
+                                         char const* end, stored_call& call,
+                                         std::size_t num_alleles) {
+  switch (col) {
+    case StoreColumn::GT: {
+      auto const num_gts = get_varint(ptr, end);
+      call.genotype.clear();
+      for (uint64_t i{0}; i < num_gts; i++)
+        call.genotype.push_back(
+            static_cast<GtypedIndex>(get_varint(ptr, end)) - 1);
+      break;
+    }
+    case StoreColumn::HAPG: {
+      auto const num_hapgs = get_varint(ptr, end);
+      call.haplogroups.clear();
+      for (uint64_t i{0}; i < num_hapgs; i++)
+        call.haplogroups.push_back(
+            static_cast<AlleleId>(unzigzag(get_varint(ptr, end))));
+      break;
+    }
+    case StoreColumn::COV: {
+      auto const num_nonzero = get_varint(ptr, end);
+      call.allele_covs.assign(num_alleles, 0.);
+      for (uint64_t i{0}; i < num_nonzero; i++) {
+        auto const idx = get_varint(ptr, end);
+        auto const cov = get_double(ptr, end);
+        if (idx >= num_alleles)
+          throw GenotypeStoreException("Coverage of an unknown allele");
+        call.allele_covs.at(idx) = cov;
+      }
+      break;
+    }
+    case StoreColumn::DP:
+      call.total_coverage = get_varint(ptr, end);
+      break;
+    case StoreColumn::GT_CONF:
+      call.gt_conf = get_double(ptr, end);
+      break;
+  }
+}
+
+namespace {
+void put_string(std::string& out, std::string const& val) {
+  put_varint(out, val.size());
+  out.append(val);
+}
+
+uint64_t read_varint(std::istream& in) {
+  uint64_t result{0};
+  int shift{0};
+  while (true) {
+    auto const byte = in.get();
+    if (byte == std::char_traits<char>::eof() || shift > 63)
+      throw GenotypeStoreException("Truncated genotype store header");
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) break;
+    shift += 7;
+  }
+  return result;
+}
+
+std::string read_string(std::istream& in) {
+  std::string result(read_varint(in), '\0');
+  in.read(result.data(), result.size());
+  if (!in.good())
+    throw GenotypeStoreException("Truncated genotype store header");
+  return result;
+}
+
+/**
+ * Maps site-local allele indices (in `input_covs`) to dictionary indices.
+ * Empty `input_covs`, as null calls without coverage have, give all zeros.
+ */
+allele_coverages rescale_covs(allele_coverages const& input_covs,
+                              std::vector<std::size_t> const& dict_idx,
+                              std::size_t num_dict_alleles,
+                              std::size_t site_index) {
+  allele_coverages result(num_dict_alleles, 0.);
+  if (input_covs.empty()) return result;
+  if (input_covs.size() != dict_idx.size())
+    throw GenotypeStoreException(
+        "Site " + std::to_string(site_index) +
+        " does not have the same number of COV and ALS entries");
+  for (std::size_t i{0}; i < input_covs.size(); i++)
+    result.at(dict_idx.at(i)) = input_covs.at(i);
+  return result;
+}
+}  // namespace
+
+/*
+ * Writer
+ */
+std::vector<std::size_t> GenotypeStore::register_alleles(
+    std::size_t site_index, std::size_t pos, std::string const& segment,
+    strings const& alleles) {
+  if (site_index == sites.size()) {
+    sites.push_back(stored_site{pos, segment, {}});
+    allele_indices.emplace_back();
+  }
+  auto& site = sites.at(site_index);
+  if (site.pos != pos || site.segment != segment)
+    throw GenotypeStoreException("Site " + std::to_string(site_index) +
+                                 " does not have the same POS and SEG");
+  if (!site.alleles.empty() && !alleles.empty() &&
+      site.alleles.at(0) != alleles.at(0))
+    throw GenotypeStoreException("Site " + std::to_string(site_index) +
+                                 " does not have the same reference allele");
+
+  auto& indices = allele_indices.at(site_index);
+  std::vector<std::size_t> result;
+  result.reserve(alleles.size());
+  for (auto const& allele : alleles) {
+    auto found = indices.find(allele);
+    if (found == indices.end()) {
+      found = indices.insert({allele, site.alleles.size()}).first;
+      site.alleles.push_back(allele);
+    }
+    result.push_back(found->second);
+  }
+  return result;
+}
+
+std::vector<std::size_t> GenotypeStore::num_alleles_per_site() const {
+  std::vector<std::size_t> result;
+  result.reserve(sites.size());
+  for (auto const& site : sites) result.push_back(site.alleles.size());
+  return result;
+}
+
+void GenotypeStore::truncate_alleles(
+    std::vector<std::size_t> const& num_alleles) {
+  sites.erase(sites.begin() + num_alleles.size(), sites.end());
+  allele_indices.erase(allele_indices.begin() + num_alleles.size(),
+                       allele_indices.end());
+  for (std::size_t j{0}; j < sites.size(); j++) {
+    auto& alleles = sites.at(j).alleles;
+    for (auto k = num_alleles.at(j); k < alleles.size(); k++)
+      allele_indices.at(j).erase(alleles.at(k));
+    alleles.resize(num_alleles.at(j));
+  }
+}
+
+void GenotypeStore::check_compatible(std::size_t num_input_sites,
+                                     std::string const& input_model) {
+  if (sample_names.empty() && sites.empty()) {
+    model = input_model;
+    return;
+  }
+  if (num_input_sites != sites.size())
+    throw GenotypeStoreException(
+        "Input does not have the same number of sites");
+  if (input_model != model)
+    throw GenotypeStoreException("Input has a different genotyping model");
+}
+
+void GenotypeStore::add_call(sample_columns& sample_cols,
+                             std::size_t site_index, stored_call const& call) {
+  if (site_index % block_size == 0) {
+    for (auto& column : sample_cols)
+      column.block_offsets.push_back(column.bytes.size());
+  }
+  encode_call(call, sample_cols);
+}
+
+void GenotypeStore::add_samples(json::Json_Prg& json_prg) {
+  auto const& prg = json_prg.get_prg();
+  auto const& json_sites = prg.at("Sites");
+  check_compatible(json_sites.size(), prg.at("Model"));
+
+  auto const& samples = prg.at("Samples");
+  strings new_names;
+  for (auto const& sample : samples) new_names.push_back(sample.at("Name"));
+  std::vector<sample_columns> new_columns(samples.size());
+
+  auto const num_alleles = num_alleles_per_site();
+  try {
+    for (std::size_t j{0}; j < json_sites.size(); j++) {
+      auto const& site = json_sites.at(j);
+      strings const alleles = site.at("ALS");
+      auto const dict_idx =
+          register_alleles(j, site.at("POS"), site.at("SEG"), alleles);
+      auto const num_dict_alleles = sites.at(j).alleles.size();
+      bool const has_gt_conf = site.contains("GT_CONF");
+
+      for (std::size_t s{0}; s < samples.size(); s++) {
+        stored_call call;
+        auto const& gts = site.at("GT").at(s);
+        if (gts.at(0).is_null())
+          call.genotype = GtypedIndices{-1};
+        else {
+          for (auto const& gt : gts)
+            call.genotype.push_back(dict_idx.at(gt.get<std::size_t>()));
+        }
+        call.haplogroups = site.at("HAPG").at(s).get<AlleleIds>();
+        call.allele_covs =
+            rescale_covs(site.at("COV").at(s).get<allele_coverages>(),
+                         dict_idx, num_dict_alleles, j);
+        call.total_coverage = site.at("DP").at(s);
+        if (has_gt_conf) call.gt_conf = site.at("GT_CONF").at(s);
+        add_call(new_columns.at(s), j, call);
+      }
+    }
+  } catch (...) {
+    truncate_alleles(num_alleles);
+    throw;
+  }
+  sample_names.insert(sample_names.end(), new_names.begin(), new_names.end());
+  std::move(new_columns.begin(), new_columns.end(),
+            std::back_inserter(columns));
+}
+
+void GenotypeStore::add_sample(std::string const& sample_name,
+                               gt_sites const& gtyped_sites,
+                               SegmentTracker& tracker,
+                               std::string const& gtyping_model) {
+  check_compatible(gtyped_sites.size(), gtyping_model);
+  sample_columns sample_cols;
+
+  auto const num_alleles = num_alleles_per_site();
+  try {
+    for (std::size_t j{0}; j < gtyped_sites.size(); j++) {
+      auto const& site = gtyped_sites.at(j);
+      auto const gtype_info = site->get_all_gtype_info();
+      auto const site_pos = site->get_pos();
+      std::string const segment = tracker.get_ID(site_pos);
+      auto const pos = tracker.get_relative_pos(site_pos) + 1;
+
+      strings alleles;
+      for (auto const& allele : gtype_info.alleles)
+        alleles.push_back(allele.sequence);
+      auto const dict_idx = register_alleles(j, pos, segment, alleles);
+
+      stored_call call;
+      if (site->is_null())
+        call.genotype = GtypedIndices{-1};
+      else {
+        for (auto const& gt : gtype_info.genotype)
+          call.genotype.push_back(dict_idx.at(gt));
+      }
+      call.haplogroups = gtype_info.haplogroups;
+      call.allele_covs = rescale_covs(gtype_info.allele_covs, dict_idx,
+                                      sites.at(j).alleles.size(), j);
+      call.total_coverage = gtype_info.total_coverage;
+      for (auto const& entry : site->get_model_specific_entries().doubles) {
+        if (entry.ID == "GT_CONF" && !entry.vals.empty())
+          call.gt_conf = entry.vals.at(0);
+      }
+      add_call(sample_cols, j, call);
+    }
+  } catch (...) {
+    truncate_alleles(num_alleles);
+    throw;
+  }
+  sample_names.push_back(sample_name);
+  columns.push_back(std::move(sample_cols));
+}
+
+void GenotypeStore::add_samples(GenotypeStoreReader& reader) {
+  check_compatible(reader.num_sites(), reader.get_model());
+
+  std::vector<sample_columns> new_columns(reader.num_samples());
+  auto const num_alleles = num_alleles_per_site();
+  try {
+    // Allele dictionaries are append-only, so mapping the reader's alleles is
+    // done once per site and stored samples are left untouched
+    std::vector<std::vector<std::size_t>> dict_indices(reader.num_sites());
+    for (std::size_t j{0}; j < reader.num_sites(); j++) {
+      auto const& site = reader.get_site(j);
+      dict_indices.at(j) =
+          register_alleles(j, site.pos, site.segment, site.alleles);
+    }
+
+    for (std::size_t s{0}; s < reader.num_samples(); s++) {
+      auto calls = reader.get_sample_calls(s);
+      auto& sample_cols = new_columns.at(s);
+      for (std::size_t j{0}; j < calls.size(); j++) {
+        auto& call = calls.at(j);
+        auto const& dict_idx = dict_indices.at(j);
+        if (!call.is_null()) {
+          for (auto& gt : call.genotype) gt = dict_idx.at(gt);
+        }
+        call.allele_covs = rescale_covs(call.allele_covs, dict_idx,
+                                        sites.at(j).alleles.size(), j);
+        add_call(sample_cols, j, call);
+      }
+    }
+  } catch (...) {
+    truncate_alleles(num_alleles);
+    throw;
+  }
+  auto const& new_names = reader.get_sample_names();
+  sample_names.insert(sample_names.end(), new_names.begin(), new_names.end());
+  std::move(new_columns.begin(), new_columns.end(),
+            std::back_inserter(columns));
+}
+
+void GenotypeStore::write(std::string const& fpath) const {
+  std::ofstream fhandle(fpath, std::ios::binary);
+  if (!fhandle.good())
+    throw GenotypeStoreException("Could not open " + fpath + " for writing");
+  write(fhandle);
+}
+
+void GenotypeStore::write(std::ostream& out) const {
+  std::string header(store_magic, store_magic_size);
+  put_varint(header, block_size);
+  put_varint(header, sites.size());
+  put_varint(header, sample_names.size());
+  put_string(header, model);
+  for (auto const& name : sample_names) put_string(header, name);
+
+  for (auto const& site : sites) {
+    put_varint(header, site.pos);
+    put_string(header, site.segment);
+    put_varint(header, site.alleles.size());
+    for (auto const& allele : site.alleles) put_string(header, allele);
+  }
+
+  // Column directory; column data follows in the same order
+  uint64_t data_offset{0};
+  for (auto const& sample_cols : columns) {
+    for (auto const& column : sample_cols) {
+      put_varint(header, column.block_offsets.size());
+      for (auto const& offset : column.block_offsets)
+        put_varint(header, offset);
+      put_varint(header, data_offset);
+      put_varint(header, column.bytes.size());
+      data_offset += column.bytes.size();
+    }
+  }
+
+  out.write(header.data(), header.size());
+  for (auto const& sample_cols : columns) {
+    for (auto const& column : sample_cols)
+      out.write(column.bytes.data(), column.bytes.size());
+  }
+}
+
+/*
+ * Reader
+ */
+GenotypeStoreReader::GenotypeStoreReader(std::string const& fpath)
+    : fhandle(fpath, std::ios::binary) {
+  if (!fhandle.good())
+    throw GenotypeStoreException("Could not open " + fpath);
+  read_header();
+}
+
+void GenotypeStoreReader::read_header() {
+  std::string magic(store_magic_size, '\0');
+  fhandle.read(magic.data(), store_magic_size);
+  if (!fhandle.good() || magic != std::string(store_magic, store_magic_size))
+    throw GenotypeStoreException("Not a gramtools genotype store");
+
+  block_size = read_varint(fhandle);
+  if (block_size == 0) throw GenotypeStoreException("Invalid block size");
+  auto const num_sites = read_varint(fhandle);
+  auto const num_samples = read_varint(fhandle);
+  model = read_string(fhandle);
+  for (uint64_t s{0}; s < num_samples; s++)
+    sample_names.push_back(read_string(fhandle));
+
+  sites.resize(num_sites);
+  for (auto& site : sites) {
+    site.pos = read_varint(fhandle);
+    site.segment = read_string(fhandle);
+    site.alleles.resize(read_varint(fhandle));
+    for (auto& allele : site.alleles) allele = read_string(fhandle);
+  }
+
+  directory.resize(num_samples);
+  for (auto& sample_entries : directory) {
+    for (auto& entry : sample_entries) {
+      entry.block_offsets.resize(read_varint(fhandle));
+      for (auto& offset : entry.block_offsets) offset = read_varint(fhandle);
+      entry.data_offset = read_varint(fhandle);
+      entry.length = read_varint(fhandle);
+    }
+  }
+  data_start = fhandle.tellg();
+}
+
+std::string GenotypeStoreReader::read_column_bytes(column_entry const& entry,
+                                                   uint64_t start,
+                                                   uint64_t end) {
+  std::string result(end - start, '\0');
+  fhandle.clear();
+  fhandle.seekg(data_start +
+                static_cast<std::streamoff>(entry.data_offset + start));
+  fhandle.read(result.data(), result.size());
+  if (!fhandle.good())
+    throw GenotypeStoreException("Truncated genotype store column");
+  return result;
+}
+
+void GenotypeStoreReader::decode_column(StoreColumn col,
+                                        column_entry const& entry,
+                                        std::size_t first_site,
+                                        std::size_t last_site,
+                                        stored_calls& calls) {
+  auto const first_block = first_site / block_size;
+  auto const end_block = last_site / block_size + 1;
+  if (end_block > entry.block_offsets.size())
+    throw GenotypeStoreException("Site index beyond stored column");
+  auto const start = entry.block_offsets.at(first_block);
+  auto const end = end_block < entry.block_offsets.size()
+                       ? entry.block_offsets.at(end_block)
+                       : entry.length;
+
+  auto const bytes = read_column_bytes(entry, start, end);
+  char const* ptr = bytes.data();
+  char const* const bytes_end = bytes.data() + bytes.size();
+
+  stored_call skipped;
+  for (auto site{first_block * block_size}; site < first_site; site++)
+    decode_column_entry(col, ptr, bytes_end, skipped,
+                        sites.at(site).alleles.size());
+  for (auto site{first_site}; site <= last_site; site++)
+    decode_column_entry(col, ptr, bytes_end, calls.at(site - first_site),
+                        sites.at(site).alleles.size());
+}
+
+stored_call GenotypeStoreReader::get_call(std::size_t site_index,
+                                          std::size_t sample_index) {
+  if (site_index >= sites.size() || sample_index >= sample_names.size())
+    throw GenotypeStoreException("Site or sample index out of range");
+  stored_calls result(1);
+  auto const& sample_entries = directory.at(sample_index);
+  for (std::size_t c{0}; c < num_store_columns; c++)
+    decode_column(static_cast<StoreColumn>(c), sample_entries.at(c),
+                  site_index, site_index, result);
+  return result.at(0);
+}
+
+stored_calls GenotypeStoreReader::get_site_calls(std::size_t site_index) {
+  stored_calls result;
+  result.reserve(sample_names.size());
+  for (std::size_t s{0}; s < sample_names.size(); s++)
+    result.push_back(get_call(site_index, s));
+  return result;
+}
+
+stored_calls GenotypeStoreReader::get_sample_calls(std::size_t sample_index) {
+  if (sample_index >= sample_names.size())
+    throw GenotypeStoreException("Sample index out of range");
+  stored_calls result(sites.size());
+  if (sites.empty()) return result;
+  auto const& sample_entries = directory.at(sample_index);
+  for (std::size_t c{0}; c < num_store_columns; c++)
+    decode_column(static_cast<StoreColumn>(c), sample_entries.at(c), 0,
+                  sites.size() - 1, result);
+  return result;
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <exception>
+
 #include "genotype/infer/output_specs/json_prg_spec.hpp"
 #include "genotype/infer/output_specs/json_site_spec.hpp"
 
@@ -70,21 +73,27 @@ void Json_Prg::add_samples(Json_Prg& other, const bool force) {
   }
 }
 
-void Json_Prg::combine_with(Json_Prg& other, bool force) {
-  auto other_prg = other.get_prg();
-  if (json_prg.at("Model") != other_prg.at("Model"))
+void gram::json::check_combinable(JSON const& first, JSON const& second) {
+  if (first.at("Model") != second.at("Model"))
     throw JSONCombineException("JSONs have different models");
 
-  auto bad_prg = json_prg.at("Lvl1_Sites") != other_prg.at("Lvl1_Sites");
-  bad_prg |= json_prg.at("Child_Map") != other_prg.at("Child_Map");
+  auto bad_prg = first.at("Lvl1_Sites") != second.at("Lvl1_Sites");
+  bad_prg |= first.at("Child_Map") != second.at("Child_Map");
 
   if (bad_prg)
     throw JSONCombineException(
         "Incompatible PRGs (Check Child_Map and Lvl1_Sites)");
 
-  if (json_prg.at("Site_Fields") != other_prg.at("Site_Fields"))
+  if (first.at("Site_Fields") != second.at("Site_Fields"))
     throw JSONCombineException("Incompatible Site Fields");
 
+  if (first.at("Sites").size() != second.at("Sites").size())
+    throw JSONCombineException("JSONs do not have the same number of sites");
+}
+
+void Json_Prg::combine_with(Json_Prg& other, bool force) {
+  auto other_prg = other.get_prg();
+  check_combinable(json_prg, other_prg);
   if (sites.size() != other.sites.size())
     throw JSONCombineException("JSONs do not have the same number of sites");
 
@@ -96,3 +105,113 @@ void Json_Prg::combine_with(Json_Prg& other, bool force) {
     json_prg.at("Sites").at(j) = sites.at(j)->get_site();
   }
 }
+
+Json_Prg_Merger::Json_Prg_Merger(std::vector<JSON> input_jsons, bool force)
+    : inputs(std::move(input_jsons)) {
+  if (inputs.empty()) throw JSONConsistencyException("No JSONs to merge");
+  for (std::size_t i{1}; i < inputs.size(); i++)
+    check_combinable(inputs.at(0), inputs.at(i));
+
+  num_sites = inputs.at(0).at("Sites").size();
+  for (auto const& item : inputs.at(0).items()) {
+    if (item.key() != "Sites") header[item.key()] = item.value();
+  }
+  combine_samples(force);
+}
+
+void Json_Prg_Merger::combine_samples(bool force) {
+  auto& samples = header.at("Samples");
+  samples = JSON::array();
+  std::map<std::string, std::size_t> duplicates;
+
+  for (auto& input : inputs) {
+    auto& input_samples = input.at("Samples");
+    if (num_sites > 0 &&
+        input.at("Sites").at(0).at("GT").size() != input_samples.size())
+      throw JSONConsistencyException(
+          "Merged in JSON does not have number of GT arrays"
+          " consistent with its number of Samples");
+
+    for (auto const& sample_entry : input_samples) {
+      std::string const name = sample_entry.at("Name");
+      std::string used_name = name;
+      auto found = duplicates.find(name);
+      if (found != duplicates.end()) {
+        if (!force)
+          throw JSONConsistencyException(
+              std::string{"Duplicate sample name found: " + name});
+        used_name = name + std::string("_") + std::to_string(found->second);
+        found->second++;
+      } else
+        duplicates.insert({name, 1});
+
+      samples.push_back(sample_entry);
+      samples.back().at("Name") = used_name;
+    }
+  }
+}
+
+Json_Site Json_Prg_Merger::merge_site(std::size_t site_index) {
+  std::vector<Json_Site> to_combine;
+  to_combine.reserve(inputs.size());
+  for (auto& input : inputs) {
+    auto& site_json = input.at("Sites").at(site_index);
+    to_combine.emplace_back(std::move(site_json));
+    site_json = JSON();
+  }
+  std::string const gtyping_model = header.at("Model");
+  return Json_Site::combine_all(to_combine, gtyping_model);
+}
+
+void Json_Prg_Merger::write(std::ostream& out, std::size_t chunk_size) {
+  if (chunk_size == 0) chunk_size = 1;
+  // Keys come out sorted, as when dumping a whole nlohmann::json object
+  JSON keys = header;
+  keys["Sites"] = JSON::array();
+
+  out << "{";
+  bool first_key{true};
+  for (auto const& item : keys.items()) {
+    if (!first_key) out << ",";
+    first_key = false;
+    out << JSON(item.key()).dump() << ":";
+    if (item.key() != "Sites") {
+      out << item.value().dump();
+      continue;
+    }
+
+    out << "[";
+    std::vector<std::string> dumped_sites;
+    for (std::size_t start{0}; start < num_sites; start += chunk_size) {
+      auto const end = std::min(start + chunk_size, num_sites);
+      dumped_sites.assign(end - start, "");
+      std::exception_ptr failure{nullptr};
+
+#pragma omp parallel for schedule(dynamic)
+      for (std::size_t i = start; i < end; i++) {
+        try {
+          dumped_sites.at(i - start) = merge_site(i).get_site().dump();
+        } catch (...) {
+#pragma omp critical(merge_failure)
+          failure = std::current_exception();
+        }
+      }
+      if (failure != nullptr) std::rethrow_exception(failure);
+
+      for (std::size_t i{start}; i < end; i++) {
+        if (i > 0) out << ",";
+        out << dumped_sites.at(i - start);
+      }
+    }
+    out << "]";
+  }
+  out << "}";
+}
+
+JSON Json_Prg_Merger::merge() {
+  JSON result = header;
+  result["Sites"] = JSON::array();
+  for (std::size_t i{0}; i < num_sites; i++)
+    result.at("Sites").push_back(merge_site(i).get_site());
+  return result;
+}
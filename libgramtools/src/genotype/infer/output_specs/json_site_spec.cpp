@@ -138,3 +138,42 @@ void Json_Site::combine_with(Json_Site& other,
 
   add_model_specific_entries_from(other.get_site(), gtyping_model);
 }
+
+Json_Site Json_Site::combine_all(std::vector<Json_Site>& sites,
+                                 std::string const& gtyping_model) {
+  if (sites.empty())
+    throw JSONConsistencyException("No sites to combine");
+
+  auto const& first_json = sites.at(0).get_site();
+  for (std::size_t i{1}; i < sites.size(); i++) {
+    auto const& other_json = sites.at(i).get_site();
+    for (auto const& entry : singleton_entries) {
+      if (first_json.at(entry) != other_json.at(entry)) {
+        std::string msg("Sites do not have same " + entry + ": ");
+        throw JSONCombineException(msg);
+      }
+    }
+    if (first_json.at("ALS").at(0) != other_json.at("ALS").at(0)) {
+      std::string msg("Sites do not have same 'reference' allele: ");
+      msg = msg + std::string(first_json.at("ALS").at(0)) + " vs " +
+            std::string(other_json.at("ALS").at(0));
+      throw JSONCombineException(msg);
+    }
+  }
+
+  std::string const ref = first_json.at("ALS").at(0);
+  allele_combi_map m{{ref, site_rescaler{0, 0}}};  // Always place the REF
+  for (auto& site : sites) site.build_allele_combi_map(site.get_site(), m);
+
+  Json_Site result{std::move(sites.at(0))};
+  result.rescale_entries(m);
+  result.get_site().at("ALS") = result.get_all_alleles(m);
+  for (std::size_t i{1}; i < sites.size(); i++) {
+    auto& other = sites.at(i);
+    other.rescale_entries(m);
+    result.append_trivial_entries_from(other.get_site());
+    result.add_model_specific_entries_from(other.get_site(), gtyping_model);
+    other.get_site() = JSON();  // Release memory as we go
+  }
+  return result;
+}
@@ -1,6 +1,11 @@
-#include "genotype/infer/personalised_reference.hpp"
-#include <genotype/infer/output_specs/segment_tracker.hpp>
+#include <omp.h>
+
+#include <algorithm>
+
+#include "common/utils.hpp"
 #include "genotype/infer/interfaces.hpp"
+#include "genotype/infer/output_specs/segment_tracker.hpp"
+#include "genotype/infer/personalised_reference.hpp"
 #include "prg/coverage_graph.hpp"
 
 namespace gram::genotype {
@@ -35,76 +40,53 @@ std::size_t get_ploidy(gt_sites const& gtyped_recs) {
   return ploidy;
 }
 
-// Helper function for get_personalised_ref()
-void add_segment_IDs(Fastas& p_refs, std::size_t const offset,
-                     std::size_t const ploidy, std::string const& ID) {
-  if (ploidy == 1)
-    p_refs.at(offset).set_ID(ID);
-  else {
-    for (int i{0}; i < ploidy; i++) {
-      std::string qualified_ID(ID + "_" + std::to_string(i + 1));
-      p_refs.at(i + offset).set_ID(qualified_ID);
-    }
-  }
-}
-
-// Helper function for get_personalised_ref()
-std::size_t switch_segment(Fastas& p_refs, std::size_t& offset,
-                           std::size_t const& ploidy, SegmentTracker& tracker) {
+/**
+ * Helper for planning the personalised reference: moves on to the next
+ * segment, if there is one.
+ */
+std::size_t switch_segment(ref_plan& plan, std::size_t& seg_idx,
+                           SegmentTracker& tracker) {
   if (tracker.edge() != tracker.global_edge()) {
     auto new_ID = tracker.get_ID(tracker.edge() + 1);
-    offset += ploidy;
-    add_segment_IDs(p_refs, offset, ploidy, new_ID);
+    seg_idx++;
+    plan.at(seg_idx).ID = new_ID;
   }
   return tracker.edge();
 }
 
-// Helper function for get_personalised_ref()
-void add_invariant_sequence(Fastas& p_refs, std::size_t const offset,
-                            std::size_t const ploidy, std::string const seq) {
-  for (int i{0}; i < ploidy; i++) p_refs.at(i + offset).add_sequence(seq);
-}
-
-Fastas get_personalised_ref(covG_ptr graph_root,
-                            gt_sites const& genotyped_records,
-                            SegmentTracker& tracker) {
-  auto ploidy = get_ploidy(genotyped_records);
-  auto num_segments = tracker.num_segments();
-  Fastas p_refs(num_segments * ploidy);
+ref_plan plan_personalised_ref(covG_ptr graph_root,
+                               gt_sites const& genotyped_records,
+                               SegmentTracker& tracker) {
+  ref_plan plan(tracker.num_segments());
   gram::covG_ptr cur_Node{graph_root};
 
-  std::size_t offset{0};
+  std::size_t seg_idx{0};
   auto cur_edge = tracker.edge();
-  add_segment_IDs(p_refs, offset, ploidy, tracker.get_ID(cur_edge));
+  plan.at(seg_idx).ID = tracker.get_ID(cur_edge);
 
   while (cur_Node->get_edges().size() > 0) {
     if (cur_Node->is_bubble_start()) {
       auto site_index = siteID_to_index(cur_Node->get_site_ID());
-      auto site = genotyped_records.at(site_index);
-      auto to_paste_alleles = get_all_alleles_to_paste(site, ploidy);
-      for (int i{0}; i < ploidy; i++)
-        p_refs.at(i + offset).add_sequence(to_paste_alleles.at(i).sequence);
+      plan.at(seg_idx).pieces.push_back(ref_piece{nullptr, 0, 0, site_index});
 
-      cur_Node = site->get_site_end_node();
+      cur_Node = genotyped_records.at(site_index)->get_site_end_node();
       if (cur_edge == cur_Node->get_pos() - 1)
-        cur_edge = switch_segment(p_refs, offset, ploidy, tracker);
+        cur_edge = switch_segment(plan, seg_idx, tracker);
     }
 
     if (cur_Node->has_sequence()) {
       std::size_t cur_pos = cur_Node->get_pos();
       std::size_t end_pos = cur_pos + cur_Node->get_sequence_size() - 1;
-      auto sequence = cur_Node->get_sequence();
       while (cur_pos <= end_pos) {
+        auto const start = cur_pos - cur_Node->get_pos();
         if (cur_edge <= end_pos) {
-          add_invariant_sequence(p_refs, offset, ploidy,
-                                 sequence.substr(cur_pos - cur_Node->get_pos(),
-                                                 cur_edge - cur_pos + 1));
+          plan.at(seg_idx).pieces.push_back(
+              ref_piece{cur_Node, start, cur_edge - cur_pos + 1, 0});
           cur_pos = cur_edge + 1;
-          cur_edge = switch_segment(p_refs, offset, ploidy, tracker);
+          cur_edge = switch_segment(plan, seg_idx, tracker);
         } else {
-          add_invariant_sequence(
-              p_refs, offset, ploidy,
-              sequence.substr(cur_pos - cur_Node->get_pos()));
+          plan.at(seg_idx).pieces.push_back(
+              ref_piece{cur_Node, start, end_pos - cur_pos + 1, 0});
           cur_pos = end_pos + 1;
         }
       }
@@ -114,9 +96,123 @@ Fastas get_personalised_ref(covG_ptr graph_root,
     cur_Node = cur_Node->get_edges().at(0);
   }
 
+  return plan;
+}
+
+Fastas build_segment(ref_segment const& segment,
+                     gt_sites const& genotyped_records,
+                     std::size_t const ploidy) {
+  Fastas result(ploidy);
+  if (ploidy == 1)
+    result.at(0).set_ID(segment.ID);
+  else {
+    for (int i{0}; i < ploidy; i++)
+      result.at(i).set_ID(segment.ID + "_" + std::to_string(i + 1));
+  }
+
+  // Sequences are built in a single allocation each
+  std::vector<allele_vector> to_paste;
+  std::vector<std::size_t> lengths(ploidy, 0);
+  for (auto const& piece : segment.pieces) {
+    if (piece.node != nullptr) {
+      for (auto& length : lengths) length += piece.length;
+      continue;
+    }
+    to_paste.push_back(get_all_alleles_to_paste(
+        genotyped_records.at(piece.site_index), ploidy));
+    for (int i{0}; i < ploidy; i++)
+      lengths.at(i) += to_paste.back().at(i).sequence.size();
+  }
+  for (int i{0}; i < ploidy; i++) result.at(i).reserve(lengths.at(i));
+
+  std::size_t site_num{0};
+  for (auto const& piece : segment.pieces) {
+    if (piece.node != nullptr) {
+      auto const& sequence = piece.node->get_sequence();
+      for (auto& fasta : result)
+        fasta.add_sequence(sequence, piece.start, piece.length);
+    } else {
+      auto const& alleles = to_paste.at(site_num++);
+      for (int i{0}; i < ploidy; i++)
+        result.at(i).add_sequence(alleles.at(i).sequence);
+    }
+  }
+  return result;
+}
+
+Fastas get_personalised_ref(covG_ptr graph_root,
+                            gt_sites const& genotyped_records,
+                            SegmentTracker& tracker) {
+  auto ploidy = get_ploidy(genotyped_records);
+  auto plan = plan_personalised_ref(graph_root, genotyped_records, tracker);
+
+  Fastas p_refs;
+  p_refs.reserve(plan.size() * ploidy);
+  for (auto const& segment : plan) {
+    auto seg_refs = build_segment(segment, genotyped_records, ploidy);
+    std::move(seg_refs.begin(), seg_refs.end(), std::back_inserter(p_refs));
+  }
   return p_refs;
 }
 
+std::size_t write_personalised_ref(std::ostream& out, covG_ptr graph_root,
+                                   gt_sites const& genotyped_records,
+                                   SegmentTracker& tracker,
+                                   std::string const& desc) {
+  auto ploidy = get_ploidy(genotyped_records);
+  auto const plan =
+      plan_personalised_ref(graph_root, genotyped_records, tracker);
+
+  // Sequences already written by (hash, length), as (segment, haplotype)
+  using Written = std::pair<std::size_t, std::size_t>;
+  PairHashMap<std::pair<std::size_t, std::size_t>, std::vector<Written>>
+      written;
+  std::size_t num_written{0};
+
+  std::size_t const batch_size = std::max(1, omp_get_max_threads());
+  std::vector<Fastas> batch;
+  for (std::size_t first{0}; first < plan.size(); first += batch_size) {
+    auto const last = std::min(first + batch_size, plan.size());
+    batch.assign(last - first, Fastas{});
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::size_t i = first; i < last; i++)
+      batch.at(i - first) =
+          build_segment(plan.at(i), genotyped_records, ploidy);
+
+    // Segments of earlier batches are rebuilt: only on a hash collision, or
+    // on a repeat of a sequence across segments
+    auto const same_sequence = [&](Written const& copy,
+                                   std::string const& seq) {
+      if (copy.first >= first)
+        return batch.at(copy.first - first).at(copy.second).get_sequence() ==
+               seq;
+      return build_segment(plan.at(copy.first), genotyped_records, ploidy)
+                 .at(copy.second)
+                 .get_sequence() == seq;
+    };
+
+    // Written in segment order; first copy of a sequence is kept
+    for (std::size_t i = first; i < last; i++) {
+      auto& seg_refs = batch.at(i - first);
+      for (std::size_t haplotype{0}; haplotype < seg_refs.size(); haplotype++) {
+        auto& p_ref = seg_refs.at(haplotype);
+        auto const& seq = p_ref.get_sequence();
+        auto& copies = written[{std::hash<std::string>{}(seq), seq.size()}];
+        auto const is_copy = [&](Written const& copy) {
+          return same_sequence(copy, seq);
+        };
+        if (std::any_of(copies.begin(), copies.end(), is_copy)) continue;
+        copies.emplace_back(i, haplotype);
+        p_ref.set_desc(desc);
+        out << p_ref << std::endl;
+        num_written++;
+      }
+    }
+  }
+  return num_written;
+}
+
 bool operator<(const Fasta& first, const Fasta& second) {
   return first.sequence < second.sequence;
 }
@@ -3,6 +3,7 @@
 #include <omp.h>
 
 #include <iostream>
+#include <random>
 
 using namespace gram;
 using namespace gram::commands::genotype;
@@ -68,7 +69,32 @@ GenotypeParams commands::genotype::parse_parameters(
                           "maximum number of threads used")(
       "seed", po::value<uint32_t>()->default_value(0),
       "seed for pseudo-random selection of multi-mapping reads. "
-      "the default of 0 produces a random seed.");
+      "the default of 0 produces a random seed.")(
+      "profile", po::bool_switch(&parameters.profile)->default_value(false),
+      "also record timers of the mapping hot path, hardware counters and the "
+      "peak RSS of each stage in the profile. the kernel's peak RSS of the "
+      "run is then no longer that of the whole run")(
+      "mmap", po::bool_switch()->default_value(false),
+      "map the reduced BWT and BWT markers mask of gram_dir read-only, rather "
+      "than copy them into memory: concurrent runs then share them. the FM "
+      "index and kmer index are still loaded into memory")(
+      "numa", po::bool_switch(&parameters.numa)->default_value(false),
+      "interleave the loaded prg and kmer index over NUMA nodes, and pin "
+      "mapping threads to nodes")(
+      "huge_pages",
+      po::bool_switch(&parameters.huge_pages)->default_value(false),
+      "back the loaded prg with transparent huge pages, and read it in "
+      "upfront")(
+      "read_cache_mb",
+      po::value<uint64_t>(&parameters.read_cache_mb)->default_value(0),
+      "memory, in MB, for caching the mappings of reads so that identical "
+      "reads are searched once. off by default: it pays off on libraries "
+      "with many duplicate reads")(
+      "suffix_cache_mb",
+      po::value<uint64_t>(&parameters.suffix_cache_mb)->default_value(0),
+      "memory, in MB, for caching the search of read 3' suffixes longer than "
+      "the kmer, so that reads sharing them resume from there. off by "
+      "default");
 
   std::vector<std::string> opts =
       po::collect_unrecognized(parsed.options, po::include_positional);
@@ -85,6 +111,7 @@ GenotypeParams commands::genotype::parse_parameters(
   }
 
   fill_common_parameters(parameters, parameters.gram_dirpath);
+  parameters.map_artefacts = vm["mmap"].as<bool>();
   for (auto& elem : reads_fpaths) elem = fs::absolute(fs::path(elem)).string();
   parameters.reads_fpaths = reads_fpaths;
 
@@ -93,8 +120,11 @@ GenotypeParams commands::genotype::parse_parameters(
   std::string cov_dirpath = mkdir(run_dirpath, "coverage");
   std::string geno_dirpath = mkdir(run_dirpath, "genotype");
   parameters.read_stats_fpath = full_path(run_dirpath, "read_stats.json");
+  parameters.quasimap_progress_fpath =
+      full_path(run_dirpath, "quasimap_progress.json");
   parameters.debug_fpath =
       full_path(run_dirpath, "site_gtyping_debug_info.txt");
+  parameters.profile_fpath = full_path(run_dirpath, "profile.json");
 
   parameters.allele_sum_coverage_fpath =
       full_path(cov_dirpath, "allele_sum_coverage");
@@ -105,10 +135,14 @@ GenotypeParams commands::genotype::parse_parameters(
 
   parameters.genotyped_json_fpath = full_path(geno_dirpath, "genotyped.json");
   parameters.genotyped_vcf_fpath = full_path(geno_dirpath, "genotyped.vcf.gz");
+  parameters.genotyped_store_fpath = full_path(geno_dirpath, "genotyped.gts");
   parameters.personalised_ref_fpath =
       full_path(geno_dirpath, "personalised_reference.fasta");
 
   parameters.seed = vm["seed"].as<uint32_t>();
+  // Drawn once: read selections are then keyed on it, as with a given seed
+  while (parameters.seed == 0) parameters.seed = std::random_device()();
+  std::cout << "random selection seed: " << parameters.seed << std::endl;
 
   parameters.maximum_threads = vm["max_threads"].as<uint32_t>();
   std::cout << "maximum thread count: " << parameters.maximum_threads
@@ -38,7 +38,7 @@ SitesAlleleBaseCoverage gram::coverage::generate::allele_base_non_nested(
 }
 
 void coverage::record::allele_base(PRG_Info const &prg_info,
-                                   const SearchStates &search_states,
+                                   SearchStateViews const &search_states,
                                    const uint64_t &read_length) {
   PbCovRecorder record_it{prg_info, search_states, read_length};
 }
@@ -134,10 +134,11 @@ void DummyCovNode::extend_coordinates(node_coordinates coords) {
   if (end_pos - start_pos == node_size - 1) full = true;
 }
 
-Traverser::Traverser(node_access start_point, VariantSitePath traversed_loci,
+Traverser::Traverser(node_access start_point,
+                     VariantSitePath const &traversed_loci,
                      std::size_t read_size)
     : cur_Node(start_point.node),
-      traversed_loci(traversed_loci),
+      traversed_loci(&traversed_loci),
       bases_remaining(read_size),
       first_node(true),
       end_pos(0) {
@@ -204,7 +205,7 @@ void Traverser::assign_end_position() {
 }
 
 void Traverser::choose_allele() {
-  auto traversed_locus = traversed_loci[traversed_index];
+  auto const &traversed_locus = (*traversed_loci)[traversed_index];
   auto site_id{traversed_locus.first};
   auto allele_id{traversed_locus.second};
   auto next_node = cur_Node->get_edges()[allele_id];
@@ -227,6 +228,15 @@ PbCovRecorder::PbCovRecorder(const PRG_Info &prg_info,
   write_coverage_from_dummy_nodes();
 }
 
+PbCovRecorder::PbCovRecorder(const PRG_Info &prg_info,
+                             SearchStateViews const &search_states,
+                             std::size_t read_size)
+    : prg_info(&prg_info), read_size(read_size) {
+  for (auto const &search_state : search_states)
+    process_SearchState(*search_state);
+  write_coverage_from_dummy_nodes();
+}
+
 void PbCovRecorder::write_coverage_from_dummy_nodes() {
   covG_ptr cov_node;
   node_coordinates to_increment;
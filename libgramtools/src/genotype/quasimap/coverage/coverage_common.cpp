@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <memory>
+
 #include "genotype/quasimap/coverage/allele_base.hpp"
 #include "genotype/quasimap/coverage/allele_sum.hpp"
 #include "genotype/quasimap/coverage/grouped_allele_counts.hpp"
@@ -7,28 +10,40 @@
 
 using namespace gram;
 
-LocusFinder::LocusFinder(SearchState const search_state, info_ptr prg_info)
-    : search_state(search_state), prg_info(prg_info) {
+LocusFinder::LocusFinder(SearchState const &search_state, info_ptr prg_info)
+    : search_state(&search_state), prg_info(prg_info) {
+  find_loci(search_state);
+}
+
+void LocusFinder::find_loci(SearchState const &search_state) {
+  this->search_state = &search_state;
+  base_sites.clear();
+  used_sites.clear();
+  unique_loci.clear();
   check_site_uniqueness();
   assign_traversing_loci();
   assign_traversed_loci();
 }
 
 void LocusFinder::check_site_uniqueness(SearchState const &search_state) {
-  auto all_loci = search_state.traversed_path;
-  all_loci.insert(all_loci.end(), search_state.traversing_path.begin(),
-                  search_state.traversing_path.end());
-  SitePath unique_sites;
-  for (auto const &entry : all_loci) {
-    Marker site = entry.first;
-    if (unique_sites.find(site) != unique_sites.end()) {
-      throw std::logic_error(
-          "ERROR: A site cannot have been traversed more than once by a read, "
-          "but this one is marked as such.\n");
+  auto const &traversed = search_state.traversed_path;
+  auto const &traversing = search_state.traversing_path;
+  auto site_at = [&](std::size_t index) {
+    return index < traversed.size()
+               ? traversed[index].first
+               : traversing[index - traversed.size()].first;
+  };
+  // Reads cross few sites: comparing all pairs beats building a set
+  auto const num_loci = traversed.size() + traversing.size();
+  for (std::size_t i = 1; i < num_loci; ++i) {
+    for (std::size_t j = 0; j < i; ++j) {
+      if (site_at(i) == site_at(j)) {
+        throw std::logic_error(
+            "ERROR: A site cannot have been traversed more than once by a "
+            "read, but this one is marked as such.\n");
+      }
     }
-    unique_sites.insert(site);
   }
-  return;
 }
 
 void LocusFinder::assign_nested_locus(VariantLocus const &var_loc,
@@ -37,15 +52,15 @@ void LocusFinder::assign_nested_locus(VariantLocus const &var_loc,
   VariantLocus cur_locus = var_loc;
   Marker &cur_marker = cur_locus.first;
   while (true) {
-    if (used_sites.find(cur_marker) != used_sites.end()) break;
-    used_sites.insert(cur_marker);
+    if (!used_sites.insert(cur_marker)) break;
     unique_loci.insert(cur_locus);
 
-    if (par_map.find(cur_marker) == par_map.end()) {
+    auto parent = par_map.find(cur_marker);
+    if (parent == par_map.end()) {
       base_sites.insert(cur_marker);  // Add non-nested site marker
       break;
     }
-    cur_locus = par_map.at(cur_marker);
+    cur_locus = parent->second;
   }
   return;
 }
@@ -58,16 +73,14 @@ void LocusFinder::assign_traversing_loci(SearchState const &search_state,
   assert(r->second == ALLELE_UNKNOWN);
 
   VariantLocus new_locus;
-  // Assign the currently traversed alleles
-  for (int i = search_state.sa_interval.first;
-       i <= search_state.sa_interval.second; ++i) {
-    auto prg_pos = prg_info->fm_index[i];
-    auto &node_access = prg_info->coverage_graph.random_access[prg_pos];
-    auto allele_id = node_access.node->get_allele_ID();
-
-    new_locus = VariantLocus{parent_seed, allele_id};
-    unique_loci.insert(new_locus);
-  }
+  // Assign the currently traversed alleles: SA indices come in runs of the
+  // same allele, registered once each
+  prg_info->sa_locus_runs.for_each_run(
+      search_state.sa_interval,
+      [&](SA_Interval const &, VariantLocus const &locus) {
+        new_locus = VariantLocus{parent_seed, locus.second};
+        unique_loci.insert(new_locus);
+      });
 
   assign_nested_locus(new_locus, prg_info);
 
@@ -82,21 +95,51 @@ void LocusFinder::assign_traversed_loci(SearchState const &search_state,
   }
 }
 
+traversal_info const *gram::find_site_path(uniqueSitePaths const &usps,
+                                           level0_Sites const &sites) {
+  auto const entry = std::lower_bound(
+      usps.begin(), usps.end(), sites,
+      [](auto const &entry, level0_Sites const &sites) {
+        return entry.first < sites;
+      });
+  if (entry == usps.end() || entry->first != sites) return nullptr;
+  return &entry->second;
+}
+
 MappingInstanceSelector::MappingInstanceSelector(
-    SearchStates const search_states, info_ptr prg_info,
+    SearchStates const &search_states, info_ptr prg_info,
     rand_ptr rand_generator)
-    : input_search_states(search_states),
-      usps(),
+    : usps(),
+      locus_finder(prg_info),
       prg_info(prg_info),
       rand_generator(rand_generator) {
-  process_searchstates(input_search_states);
+  select(search_states, *rand_generator);
+};
+
+void MappingInstanceSelector::select(SearchStates const &search_states,
+                                     RandomGenerator &rand_generator) {
+  clear_site_paths();
+  selected = SelectedMapping{};
+  this->rand_generator = &rand_generator;
+  input_search_states = &search_states;
+  process_searchstates(search_states);
   int32_t selected_index = random_select_entry();
   if (selected_index >= 0) apply_selection(selected_index);
-};
+}
+
+void MappingInstanceSelector::clear_site_paths() {
+  for (auto &entry : usps) {
+    entry.first.clear();
+    entry.second.first.clear();
+    entry.second.second.clear();
+    spare_classes.push_back(std::move(entry));
+  }
+  usps.clear();
+}
 
 int32_t MappingInstanceSelector::random_select_entry() {
   if (usps.size() == 0) return -1;
-  uint32_t nonvariant_count = count_nonvar_search_states(input_search_states);
+  uint32_t nonvariant_count = count_nonvar_search_states(*input_search_states);
   uint32_t count_total_options = nonvariant_count + usps.size();
 
   uint32_t selected_option = rand_generator->generate(1, count_total_options);
@@ -107,23 +150,36 @@ int32_t MappingInstanceSelector::random_select_entry() {
 }
 
 void MappingInstanceSelector::apply_selection(int32_t selected_index) {
-  auto it = usps.begin();
-  std::advance(it, selected_index);
-  auto chosen_traversal = it->second;
-  selected = SelectedMapping{chosen_traversal.first, chosen_traversal.second};
+  auto const &chosen_traversal = usps[selected_index].second;
+  selected = SelectedMapping{&chosen_traversal.first, &chosen_traversal.second};
 }
 
 void MappingInstanceSelector::add_searchstate(SearchState const &ss) {
-  LocusFinder l{ss, prg_info};
-  // Create or retrieve the coverage information
-  auto &cov_info = usps[l.base_sites];
+  locus_finder.find_loci(ss);
+  auto const &base_sites = locus_finder.base_sites;
+  // Create or retrieve the coverage information, keeping `usps` sorted
+  auto entry = std::lower_bound(
+      usps.begin(), usps.end(), base_sites,
+      [](auto const &entry, level0_Sites const &sites) {
+        return entry.first < sites;
+      });
+  if (entry == usps.end() || entry->first != base_sites) {
+    if (spare_classes.empty())
+      entry = usps.emplace(entry);
+    else {
+      entry = usps.insert(entry, std::move(spare_classes.back()));
+      spare_classes.pop_back();
+    }
+    entry->first.merge(base_sites);
+  }
+  auto &cov_info = entry->second;
 
   // Merge each `VariantLocus` into the existing set of unique `VariantLocus`
-  for (auto &locus : l.unique_loci) cov_info.second.insert(locus);
+  cov_info.second.merge(locus_finder.unique_loci);
 
   // Add the `SearchState` to the list of `SearchStates` compatible with the
   // `base_sites`
-  cov_info.first.push_back(ss);
+  cov_info.first.push_back(&ss);
 }
 
 void MappingInstanceSelector::process_searchstates(SearchStates const &all_ss) {
@@ -162,38 +218,51 @@ uint32_t MappingInstanceSelector::count_nonvar_search_states(
  *  * [TODO] The read has horizontal uncertainty: for eg maps inside one
  * site/allele combination twice. Probably need to randomly select only one
  * mapping instance from those subcases.
+ *
+ * The random draw is keyed on (`random_seed`, `read_id`).
+ *
+ * Each thread selects with the same selector, whose storage serves all the
+ * reads it maps: the selection is valid until the thread's next one.
  */
 SelectedMapping selection(const SearchStates &search_states,
                           const uint64_t &read_length, const PRG_Info &prg_info,
-                          const uint32_t &random_seed) {
-  RandomInclusiveInt rng{random_seed};
-  MappingInstanceSelector m{search_states, &prg_info, &rng};
-
-  // This contains empty containers if we selected a mapping instance in an
-  // invariant part of the PRG
-  SelectedMapping selected = m.get_selection();
+                          const uint32_t &random_seed, ReadID const &read_id) {
+  CounterRandom rng{random_seed,
+                    {uint32_t(read_id.ordinal), uint32_t(read_id.ordinal >> 32),
+                     read_id.reverse_complement, 0}};
+  thread_local PRG_Info const *selector_prg_info = nullptr;
+  thread_local std::unique_ptr<MappingInstanceSelector> m;
+  if (m == nullptr || selector_prg_info != &prg_info) {
+    m = std::make_unique<MappingInstanceSelector>(&prg_info);
+    selector_prg_info = &prg_info;
+  }
+  m->select(search_states, rng);
 
-  return selected;
+  // This is empty if we selected a mapping instance in an invariant part of
+  // the PRG
+  return m->get_selection();
 }
 
 void coverage::record::search_states(Coverage &coverage,
                                      const SearchStates &search_states,
                                      const uint64_t &read_length,
                                      const PRG_Info &prg_info,
-                                     const uint32_t &random_seed) {
+                                     const uint32_t &random_seed,
+                                     ReadID const &read_id) {
   SelectedMapping selected_search_states =
-      selection(search_states, read_length, prg_info, random_seed);
+      selection(search_states, read_length, prg_info, random_seed, read_id);
 
   // If we selected a mapping instance that does not overlap any variant site,
   // there is no coverage to record.
-  if (selected_search_states.navigational_search_states.size() == 0) return;
+  if (selected_search_states.empty()) return;
 
   coverage::record::allele_base(
-      prg_info, selected_search_states.navigational_search_states, read_length);
+      prg_info, *selected_search_states.navigational_search_states,
+      read_length);
   coverage::record::allele_sum(coverage,
-                               selected_search_states.equivalence_class_loci);
+                               *selected_search_states.equivalence_class_loci);
   coverage::record::grouped_allele_counts(
-      coverage, selected_search_states.equivalence_class_loci);
+      coverage, *selected_search_states.equivalence_class_loci);
 }
 
 void coverage::dump::all(const Coverage &coverage,
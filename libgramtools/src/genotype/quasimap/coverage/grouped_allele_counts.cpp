@@ -17,25 +17,17 @@ SitesGroupedAlleleCounts coverage::generate::grouped_allele_counts(
 void coverage::record::grouped_allele_counts(
     Coverage &coverage, uniqueLoci const &compatible_loci) {
   // We will store, for each variant site `Marker`, which alleles are traversed
-  // across
-  // **all** (selected, ie site-equivalent) mapping instances of the processed
-  // read.
-  std::unordered_map<Marker, AlleleIdSet> site_allele_group;
-
-  // Loop through all loci and record the alleles compatible with each site
-  for (const auto &locus : compatible_loci) {
-    auto site_marker = locus.first;
-    auto allele_id = locus.second;
-    site_allele_group[site_marker].insert(allele_id);
-  }
-
-  // Loop through the variant site markers traversed at least once by the read.
-  for (const auto &entry : site_allele_group) {
-    auto site_marker = entry.first;
-    auto allele_ids_set = entry.second;
-    AlleleIds allele_ids;
-    std::copy(allele_ids_set.begin(), allele_ids_set.end(),
-              std::back_inserter(allele_ids));
+  // across **all** (selected, ie site-equivalent) mapping instances of the
+  // processed read. The loci are sorted by site then allele, so each site's
+  // alleles come together, in increasing order.
+  thread_local AlleleIds allele_ids;
+  auto locus = compatible_loci.begin();
+  while (locus != compatible_loci.end()) {
+    auto site_marker = locus->first;
+    allele_ids.clear();
+    for (; locus != compatible_loci.end() && locus->first == site_marker;
+         ++locus)
+      allele_ids.push_back(locus->second);
 
     auto site_index = siteID_to_index(site_marker);
 
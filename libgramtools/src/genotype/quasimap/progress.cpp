@@ -0,0 +1,200 @@
+#include <omp.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "genotype/quasimap/progress.hpp"
+
+using namespace gram;
+namespace fs = std::filesystem;
+
+QuasimapProgress::QuasimapProgress(
+    std::vector<std::string> const &reads_fpaths, std::string status_fpath,
+    std::chrono::milliseconds report_interval)
+    : status_fpath(std::move(status_fpath)),
+      report_interval(report_interval),
+      thread_counts(std::max(1, omp_get_max_threads())),
+      start_time(Clock::now()),
+      last_report_time(start_time) {
+  for (auto const &fpath : reads_fpaths) {
+    std::error_code error;
+    auto const size = fs::file_size(fpath, error);
+    file_sizes.push_back(error ? 0 : size);
+  }
+}
+
+QuasimapProgress::~QuasimapProgress() {
+  if (reporter.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    stop_requested.notify_one();
+    reporter.join();
+  }
+}
+
+void QuasimapProgress::start() {
+  start_time = last_report_time = Clock::now();
+  reporter = std::thread(&QuasimapProgress::report_loop, this);
+}
+
+void QuasimapProgress::stop() {
+  if (reporter.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    stop_requested.notify_one();
+    reporter.join();
+  }
+  report(true);
+}
+
+void QuasimapProgress::record_read(bool skipped,
+                                   uint32_t orientations_searched,
+                                   uint32_t orientations_mapped) {
+  // Only this thread writes to its counts: relaxed ordering suffices, the
+  // reporter only needs each counter to be read whole
+  auto &counts = thread_counts[omp_get_thread_num() % thread_counts.size()];
+  counts.reads.fetch_add(1, std::memory_order_relaxed);
+  if (skipped) counts.skipped.fetch_add(1, std::memory_order_relaxed);
+  if (orientations_searched > 0)
+    counts.orientations_searched.fetch_add(orientations_searched,
+                                           std::memory_order_relaxed);
+  if (orientations_mapped > 0)
+    counts.orientations_mapped.fetch_add(orientations_mapped,
+                                         std::memory_order_relaxed);
+}
+
+void QuasimapProgress::record_orientation_mapped() {
+  auto &counts = thread_counts[omp_get_thread_num() % thread_counts.size()];
+  counts.orientations_mapped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void QuasimapProgress::start_file(std::size_t file_index) {
+  current_file.store(file_index, std::memory_order_relaxed);
+  input_offset.store(0, std::memory_order_relaxed);
+}
+
+void QuasimapProgress::set_input_offset(long offset) {
+  input_offset.store(offset, std::memory_order_relaxed);
+}
+
+void QuasimapProgress::set_buffer_loaded(uint64_t num_reads) {
+  uint64_t reads{0};
+  for (auto const &counts : thread_counts)
+    reads += counts.reads.load(std::memory_order_relaxed);
+  reads_at_buffer_load.store(reads, std::memory_order_relaxed);
+  buffer_loaded.store(num_reads, std::memory_order_relaxed);
+}
+
+QuasimapProgress::JSON QuasimapProgress::status() const {
+  std::chrono::duration<double> const elapsed = Clock::now() - start_time;
+  uint64_t reads{0}, skipped{0}, orientations_searched{0},
+      orientations_mapped{0};
+  JSON per_thread_reads = JSON::array();
+  for (auto const &counts : thread_counts) {
+    auto const thread_reads = counts.reads.load(std::memory_order_relaxed);
+    reads += thread_reads;
+    skipped += counts.skipped.load(std::memory_order_relaxed);
+    orientations_searched +=
+        counts.orientations_searched.load(std::memory_order_relaxed);
+    orientations_mapped +=
+        counts.orientations_mapped.load(std::memory_order_relaxed);
+    per_thread_reads.push_back(thread_reads);
+  }
+
+  // Input consumed, in bytes: completed files plus the current file's offset
+  auto const file_index = current_file.load(std::memory_order_relaxed);
+  auto const offset = input_offset.load(std::memory_order_relaxed);
+  uint64_t bytes_total{0}, bytes_read{0};
+  bool known_input_size = offset >= 0;
+  for (std::size_t i = 0; i < file_sizes.size(); ++i) {
+    bytes_total += file_sizes[i];
+    if (file_sizes[i] == 0) known_input_size = false;
+    if (i < file_index)
+      bytes_read += file_sizes[i];
+    else if (i == file_index && offset > 0)
+      bytes_read += std::min<uint64_t>(offset, file_sizes[i]);
+  }
+
+  JSON eta_seconds;  // null if unknown
+  if (known_input_size && bytes_read > 0)
+    eta_seconds = elapsed.count() * (bytes_total - bytes_read) / bytes_read;
+
+  auto const loaded = buffer_loaded.load(std::memory_order_relaxed);
+  auto const mapped_from_buffer =
+      reads - reads_at_buffer_load.load(std::memory_order_relaxed);
+  auto const pending =
+      loaded > mapped_from_buffer ? loaded - mapped_from_buffer : 0;
+
+  return JSON{
+      {"elapsed_seconds", elapsed.count()},
+      {"reads_processed", reads},
+      {"reads_skipped", skipped},
+      {"orientations_searched", orientations_searched},
+      {"orientations_mapped", orientations_mapped},
+      {"mapped_fraction",
+       orientations_searched == 0
+           ? 0.0
+           : static_cast<double>(orientations_mapped) / orientations_searched},
+      {"reads_per_second", elapsed.count() > 0 ? reads / elapsed.count() : 0},
+      {"input",
+       {{"files_total", file_sizes.size()},
+        {"current_file", file_index},
+        {"bytes_total", bytes_total},
+        {"bytes_read", bytes_read}}},
+      {"eta_seconds", eta_seconds},
+      {"buffer", {{"loaded", loaded}, {"pending", pending}}},
+      {"reads_per_thread", per_thread_reads}};
+}
+
+void QuasimapProgress::report_loop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!stop_requested.wait_for(lock, report_interval,
+                                  [this] { return stopping; }))
+    report(false);
+}
+
+void QuasimapProgress::report(bool done) {
+  auto result = status();
+  auto const now = Clock::now();
+  std::chrono::duration<double> const since_last = now - last_report_time;
+  uint64_t const reads = result["reads_processed"];
+  result["recent_reads_per_second"] =
+      since_last.count() > 0
+          ? (reads - last_reported_reads) / since_last.count()
+          : 0;
+  result["state"] = done ? "done" : "running";
+  last_reported_reads = reads;
+  last_report_time = now;
+
+  std::cout << "Processed " << reads << " reads ("
+            << std::lround(result["recent_reads_per_second"].get<double>())
+            << " reads/s, " << std::setprecision(3)
+            << 100 * result["mapped_fraction"].get<double>() << "% mapped)";
+  if (!done && !result["eta_seconds"].is_null())
+    std::cout << ", ETA " << std::lround(result["eta_seconds"].get<double>())
+              << "s";
+  std::cout << std::endl;
+
+  if (status_fpath.empty() || status_write_failed) return;
+  // Written then renamed, so that pollers never read a partial status
+  auto const tmp_fpath = status_fpath + ".tmp";
+  {
+    std::ofstream fhandle(tmp_fpath);
+    fhandle << std::setw(4) << result << std::endl;
+    status_write_failed = !fhandle.good();
+  }
+  std::error_code error;
+  if (!status_write_failed) fs::rename(tmp_fpath, status_fpath, error);
+  if (status_write_failed || error) {
+    status_write_failed = true;
+    std::cerr << "Warning: could not write quasimap status to "
+              << status_fpath << std::endl;
+  }
+}
@@ -1,5 +1,8 @@
 #include "genotype/quasimap/quasimap.hpp"
 
+#include "common/dna_kernels.hpp"
+#include "common/numa.hpp"
+#include "common/profiling.hpp"
 #include "genotype/quasimap/coverage/allele_base.hpp"
 #include "genotype/quasimap/coverage/coverage_common.hpp"
 #include "genotype/quasimap/search/BWT_search.hpp"
@@ -11,6 +14,7 @@ using namespace gram;
 
 QuasimapReadsStats gram::quasimap_reads(const GenotypeParams &parameters,
                                         const KmerIndex &kmer_index,
+                                        const KmerFilter &kmer_filter,
                                         const PRG_Info &prg_info,
                                         ReadStats &readstats) {
   QuasimapReadsStats quasimap_stats{};
@@ -25,10 +29,28 @@ QuasimapReadsStats gram::quasimap_reads(const GenotypeParams &parameters,
   // mapped reads
 
   // Execute quasimap for each read file provided
-  for (const auto &reads_fpath : parameters.reads_fpaths) {
-    handle_read_file(quasimap_stats, reads_fpath, parameters, kmer_index,
-                     prg_info);
+  ReadCache read_cache(parameters.read_cache_mb << 20);
+  SuffixCache suffix_cache(parameters.suffix_cache_mb << 20);
+  {
+    profiling::ScopedStage stage("Map reads");
+    numa::ScopedPinning pinning(parameters.numa);
+    QuasimapProgress progress(parameters.reads_fpaths,
+                              parameters.quasimap_progress_fpath);
+    QuasimapCaches caches;
+    if (parameters.read_cache_mb > 0) caches.reads = &read_cache;
+    if (parameters.suffix_cache_mb > 0) caches.suffixes = &suffix_cache;
+    progress.start();
+    for (std::size_t i = 0; i < parameters.reads_fpaths.size(); ++i) {
+      progress.start_file(i);
+      handle_read_file(quasimap_stats, parameters.reads_fpaths[i], parameters,
+                       kmer_index, kmer_filter, prg_info, progress, caches);
+    }
+    progress.stop();
   }
+  quasimap_stats.read_cache_lookups = read_cache.hits() + read_cache.misses();
+  quasimap_stats.read_cache_hits = read_cache.hits();
+  quasimap_stats.suffix_cache_lookups = suffix_cache.lookups();
+  quasimap_stats.suffix_cache_hits = suffix_cache.hits();
 
   auto &coverage = quasimap_stats.coverage;
   // Compute read mapping statistics (used in `infer` command). Can only be done
@@ -40,67 +62,119 @@ QuasimapReadsStats gram::quasimap_reads(const GenotypeParams &parameters,
       coverage::generate::allele_base_non_nested(prg_info);
 
   // Write coverage results to disk
-  coverage::dump::all(coverage, parameters);
+  {
+    profiling::ScopedStage stage("Write coverage");
+    coverage::dump::all(coverage, parameters);
+  }
   return quasimap_stats;
 }
 
 /**
- * Emplace up to `max_set_size` reads into the reads buffer.
- * Returns a vector of `Pattern`s: a `Pattern` being a vector of `Base`s, which
- * are integer encoded. The encoding of DNA letters to integers also performed
- * in this function.
+ * Loads up to `max_set_size` reads into the reads buffer, as integer-encoded
+ * `Sequence`s. Reads containing non-ACGT bases are loaded as empty
+ * `Sequence`s. The buffer's `Sequence`s are reused across calls, so that their
+ * storage is allocated once per file rather than once per read.
  */
-std::vector<Sequence> get_reads_buffer(SeqRead::SeqIterator &reads_it,
-                                       SeqRead &reads,
-                                       const uint64_t &max_set_size) {
-  std::vector<Sequence> reads_buffer;
-  while (reads_it != reads.end() and reads_buffer.size() < max_set_size) {
+void get_reads_buffer(SeqRead::SeqIterator &reads_it, SeqRead &reads,
+                      const uint64_t &max_set_size,
+                      std::vector<Sequence> &reads_buffer) {
+  reads_buffer.resize(max_set_size);
+  std::size_t num_reads = 0;
+  while (reads_it != reads.end() and num_reads < max_set_size) {
     const auto *const raw_read = *reads_it;
-    auto read = encode_dna_bases(*raw_read);
-    reads_buffer.emplace_back(read);
+    encode_dna_bases(raw_read->seq, reads_buffer[num_reads]);
+    ++num_reads;
     ++reads_it;
   }
-  return reads_buffer;
+  reads_buffer.resize(num_reads);
 }
 
 /**
- * Calls the (forward_reverse) mapping routine for each read in the read buffer,
- * in parallel (if the CL option has been specified).
+ * Maps an orientation of a read if `kmer_filter` lets its seed through, as
+ * `may_seed` tells.
+ * @return whether it mapped
+ */
+static bool quasimap_orientation(QuasimapReadsStats &quasimap_stats,
+                                 const Sequence &read, bool may_seed,
+                                 const GenotypeParams &parameters,
+                                 const KmerIndex &kmer_index,
+                                 const PRG_Info &prg_info,
+                                 ReadID const &read_id,
+                                 QuasimapCaches const &caches) {
+  if (!may_seed) {
+#pragma omp atomic
+    ++quasimap_stats.prefiltered_reads_count;
+    return false;
+  }
+  bool read_mapped_exactly =
+      quasimap_read(read, quasimap_stats.coverage, kmer_index, prg_info,
+                    parameters, read_id, caches);
+  if (read_mapped_exactly) {
+#pragma omp atomic
+    ++quasimap_stats.mapped_reads_count;
+  }
+  return read_mapped_exactly;
+}
+
+/**
+ * Spawns a task mapping each read in the read buffer, for the threads of the
+ * enclosing parallel region to take as they go idle: a read's cost varies by
+ * orders of magnitude with how many `SearchState`s it gets, so reads are not
+ * dealt out to threads up front. A read with both orientations seeding gets
+ * its reverse complement mapped as a task of its own.
+ * Returns without waiting for the tasks. Progress is reported by `progress`'s
+ * own thread, from per-thread counters.
+ * @param first_ordinal the ordinal of the buffer's first read among all reads
  */
 void handle_reads_buffer(QuasimapReadsStats &quasimap_stats,
                          const std::vector<Sequence> &reads_buffer,
                          const GenotypeParams &parameters,
                          const KmerIndex &kmer_index,
-                         const PRG_Info &prg_info) {
-  uint64_t last_count_reported = 0;
-
-//  Parallelise loop below
-#pragma omp parallel for
+                         const KmerFilter &kmer_filter,
+                         const PRG_Info &prg_info,
+                         QuasimapProgress &progress,
+                         uint64_t first_ordinal,
+                         QuasimapCaches const &caches) {
   for (std::size_t i = 0; i < reads_buffer.size(); ++i) {
-    auto thread_id = omp_get_thread_num();
-    //  Report total number of mapped reads everytime at least `diff` such have
-    //  been mapped
-    if (thread_id == 0) {
-      uint64_t diff = quasimap_stats.all_reads_count - last_count_reported;
-      if (diff >= 10000) {
-        std::cout << quasimap_stats.all_reads_count << std::endl;
-        last_count_reported = quasimap_stats.all_reads_count;
-      }
-    }
-
+    uint64_t const ordinal = first_ordinal + i;
+#pragma omp task default(shared) firstprivate(i, ordinal)
+    {
 //  atomic: for manipulating a static variable (shared among the threads)
 #pragma omp atomic
-    quasimap_stats.all_reads_count +=
-        2;  //  Increment by 2: mapping forward and reverse of read
+      quasimap_stats.all_reads_count +=
+          2;  //  Increment by 2: mapping forward and reverse of read
 
-    auto read = reads_buffer[i];
-    if (read.empty()) {
+      const auto &read = reads_buffer[i];
+      bool const forward_seeds = !read.empty() && kmer_filter.may_seed(read);
+      bool const reverse_seeds =
+          !read.empty() && kmer_filter.may_seed_reverse_complement(read);
+      if (read.empty()) {
 #pragma omp atomic
-      quasimap_stats.skipped_reads_count += 2;
-      continue;
+        quasimap_stats.skipped_reads_count += 2;
+        progress.record_read(true, 0, 0);
+      } else if (forward_seeds && reverse_seeds) {
+#pragma omp task default(shared) firstprivate(ordinal)
+        {
+          // Reused across the reads mapped by this thread
+          thread_local Sequence reverse_read;
+          reverse_complement_read(read, reverse_read);
+          if (quasimap_orientation(quasimap_stats, reverse_read, true,
+                                   parameters, kmer_index, prg_info,
+                                   ReadID{ordinal, true}, caches))
+            progress.record_orientation_mapped();
+        }
+        auto const forward_mapped = quasimap_orientation(
+            quasimap_stats, read, true, parameters, kmer_index, prg_info,
+            ReadID{ordinal, false}, caches);
+        progress.record_read(false, 2, forward_mapped);
+      } else {
+        auto const orientations_mapped = quasimap_forward_reverse(
+            quasimap_stats, read, parameters, kmer_index, kmer_filter,
+            prg_info, ordinal, caches);
+        progress.record_read(false, forward_seeds + reverse_seeds,
+                             orientations_mapped);
+      }
     }
-    quasimap_forward_reverse(quasimap_stats, read, parameters, kmer_index,
-                             prg_info);
   }
 }
 
@@ -108,57 +182,93 @@ void gram::handle_read_file(QuasimapReadsStats &quasimap_stats,
                             const std::string &reads_fpath,
                             const GenotypeParams &parameters,
                             const KmerIndex &kmer_index,
-                            const PRG_Info &prg_info) {
+                            const KmerFilter &kmer_filter,
+                            const PRG_Info &prg_info,
+                            QuasimapProgress &progress,
+                            QuasimapCaches const &caches) {
   //  Number of reads to load in memory; is upper limit of number of reads that
   //  can be mapped in parallel
   uint64_t max_set_size = 5000;
   SeqRead reads(reads_fpath.c_str());
   auto reads_it = reads.begin();
-  while (reads_it != reads.end()) {
-    auto reads_buffer = get_reads_buffer(reads_it, reads, max_set_size);
-    handle_reads_buffer(quasimap_stats, reads_buffer, parameters, kmer_index,
-                        prg_info);
+  // One buffer gets loaded while the reads of the other get mapped
+  std::vector<Sequence> reads_buffers[2];
+  std::size_t mapped_buffer{0};
+  // Numbers reads on from those of the previous files
+  uint64_t first_ordinal = quasimap_stats.all_reads_count / 2;
+#pragma omp parallel
+#pragma omp single
+  {
+    get_reads_buffer(reads_it, reads, max_set_size,
+                     reads_buffers[mapped_buffer]);
+    while (!reads_buffers[mapped_buffer].empty()) {
+      progress.set_input_offset(reads.input_offset());
+      progress.set_buffer_loaded(reads_buffers[mapped_buffer].size());
+      auto const loaded_buffer = 1 - mapped_buffer;
+      // Ends once all the buffer's reads are mapped; this thread maps reads
+      // too once it has loaded the next buffer
+#pragma omp taskgroup
+      {
+        handle_reads_buffer(quasimap_stats, reads_buffers[mapped_buffer],
+                            parameters, kmer_index, kmer_filter, prg_info,
+                            progress, first_ordinal, caches);
+        get_reads_buffer(reads_it, reads, max_set_size,
+                         reads_buffers[loaded_buffer]);
+      }
+      first_ordinal += reads_buffers[mapped_buffer].size();
+      mapped_buffer = loaded_buffer;
+    }
   }
 }
 
-void gram::quasimap_forward_reverse(QuasimapReadsStats &quasimap_stats,
-                                    const Sequence &read,
-                                    const GenotypeParams &parameters,
-                                    const KmerIndex &kmer_index,
-                                    const PRG_Info &prg_info) {
+uint32_t gram::quasimap_forward_reverse(QuasimapReadsStats &quasimap_stats,
+                                        const Sequence &read,
+                                        const GenotypeParams &parameters,
+                                        const KmerIndex &kmer_index,
+                                        const KmerFilter &kmer_filter,
+                                        const PRG_Info &prg_info,
+                                        uint64_t read_ordinal,
+                                        QuasimapCaches const &caches) {
+  uint32_t orientations_mapped{0};
   // Forward mapping
-  bool read_mapped_exactly = quasimap_read(read, quasimap_stats.coverage,
-                                           kmer_index, prg_info, parameters);
-  if (read_mapped_exactly) {
-#pragma omp atomic
-    ++quasimap_stats.mapped_reads_count;
-  }
+  if (quasimap_orientation(quasimap_stats, read, kmer_filter.may_seed(read),
+                           parameters, kmer_index, prg_info,
+                           ReadID{read_ordinal, false}, caches))
+    ++orientations_mapped;
 
-  auto reverse_read = reverse_complement_read(read);
   // Reverse mapping
-  read_mapped_exactly = quasimap_read(reverse_read, quasimap_stats.coverage,
-                                      kmer_index, prg_info, parameters);
-  if (read_mapped_exactly) {
-#pragma omp atomic
-    ++quasimap_stats.mapped_reads_count;
-  }
+  bool const reverse_seeds = kmer_filter.may_seed_reverse_complement(read);
+  // Reused across the reads mapped by this thread
+  thread_local Sequence reverse_read;
+  if (reverse_seeds) reverse_complement_read(read, reverse_read);
+  if (quasimap_orientation(quasimap_stats, reverse_read, reverse_seeds,
+                           parameters, kmer_index, prg_info,
+                           ReadID{read_ordinal, true}, caches))
+    ++orientations_mapped;
+  return orientations_mapped;
 }
 
 bool gram::quasimap_read(const Sequence &read, Coverage &coverage,
                          const KmerIndex &kmer_index, const PRG_Info &prg_info,
-                         const GenotypeParams &parameters) {
-  auto kmer = get_kmer_from_read(parameters.kmers_size,
-                                 read);  // Gets last k bases of read
-
-  auto search_states = search_read_backwards(read, kmer, kmer_index, prg_info);
+                         const GenotypeParams &parameters,
+                         ReadID const &read_id, QuasimapCaches const &caches) {
+  SearchStates search_states;
+  if (caches.reads == nullptr || !caches.reads->find(read, search_states)) {
+    auto kmer = get_kmer_from_read(parameters.kmers_size,
+                                   read);  // Gets last k bases of read
+    search_states = search_read_backwards(read, kmer, kmer_index, prg_info,
+                                          caches.suffixes);
+    if (caches.reads != nullptr) caches.reads->insert(read, search_states);
+  }
   auto read_mapped_exactly = not search_states.empty();
   // Test read did not map
   if (not read_mapped_exactly) return read_mapped_exactly;
   auto read_length = read.size();
 
   uint64_t random_seed = parameters.seed;
+  profiling::ScopedTimer timer("coverage_record");
   coverage::record::search_states(coverage, search_states, read_length,
-                                  prg_info, random_seed);
+                                  prg_info, random_seed, read_id);
   return read_mapped_exactly;
 }
 
@@ -173,29 +283,45 @@ Sequence gram::get_kmer_from_read(const uint32_t &kmer_size,
 SearchStates gram::search_read_backwards(const Sequence &read,
                                          const Sequence &kmer,
                                          const KmerIndex &kmer_index,
-                                         const PRG_Info &prg_info) {
-  // Test if kmer has been indexed
-  bool kmer_in_index = kmer_index.find(kmer) != kmer_index.end();
-  if (not kmer_in_index) return SearchStates{};
-
+                                         const PRG_Info &prg_info,
+                                         SuffixCache *suffix_cache) {
+  SearchStates new_search_states;
+  // Bases of the read extended past the kmer
+  std::size_t extension{0};
+  {
+    profiling::ScopedTimer timer("seed");
+    if (suffix_cache != nullptr)
+      extension = suffix_cache->find(read, kmer.size(), new_search_states);
+    if (extension == 0) {
+      // Test if kmer has been indexed
+      auto const kmer_entry = kmer_index.find(kmer);
+      if (kmer_entry == kmer_index.end()) return SearchStates{};
+      new_search_states = kmer_entry->second;
+    }
+  }
   // Test if kmer has been indexed, but has no search states in prg
-  auto kmer_index_search_states = kmer_index.at(kmer);
-  if (kmer_index_search_states.empty()) return kmer_index_search_states;
+  if (new_search_states.empty()) return new_search_states;
+  profiling::increment(profiling::Counter::reads_seeded);
 
-  // Reverse iterator + skipping through indexed kmer in read
+  // Reverse iterator + skipping through indexed kmer (and cached suffix) in
+  // read
   auto read_begin = read.rbegin();
-  std::advance(read_begin, kmer.size());
-
-  SearchStates new_search_states = kmer_index_search_states;
-
-  for (auto it = read_begin; it != read.rend();
-       ++it) {  /// Iterates end to start of read
-    const int_Base &pattern_char = *it;
-    new_search_states = process_read_char_search_states(
-        pattern_char, new_search_states, prg_info);
-    // Test if no mapping found upon character extension
-    auto read_not_mapped = new_search_states.empty();
-    if (read_not_mapped) break;
+  std::advance(read_begin, kmer.size() + extension);
+
+  {
+    profiling::ScopedTimer timer("extend");
+    for (auto it = read_begin; it != read.rend();
+         ++it) {  /// Iterates end to start of read
+      const int_Base &pattern_char = *it;
+      new_search_states = process_read_char_search_states(
+          pattern_char, new_search_states, prg_info);
+      // Test if no mapping found upon character extension
+      auto read_not_mapped = new_search_states.empty();
+      if (read_not_mapped) break;
+      ++extension;
+      if (suffix_cache != nullptr)
+        suffix_cache->insert(read, kmer.size(), extension, new_search_states);
+    }
   }
 
   new_search_states =
@@ -208,40 +334,22 @@ SearchStates gram::process_read_char_search_states(
     const PRG_Info &prg_info) {
   //  Before extending backward search with next character, check for variant
   //  markers in the current SA intervals This is the v part of vBWT.
-  auto post_markers_search_states =
-      process_markers_search_states(old_search_states, prg_info);
+  SearchStates post_markers_search_states;
+  {
+    profiling::ScopedTimer timer("vBWT_jump");
+    post_markers_search_states =
+        process_markers_search_states(old_search_states, prg_info);
+  }
   //  Regular backward searching
   auto new_search_states =
       search_base_backwards(pattern_char, post_markers_search_states, prg_info);
+  profiling::increment(profiling::Counter::search_states_created,
+                       new_search_states.size());
   return new_search_states;
 }
 
-/**
- * Produce integer-encoded Watson-Crick base complement.
- */
-int_Base complement_encoded_base(const int_Base &encoded_base) {
-  switch (encoded_base) {
-    case 1:
-      return 4;
-    case 2:
-      return 3;
-    case 3:
-      return 2;
-    case 4:
-      return 1;
-    default:
-      return 0;
-  }
-}
-
 Sequence gram::reverse_complement_read(const Sequence &read) {
   Sequence reverse_read;
-  reverse_read.reserve(read.size());
-
-  for (auto it = read.rbegin(); it != read.rend(); ++it) {
-    const auto &base = *it;
-    auto complement_base = complement_encoded_base(base);
-    reverse_read.push_back(complement_base);
-  }
+  reverse_complement_read(read, reverse_read);
   return reverse_read;
 }
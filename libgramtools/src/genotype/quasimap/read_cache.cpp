@@ -0,0 +1,79 @@
+#include "genotype/quasimap/read_cache.hpp"
+
+using namespace gram;
+
+ReadCache::ReadCache(uint64_t max_bytes)
+    : shard_budget(max_bytes / num_shards) {}
+
+ReadCache::Shard &ReadCache::shard_of(Sequence const &read) {
+  return shards[sequence_hash<Sequence>()(read) % num_shards];
+}
+
+bool ReadCache::find(Sequence const &read, SearchStates &search_states) {
+  auto &shard = shard_of(read);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto const found = shard.entries.find(read);
+    if (found != shard.entries.end()) {
+      search_states = found->second;
+      ++num_hits;
+      return true;
+    }
+  }
+  ++num_misses;
+  return false;
+}
+
+void ReadCache::insert(Sequence const &read,
+                       SearchStates const &search_states) {
+  auto const num_bytes = entry_bytes(read, search_states);
+  if (num_bytes > shard_budget) return;
+  auto &shard = shard_of(read);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  // Another thread may have mapped the same read meanwhile
+  auto const inserted = shard.entries.emplace(read, search_states);
+  if (!inserted.second) return;
+  shard.insertion_order.push_back(&inserted.first->first);
+  shard.bytes += num_bytes;
+
+  while (shard.bytes > shard_budget) {
+    auto const oldest = shard.entries.find(*shard.insertion_order.front());
+    shard.bytes -= entry_bytes(oldest->first, oldest->second);
+    shard.entries.erase(oldest);
+    shard.insertion_order.pop_front();
+  }
+}
+
+std::size_t ReadCache::size() {
+  std::size_t result{0};
+  for (auto &shard : shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    result += shard.entries.size();
+  }
+  return result;
+}
+
+uint64_t ReadCache::bytes() {
+  uint64_t result{0};
+  for (auto &shard : shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    result += shard.bytes;
+  }
+  return result;
+}
+
+uint64_t ReadCache::entry_bytes(Sequence const &read,
+                                SearchStates const &search_states) {
+  // The hash map node and bucket, and the insertion order entry
+  constexpr uint64_t entry_overhead = 4 * sizeof(void *);
+  constexpr uint64_t list_node_overhead = 2 * sizeof(void *);
+  uint64_t result = entry_overhead + sizeof(Sequence) + sizeof(SearchStates) +
+                    read.size() * sizeof(int_Base);
+  for (auto const &search_state : search_states) {
+    result += list_node_overhead + sizeof(SearchState) +
+              (search_state.traversed_path.size() +
+               search_state.traversing_path.size()) *
+                  sizeof(VariantLocus);
+  }
+  return result;
+}
@@ -5,18 +5,7 @@ using namespace gram;
 
 uint64_t gram::dna_bwt_rank(const uint64_t &upper_index, const Marker &dna_base,
                             const PRG_Info &prg_info) {
-  switch (dna_base) {
-    case 1:
-      return prg_info.rank_bwt_a(upper_index);
-    case 2:
-      return prg_info.rank_bwt_c(upper_index);
-    case 3:
-      return prg_info.rank_bwt_g(upper_index);
-    case 4:
-      return prg_info.rank_bwt_t(upper_index);
-    default:
-      return 0;
-  }
+  return prg_info.reduced_bwt.rank(upper_index, dna_base);
 }
 
 /**
@@ -51,27 +40,11 @@ SA_Interval gram::base_next_sa_interval(
   const auto &current_sa_start = current_sa_interval.first;
   const auto &current_sa_end = current_sa_interval.second;
 
-  SA_Index sa_start_offset;
-  if (current_sa_start <= 0)
-    sa_start_offset = 0;
-  else {
-    //  TODO: Consider deleting this if-clause, next_char should never be > 4,
-    //  it probably never runs
-    if (next_char > 4)
-      sa_start_offset = prg_info.fm_index.bwt.rank(current_sa_start, next_char);
-    else {
-      sa_start_offset = dna_bwt_rank(current_sa_start, next_char, prg_info);
-    }
-  }
-
-  SA_Index sa_end_offset;
-  //  TODO: Consider deleting this if-clause, next_char should never be > 4, it
-  //  probably never runs
-  if (next_char > 4)
-    sa_end_offset = prg_info.fm_index.bwt.rank(current_sa_end + 1, next_char);
-  else {
-    sa_end_offset = dna_bwt_rank(current_sa_end + 1, next_char, prg_info);
-  }
+  SA_Index sa_start_offset = 0;
+  if (current_sa_start > 0)
+    sa_start_offset = dna_bwt_rank(current_sa_start, next_char, prg_info);
+  SA_Index sa_end_offset =
+      dna_bwt_rank(current_sa_end + 1, next_char, prg_info);
 
   auto new_start = next_char_first_sa_index + sa_start_offset;
   auto new_end = next_char_first_sa_index + sa_end_offset - 1;
@@ -83,8 +56,8 @@ SearchStates gram::search_base_backwards(const int_Base &pattern_char,
                                          const PRG_Info &prg_info) {
   // Compute the first occurrence of `pattern_char` in the suffix array.
   // Necessary for backward search.
-  auto char_alphabet_rank = prg_info.fm_index.char2comp[pattern_char];
-  auto char_first_sa_index = prg_info.fm_index.C[char_alphabet_rank];
+  auto char_first_sa_index =
+      prg_info.reduced_bwt.first_sa_index(pattern_char);
 
   SearchStates new_search_states = {};
 
@@ -1,89 +1,38 @@
 #include "genotype/quasimap/search/encapsulated_search.hpp"
 
-/**
- * A caching object used to temporarily store a single search state
- * @see handle_allele_encapsulated_state()
- */
-class SearchStateCache {
- public:
-  SearchState search_state = {};
-  bool empty = true;
-
-  void set(const SearchState &search_state) {
-    this->search_state = search_state;
-    this->empty = false;
-  }
-
-  void flush(SearchStates &search_states) {
-    if (this->empty) return;
-    search_states.emplace_back(this->search_state);
-    this->empty = true;
-  }
-
-  void update_sa_interval_max(const SA_Index &new_sa_interval_max) {
-    assert(not this->empty);
-    assert(this->search_state.sa_interval.second + 1 == new_sa_interval_max);
-    this->search_state.sa_interval.second = new_sa_interval_max;
-  }
-};
-
 SearchStates gram::handle_allele_encapsulated_state(
     const SearchState &search_state, const PRG_Info &prg_info) {
   assert(not search_state.has_path());
 
   SearchStates new_search_states = {};
-  SearchStateCache cache;
-
-  for (uint64_t sa_index = search_state.sa_interval.first;
-       sa_index <= search_state.sa_interval.second; ++sa_index) {
-    // Retrieve site and allele IDs
-    auto prg_index = prg_info.fm_index[sa_index];
-    auto cov_node = prg_info.coverage_graph.random_access[prg_index].node;
-    auto site_marker = cov_node->get_site_ID();
-    auto allele_id = cov_node->get_allele_ID();
 
-    bool within_site = site_marker != 0;
-    if (not within_site) {
-      cache.flush(new_search_states);
-      cache.set(SearchState{
-          SA_Interval{sa_index, sa_index},
-          VariantSitePath{},
-          VariantSitePath{},
+  // SA indices with the same site and allele come in runs: each run within a
+  // site gives a single SearchState, with the run's SA interval. Note that two
+  // encapsulated mappings do NOT have to be (lexicographic ordering)
+  // consecutive in the suffix array.
+  prg_info.sa_locus_runs.for_each_run(
+      search_state.sa_interval,
+      [&new_search_states](SA_Interval const &sa_interval,
+                           VariantLocus const &locus) {
+        bool within_site = locus.first != 0;
+        if (within_site) {
+          new_search_states.emplace_back(SearchState{
+              sa_interval,
+              VariantSitePath{locus},
+              VariantSitePath{},
+          });
+          return;
+        }
+
+        // Outside sites, each SA index gets its own SearchState
+        for (uint64_t sa_index = sa_interval.first;
+             sa_index <= sa_interval.second; ++sa_index)
+          new_search_states.emplace_back(SearchState{
+              SA_Interval{sa_index, sa_index},
+              VariantSitePath{},
+              VariantSitePath{},
+          });
       });
-      cache.flush(new_search_states);
-      continue;
-    }
-
-    //  else: read is completely encapsulated within allele
-    if (cache.empty) {
-      cache.set(SearchState{
-          SA_Interval{sa_index, sa_index},
-          VariantSitePath{VariantLocus{site_marker, allele_id}},
-          VariantSitePath{},
-      });
-      continue;
-    }
-
-    // cache is not empty: if the current SearchState goes through same site and
-    // allele, lengthen the SA interval of cached SearchState; saves space. Note
-    // that two encapsulated mapping do NOT have to be (lexicographic ordering)
-    // consecutive in the suffix array.
-    VariantSitePath current_path = {VariantLocus{site_marker, allele_id}};
-    bool cache_has_same_path =
-        current_path == cache.search_state.traversed_path;
-    if (cache_has_same_path) {
-      cache.update_sa_interval_max(sa_index);
-      continue;
-    } else {
-      cache.flush(new_search_states);
-      cache.set(SearchState{
-          SA_Interval{sa_index, sa_index},
-          current_path,
-          VariantSitePath{},
-      });
-    }
-  }
-  cache.flush(new_search_states);
   return new_search_states;
 }
 
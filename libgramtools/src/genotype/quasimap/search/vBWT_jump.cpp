@@ -1,23 +1,10 @@
 #include "genotype/quasimap/search/vBWT_jump.hpp"
 
+#include "common/profiling.hpp"
+
 SA_Interval gram::get_allele_marker_sa_interval(
     const Marker &allele_marker_char, const PRG_Info &prg_info) {
-  const auto alphabet_rank = prg_info.fm_index.char2comp[allele_marker_char];
-  const auto start_sa_index = prg_info.fm_index.C[alphabet_rank];
-
-  SA_Index end_sa_index;
-  // Case: the current marker is not the last element of the alphabet.
-  if (alphabet_rank < prg_info.fm_index.sigma - 1) {
-    // Below: use - 1 because we get positioned at the first position whose
-    // suffix starts with the next element in the alphabet note: the rank query
-    // itself is exclusive, so at backward search time this will get +1 again.
-    end_sa_index = prg_info.fm_index.C[alphabet_rank + 1] - 1;
-  }
-  // Case: it is the last element of the alphabet
-  else
-    end_sa_index = prg_info.fm_index.size() - 1;
-
-  return SA_Interval{start_sa_index, end_sa_index};
+  return prg_info.reduced_bwt.sa_interval(allele_marker_char);
 }
 
 /**
@@ -30,8 +17,8 @@ SearchState entering_site_search_state(const Marker &allele_marker,
                                        const SearchState &current_search_state,
                                        const PRG_Info &prg_info) {
   // Get full SA interval of the corresponding allele marker.
-  auto allele_marker_sa_interval =
-      get_allele_marker_sa_interval(allele_marker, prg_info);
+  auto const &allele_marker_sa_interval =
+      prg_info.jump_tables.allele_sa_interval(allele_marker);
 
   // Add site to traversing path
   SearchState new_search_state = current_search_state;
@@ -83,8 +70,7 @@ SearchState exiting_site_search_state(const VariantLocus &locus,
 
   update_variant_site_path(new_search_state, allele_id, site_marker);
 
-  auto alphabet_rank = prg_info.fm_index.char2comp[site_marker];
-  SA_Index site_index = prg_info.fm_index.C[alphabet_rank];
+  SA_Index site_index = prg_info.jump_tables.site_sa_index(site_marker);
 
   new_search_state.sa_interval = SA_Interval{site_index, site_index};
 
@@ -96,9 +82,12 @@ MarkersSearchResults gram::left_markers_search(const SearchState &search_state,
   MarkersSearchResults markers_search_results;
 
   const auto &sa_interval = search_state.sa_interval;
+  profiling::increment(profiling::Counter::sa_entries_touched,
+                       sa_interval.second - sa_interval.first + 1);
 
+  auto const &bwt_markers_mask = *prg_info.bwt_markers_mask;
   for (int index = sa_interval.first; index <= sa_interval.second; index++) {
-    if (prg_info.bwt_markers_mask[index] == 0) continue;
+    if (bwt_markers_mask[index] == 0) continue;
 
     auto prg_index = prg_info.fm_index[index];
     VariantLocus target_locus =
@@ -106,7 +95,7 @@ MarkersSearchResults gram::left_markers_search(const SearchState &search_state,
     // Convert the target to a site ID if it is an allele ID that points to the
     // beginning of the site (ie, it is not the last allele)
     if (is_allele_marker(target_locus.first)) {
-      if (prg_info.last_allele_positions.at(target_locus.first) !=
+      if (prg_info.jump_tables.site_end_position(target_locus.first) !=
           prg_index - 1)
         target_locus.first--;
     }
@@ -137,7 +126,6 @@ SearchStates gram::search_state_vBWT_jumps(
   auto marker_targets = left_markers_search(current_search_state, prg_info);
   if (marker_targets.empty()) return SearchStates{};
 
-  target_m const &target_map = prg_info.coverage_graph.target_map;
   SearchStates markers_search_states = {};
   Locus_and_SearchStates extension_targets;
   Locus_and_SearchStates to_process_targets;
@@ -156,6 +144,7 @@ SearchStates gram::search_state_vBWT_jumps(
     to_process_targets.pop_back();
     auto const &target_locus = to_process_target.locus;
     auto const &search_state = to_process_target.search_state;
+    profiling::increment(profiling::Counter::vBWT_jumps);
 
     // Get the new targets
     if (is_site_marker(target_locus.first)) {
@@ -188,7 +177,7 @@ Locus_and_SearchState gram::extend_targets_site_exit(
   VariantLocus next_target = target_locus;
   auto site_marker = next_target.first;
   bool commit_me{true};
-  auto &target_map = prg_info.coverage_graph.target_map;
+  auto const &jump_tables = prg_info.jump_tables;
 
   // update the SearchState.
   auto new_search_state =
@@ -196,14 +185,10 @@ Locus_and_SearchState gram::extend_targets_site_exit(
   // Signal we do not want to process the locus further, by default.
   next_target = VariantLocus{0, 0};
 
-  while (target_map.find(site_marker) != target_map.end()) {
-    auto target_markers = target_map.at(site_marker);
-    assert(target_markers.size() == 1);  // A site entry point should not point
-                                         // to more than one other marker
-
-    // Make new_locus point to the next site marker that needs a vBWT jump
-    auto next_site_marker = target_markers.back().ID;
-
+  // A site exit point points to at most one other marker: the next site
+  // marker that needs a vBWT jump
+  Marker next_site_marker;
+  while ((next_site_marker = jump_tables.exit_target(site_marker)) != 0) {
     if (is_allele_marker(next_site_marker)) {  // An exit followed by an entry
       next_target = VariantLocus{next_site_marker, 0};
       commit_me = false;  // There will be no sequence to extend into, so we
@@ -213,7 +198,7 @@ Locus_and_SearchState gram::extend_targets_site_exit(
     } else {  // A double exit
       // Sanity check: the targeted double exit should be correspondingly well
       // recorded in the parental map
-      auto parent_site = prg_info.coverage_graph.par_map.at(site_marker);
+      auto const &parent_site = jump_tables.parent_locus(site_marker);
       assert(parent_site.first == next_site_marker);
 
       // update the SearchState.
@@ -243,13 +228,11 @@ Locus_and_SearchStates gram::extend_targets_site_entry(
   extensions.push_back({next_target, new_search_state, true});
 
   // Now look for extensions
-  auto &target_map = prg_info.coverage_graph.target_map;
-  bool has_targets = target_map.find(variant_marker) != target_map.end();
-
-  if (!has_targets) return extensions;
+  auto const targets = prg_info.jump_tables.entry_targets(variant_marker);
+  if (targets.empty()) return extensions;
 
-  // Traverse each target in the map and add it as an extension
-  for (auto &mapped_target : target_map.at(variant_marker)) {
+  // Traverse each target and add it as an extension
+  for (auto const &mapped_target : targets) {
     if (is_site_marker(mapped_target.ID)) {  // Case: direct deletion
       assert(mapped_target.direct_deletion_allele != ALLELE_UNKNOWN);
       VariantLocus site_exit_locus{mapped_target.ID,
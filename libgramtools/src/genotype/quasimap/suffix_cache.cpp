@@ -0,0 +1,103 @@
+#include "genotype/quasimap/suffix_cache.hpp"
+#include "genotype/quasimap/read_cache.hpp"
+
+using namespace gram;
+
+SuffixCache::SuffixCache(uint64_t max_bytes, Checkpoints extensions,
+                         double min_hit_rate, uint64_t min_lookups)
+    : shard_budget(max_bytes / num_shards),
+      min_hit_rate(min_hit_rate),
+      min_lookups(min_lookups),
+      checkpoints(extensions.size()) {
+  for (std::size_t i = 0; i < extensions.size(); ++i)
+    checkpoints[i].extension = extensions[i];
+}
+
+SuffixCache::Shard &SuffixCache::shard_of(Sequence const &suffix) {
+  return shards[sequence_hash<Sequence>()(suffix) % num_shards];
+}
+
+/** Suffixes are held both in the LRU list and as index keys */
+static uint64_t entry_bytes(Sequence const &suffix,
+                            SearchStates const &search_states) {
+  return ReadCache::entry_bytes(suffix, search_states) + sizeof(Sequence) +
+         suffix.size() * sizeof(int_Base);
+}
+
+/** The last `length` bases of `read`, into `suffix` */
+static void copy_suffix(Sequence const &read, std::size_t length,
+                        Sequence &suffix) {
+  suffix.assign(read.end() - length, read.end());
+}
+
+std::size_t SuffixCache::find(Sequence const &read, std::size_t kmer_size,
+                              SearchStates &search_states) {
+  if (shard_budget == 0) return 0;
+  ++num_lookups;
+  // Reused across the reads looked up by this thread
+  thread_local Sequence suffix;
+  for (auto checkpoint = checkpoints.rbegin(); checkpoint != checkpoints.rend();
+       ++checkpoint) {
+    if (!checkpoint->active ||
+        kmer_size + checkpoint->extension > read.size())
+      continue;
+    copy_suffix(read, kmer_size + checkpoint->extension, suffix);
+    ++checkpoint->lookups;
+    auto &shard = shard_of(suffix);
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto const found = shard.index.find(suffix);
+      if (found != shard.index.end()) {
+        shard.entries.splice(shard.entries.begin(), shard.entries,
+                             found->second);
+        search_states = found->second->second;
+        ++checkpoint->hits;
+        ++num_hits;
+        return checkpoint->extension;
+      }
+    }
+    adapt(*checkpoint);
+  }
+  return 0;
+}
+
+void SuffixCache::insert(Sequence const &read, std::size_t kmer_size,
+                         std::size_t extension,
+                         SearchStates const &search_states) {
+  auto checkpoint = checkpoints.begin();
+  while (checkpoint != checkpoints.end() && checkpoint->extension != extension)
+    ++checkpoint;
+  if (checkpoint == checkpoints.end() || !checkpoint->active) return;
+
+  thread_local Sequence suffix;
+  copy_suffix(read, kmer_size + extension, suffix);
+  auto const num_bytes = entry_bytes(suffix, search_states);
+  if (num_bytes > shard_budget) return;
+  auto &shard = shard_of(suffix);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  // Another thread may have extended the same suffix meanwhile
+  if (shard.index.find(suffix) != shard.index.end()) return;
+  shard.entries.emplace_front(suffix, search_states);
+  shard.index.emplace(suffix, shard.entries.begin());
+  shard.bytes += num_bytes;
+
+  while (shard.bytes > shard_budget) {
+    auto const &oldest = shard.entries.back();
+    shard.bytes -= entry_bytes(oldest.first, oldest.second);
+    shard.index.erase(oldest.first);
+    shard.entries.pop_back();
+  }
+}
+
+void SuffixCache::adapt(Checkpoint &checkpoint) {
+  uint64_t const lookups = checkpoint.lookups;
+  if (lookups < min_lookups) return;
+  if (checkpoint.hits < min_hit_rate * lookups) checkpoint.active = false;
+}
+
+SuffixCache::Checkpoints SuffixCache::active_checkpoints() const {
+  Checkpoints result;
+  for (auto const &checkpoint : checkpoints)
+    if (checkpoint.active) result.push_back(checkpoint.extension);
+  return result;
+}
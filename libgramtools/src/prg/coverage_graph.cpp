@@ -1,4 +1,9 @@
 #include "prg/coverage_graph.hpp"
+
+#include <omp.h>
+
+#include <numeric>
+
 #include "common/utils.hpp"
 
 coverage_Node::coverage_Node()
@@ -31,9 +36,7 @@ coverage_Node::coverage_Node(std::string const seq, int const pos,
 
 void coverage_Node::add_sequence(std::string const& new_seq) {
   sequence += new_seq;
-  if (is_in_bubble()) {
-    for (std::size_t i = 0; i < new_seq.size(); ++i) coverage.emplace_back(0);
-  }
+  if (is_in_bubble()) coverage.resize(coverage.size() + new_seq.size(), 0);
 }
 
 /**
@@ -79,60 +82,191 @@ bool operator==(coverage_Graph const& f, coverage_Graph const& s) {
   return (f.par_map == s.par_map && f.target_map == s.target_map);
 }
 
+namespace {
+/** Makes a node, recording it in @param piece */
+covG_ptr make_node(cov_Graph_Builder::Piece& piece, coverage_Node node) {
+  piece.nodes.emplace_back(boost::make_shared<coverage_Node>(std::move(node)));
+  return piece.nodes.back();
+}
+}  // namespace
+
 cov_Graph_Builder::cov_Graph_Builder(PRG_String const& prg_string) {
   linear_prg = prg_string.get_PRG_string();
   random_access = access_vec(linear_prg.size(), node_access());
   end_positions = prg_string.get_end_positions();
-  make_root();
-  cur_Locus = std::make_pair(0, ALLELE_UNKNOWN);  // Meaning: no current Locus.
 
-  for (uint32_t i = 0; i < linear_prg.size(); ++i) {
-    process_marker(i);
-    setup_random_access(i);
+  marker_types.resize(linear_prg.size());
+#pragma omp parallel for schedule(static)
+  for (std::size_t i = 0; i < linear_prg.size(); ++i)
+    marker_types[i] = find_marker_type(i);
+
+  auto const piece_starts = find_piece_starts();
+  std::vector<Piece> pieces(piece_starts.size());
+  for (std::size_t i = 0; i < pieces.size(); ++i) {
+    pieces[i].start = piece_starts[i];
+    pieces[i].end =
+        i + 1 < pieces.size() ? piece_starts[i + 1] : linear_prg.size();
+  }
+
+  // Exceptions cannot leave a parallel region: they are rethrown after it
+  std::vector<std::exception_ptr> errors(pieces.size());
+#pragma omp parallel for schedule(dynamic, 1)
+  for (std::size_t i = 0; i < pieces.size(); ++i) {
+    try {
+      build_piece(pieces[i]);
+      map_targets(pieces[i]);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
   }
-  make_sink();
-  map_targets();
+  for (auto const& error : errors)
+    if (error) std::rethrow_exception(error);
+
+  stitch(pieces);
+  make_sink(pieces.back());
 }
 
-void cov_Graph_Builder::make_root() {
-  cur_pos = -1;
-  root = boost::make_shared<coverage_Node>(coverage_Node(cur_pos));
-  backWire = root;
-  cur_pos++;
-  cur_Node = boost::make_shared<coverage_Node>(coverage_Node(cur_pos));
+std::vector<std::size_t> cov_Graph_Builder::find_piece_starts() const {
+  // Several chunks per thread, for balancing the load of building pieces
+  std::size_t const num_chunks = std::max<std::size_t>(
+      std::min<std::size_t>(4 * omp_get_max_threads(), linear_prg.size()), 1);
+  std::vector<std::size_t> bounds(num_chunks + 1);
+  for (std::size_t i = 0; i <= num_chunks; ++i)
+    bounds[i] = linear_prg.size() * i / num_chunks;
+
+  // Site nesting depth at the start of each chunk
+  std::vector<int64_t> depths(num_chunks + 1, 0);
+#pragma omp parallel for schedule(static)
+  for (std::size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    int64_t net_depth{0};
+    for (auto pos = bounds[chunk]; pos < bounds[chunk + 1]; ++pos) {
+      if (marker_types[pos] == marker_type::site_entry)
+        ++net_depth;
+      else if (marker_types[pos] == marker_type::site_end)
+        --net_depth;
+    }
+    depths[chunk + 1] = net_depth;
+  }
+  std::partial_sum(depths.begin(), depths.end(), depths.begin());
+
+  // Each chunk contributes its first top-level site entry, if any
+  std::vector<std::size_t> chunk_starts(num_chunks, 0);
+#pragma omp parallel for schedule(static)
+  for (std::size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    auto depth = depths[chunk];
+    for (auto pos = bounds[chunk]; pos < bounds[chunk + 1]; ++pos) {
+      if (marker_types[pos] == marker_type::site_entry) {
+        if (depth == 0) {
+          chunk_starts[chunk] = pos;
+          break;
+        }
+        ++depth;
+      } else if (marker_types[pos] == marker_type::site_end)
+        --depth;
+    }
+  }
+
+  std::vector<std::size_t> piece_starts{0};
+  for (auto const& start : chunk_starts)
+    if (start != 0) piece_starts.emplace_back(start);
+  return piece_starts;
+}
+
+void cov_Graph_Builder::build_piece(Piece& piece) {
+  make_root(piece);
+  auto pos = piece.start;
+  while (pos < piece.end) {
+    if (marker_types[pos] != marker_type::sequence) {
+      process_marker(piece, pos);
+      setup_random_access(piece, pos);
+      ++pos;
+      continue;
+    }
+    auto run_end = pos + 1;
+    while (run_end < piece.end &&
+           marker_types[run_end] == marker_type::sequence)
+      ++run_end;
+    add_sequence(piece, pos, run_end);
+    pos = run_end;
+  }
+}
+
+void cov_Graph_Builder::stitch(std::vector<Piece>& pieces) {
+  std::size_t offset{0};
+  Piece const* previous{nullptr};
+  for (auto& piece : pieces) {
+    if (offset > 0) {
+      for (auto const& node : piece.nodes)
+        node->set_pos(node->get_pos() + offset);
+      piece.cur_pos += offset;
+    }
+    // Pieces after the first start with a site entry, which the placeholder
+    // got wired to
+    if (previous != nullptr)
+      wire(previous->backWire, previous->cur_Node,
+           piece.entry->get_edges().front());
+
+    // Only now are node positions, which order the bubble map, final
+    for (auto const& bubble_start : piece.bubble_starts)
+      bubble_map.insert(std::make_pair(
+          bubble_start.second, piece.bubble_ends.at(bubble_start.first)));
+    bubble_starts.insert(piece.bubble_starts.begin(),
+                         piece.bubble_starts.end());
+    bubble_ends.insert(piece.bubble_ends.begin(), piece.bubble_ends.end());
+    par_map.insert(piece.par_map.begin(), piece.par_map.end());
+    target_map.insert(piece.target_map.begin(), piece.target_map.end());
+
+    offset = piece.cur_pos;
+    previous = &piece;
+  }
+}
+
+void cov_Graph_Builder::make_root(Piece& piece) {
+  if (piece.start == 0) {
+    root = boost::make_shared<coverage_Node>(
+        coverage_Node(static_cast<std::size_t>(-1)));
+    piece.backWire = root;
+  } else {
+    piece.entry = boost::make_shared<coverage_Node>();
+    piece.backWire = piece.entry;
+  }
+  piece.cur_pos = 0;
+  piece.cur_Node = make_node(piece, coverage_Node(piece.cur_pos));
 }
 
-void cov_Graph_Builder::make_sink() {
-  auto sink = boost::make_shared<coverage_Node>(coverage_Node(cur_pos + 1));
-  wire(sink);
-  cur_Node = nullptr;
-  backWire = nullptr;
+void cov_Graph_Builder::make_sink(Piece& piece) {
+  auto sink =
+      boost::make_shared<coverage_Node>(coverage_Node(piece.cur_pos + 1));
+  wire(piece.backWire, piece.cur_Node, sink);
+  piece.cur_Node = nullptr;
+  piece.backWire = nullptr;
 }
 
-void cov_Graph_Builder::process_marker(uint32_t const& pos) {
+void cov_Graph_Builder::process_marker(Piece& piece, uint32_t const& pos) {
   Marker m = linear_prg[pos];
-  marker_type t = find_marker_type(pos);
+  marker_type t = marker_types[pos];
 
   switch (t) {
     case marker_type::sequence:
-      add_sequence(m);
+      add_sequence(piece, pos, pos + 1);
       break;
     case marker_type::site_entry:
-      enter_site(m);
+      enter_site(piece, m);
       break;
     case marker_type::allele_end:
-      end_allele(m);
+      end_allele(piece, m);
       break;
     case marker_type::site_end:
-      exit_site(m);
+      exit_site(piece, m);
   }
 }
 
-void cov_Graph_Builder::setup_random_access(uint32_t const& pos) {
-  marker_type t = find_marker_type(pos);
+void cov_Graph_Builder::setup_random_access(Piece& piece, uint32_t const& pos) {
+  marker_type t = marker_types[pos];
   // Set up random access
   covG_ptr target;
-  t == marker_type::sequence ? target = cur_Node : target = backWire;
+  t == marker_type::sequence ? target = piece.cur_Node
+                             : target = piece.backWire;
   auto seq_size = target->get_sequence_size();
   if (seq_size <= 1)  // Will include all site entry and exit nodes, and
                       // sequence nodes with a single character
@@ -143,7 +277,7 @@ void cov_Graph_Builder::setup_random_access(uint32_t const& pos) {
         node_access{target, seq_size - 1, VariantLocus{0, ALLELE_UNKNOWN}};
 }
 
-marker_type cov_Graph_Builder::find_marker_type(uint32_t const& pos) {
+marker_type cov_Graph_Builder::find_marker_type(uint32_t const& pos) const {
   auto const& m = linear_prg[pos];
   if (m <= 4)
     return marker_type::sequence;  // Note: the `PRG_String` constructor code
@@ -163,101 +297,114 @@ marker_type cov_Graph_Builder::find_marker_type(uint32_t const& pos) {
   return marker_type::site_end;
 }
 
-void cov_Graph_Builder::add_sequence(Marker const& m) {
-  std::string c =
-      decode_dna_base(m);  // Note: implicit conversion of m from uint32_t to
-                           // uint8_t; this is OK because 0 < m < 5.
-  cur_Node->add_sequence(c);
-  cur_pos++;
+void cov_Graph_Builder::add_sequence(Piece& piece, std::size_t start,
+                                     std::size_t end) {
+  std::string sequence(end - start, 'N');
+  for (auto pos = start; pos < end; ++pos)
+    sequence[pos - start] =
+        decode_dna_base(linear_prg[pos])
+            .front();  // Note: implicit conversion of the marker from
+                       // uint32_t to uint8_t; this is OK because 0 < m < 5.
+
+  auto const& node = piece.cur_Node;
+  auto const offset = node->get_sequence_size();
+  node->add_sequence(sequence);
+  for (std::size_t i = 0; i < sequence.size(); ++i)
+    random_access[start + i] =
+        node_access{node, offset + i, VariantLocus{0, ALLELE_UNKNOWN}};
+  piece.cur_pos += sequence.size();
 }
 
-void cov_Graph_Builder::enter_site(Marker const& m) {
-  auto site_entry = boost::make_shared<coverage_Node>(
-      coverage_Node("", cur_pos, m, ALLELE_UNKNOWN));
+void cov_Graph_Builder::enter_site(Piece& piece, Marker const& m) {
+  auto site_entry =
+      make_node(piece, coverage_Node("", piece.cur_pos, m, ALLELE_UNKNOWN));
   site_entry->mark_as_boundary();
-  wire(site_entry);
+  wire(piece.backWire, piece.cur_Node, site_entry);
 
-  // Update the global pointers
-  cur_Node = boost::make_shared<coverage_Node>(
-      coverage_Node("", cur_pos, m, FIRST_ALLELE));
-  first_allele = true;
-  backWire = site_entry;
+  // Update the piece's pointers
+  piece.cur_Node =
+      make_node(piece, coverage_Node("", piece.cur_pos, m, FIRST_ALLELE));
+  piece.first_allele = true;
+  piece.backWire = site_entry;
 
-  // Make & register a new bubble
-  auto site_exit = boost::make_shared<coverage_Node>(
-      coverage_Node("", cur_pos, m, ALLELE_UNKNOWN));
+  // Make & register a new bubble; it goes in the bubble map on stitching
+  auto site_exit =
+      make_node(piece, coverage_Node("", piece.cur_pos, m, ALLELE_UNKNOWN));
   site_exit->mark_as_boundary();
-  bubble_map.insert(std::make_pair(site_entry, site_exit));
-  bubble_starts.insert(std::make_pair(m, site_entry));
-  bubble_ends.insert(std::make_pair(m, site_exit));
+  piece.bubble_starts.insert(std::make_pair(m, site_entry));
+  piece.bubble_ends.insert(std::make_pair(m, site_exit));
 
   // Update the parent map & the current Locus
-  if (cur_Locus.first != 0) par_map.insert(std::make_pair(m, cur_Locus));
-  cur_Locus = std::make_pair(m, FIRST_ALLELE);
+  if (piece.cur_Locus.first != 0)
+    piece.par_map.insert(std::make_pair(m, piece.cur_Locus));
+  piece.cur_Locus = std::make_pair(m, FIRST_ALLELE);
 }
 
-void cov_Graph_Builder::end_allele(Marker const& m) {
+void cov_Graph_Builder::end_allele(Piece& piece, Marker const& m) {
   auto site_ID = m - 1;
-  reach_allele_end(m);
-  auto& allele_ID = cur_Locus.second;
+  reach_allele_end(piece, m);
+  auto& allele_ID = piece.cur_Locus.second;
 
   // Reset node and position to the site start node
-  auto site_entry = bubble_starts.at(site_ID);
-  backWire = site_entry;
-  cur_pos = site_entry->get_pos();
+  auto site_entry = piece.bubble_starts.at(site_ID);
+  piece.backWire = site_entry;
+  piece.cur_pos = site_entry->get_pos();
 
   // Update to the next allele
   allele_ID++;
-  cur_Node = boost::make_shared<coverage_Node>(
-      coverage_Node("", cur_pos, site_ID, allele_ID));
+  piece.cur_Node =
+      make_node(piece, coverage_Node("", piece.cur_pos, site_ID, allele_ID));
 }
 
-void cov_Graph_Builder::exit_site(Marker const& m) {
+void cov_Graph_Builder::exit_site(Piece& piece, Marker const& m) {
   auto site_ID = m - 1;
-  auto site_exit = reach_allele_end(m);
+  auto site_exit = reach_allele_end(piece, m);
+  auto& cur_Locus = piece.cur_Locus;
 
   if (cur_Locus.second == FIRST_ALLELE)
     throw std::runtime_error("Site numbered " + std::to_string(m) +
                              " has only one allele");
 
   // Update the current Locus
-  if (par_map.find(site_ID) != par_map.end()) {
-    cur_Locus = par_map.at(site_ID);
-    if (cur_Locus.second == FIRST_ALLELE) first_allele = true;
+  if (piece.par_map.find(site_ID) != piece.par_map.end()) {
+    cur_Locus = piece.par_map.at(site_ID);
+    if (cur_Locus.second == FIRST_ALLELE) piece.first_allele = true;
   }
   // Means we were in a level 1 site; we will no longer be in a site
   else
     cur_Locus = std::make_pair(0, ALLELE_UNKNOWN);
 
-  backWire = site_exit;
-  cur_pos = site_exit->get_pos();
-  cur_Node = boost::make_shared<coverage_Node>(
-      coverage_Node("", cur_pos, cur_Locus.first, cur_Locus.second));
+  piece.backWire = site_exit;
+  piece.cur_pos = site_exit->get_pos();
+  piece.cur_Node = make_node(
+      piece,
+      coverage_Node("", piece.cur_pos, cur_Locus.first, cur_Locus.second));
 }
 
-covG_ptr cov_Graph_Builder::reach_allele_end(Marker const& m) {
+covG_ptr cov_Graph_Builder::reach_allele_end(Piece& piece, Marker const& m) {
   // Make sure we are tracking the right site
   auto site_ID = m - 1;
-  assert(cur_Locus.first == site_ID);
+  assert(piece.cur_Locus.first == site_ID);
 
-  auto site_exit = bubble_ends.at(site_ID);
-  wire(site_exit);
+  auto site_exit = piece.bubble_ends.at(site_ID);
+  wire(piece.backWire, piece.cur_Node, site_exit);
 
-  if (first_allele) {
-    site_exit->set_pos(cur_pos);
-    first_allele = false;
+  if (piece.first_allele) {
+    site_exit->set_pos(piece.cur_pos);
+    piece.first_allele = false;
   }
 
   /* Use this instead to make coordinates reflect the LONGEST, not FIRST, allele
   in a site
   // Update the exit's pos if it is smaller than this allele's
-  if (site_exit->get_pos() < cur_pos) site_exit->set_pos(cur_pos);
+  if (site_exit->get_pos() < piece.cur_pos) site_exit->set_pos(piece.cur_pos);
   */
 
   return site_exit;
 }
 
-void cov_Graph_Builder::wire(covG_ptr const& target) {
+void cov_Graph_Builder::wire(covG_ptr const& backWire, covG_ptr const& cur_Node,
+                             covG_ptr const& target) {
   if (cur_Node->has_sequence()) {
     backWire->add_edge(cur_Node);
     cur_Node->add_edge(target);
@@ -265,17 +412,20 @@ void cov_Graph_Builder::wire(covG_ptr const& target) {
     backWire->add_edge(target);
 }
 
-void cov_Graph_Builder::map_targets() {
-  marker_type prev_t = marker_type::sequence;
-  Marker prev_m = 0;
+void cov_Graph_Builder::map_targets(Piece& piece) {
+  // A piece after the first starts at a top-level site entry, which sets the
+  // allele ID
+  marker_type prev_t =
+      piece.start == 0 ? marker_type::sequence : marker_types[piece.start - 1];
+  Marker prev_m = piece.start == 0 ? 0 : linear_prg[piece.start - 1];
   marker_type cur_t;
   Marker cur_m;
   Marker cur_allele_ID = ALLELE_UNKNOWN;
 
-  int pos = 0;
-  while (pos < linear_prg.size()) {
+  auto pos = piece.start;
+  while (pos < piece.end) {
     cur_m = linear_prg[pos];
-    cur_t = find_marker_type(pos);
+    cur_t = marker_types[pos];
 
     switch (cur_t) {
       case marker_type::sequence:
@@ -287,20 +437,20 @@ void cov_Graph_Builder::map_targets() {
       case marker_type::site_entry:
         cur_allele_ID = FIRST_ALLELE;
         if (prev_t != marker_type::sequence)
-          make_site_entry_target(prev_t, prev_m, cur_m);
+          make_site_entry_target(piece, prev_t, prev_m, cur_m);
         break;
       case marker_type::site_end:
         if (prev_t != marker_type::sequence)
-          make_site_exit_target(prev_t, prev_m, cur_m, cur_allele_ID);
+          make_site_exit_target(piece, prev_t, prev_m, cur_m, cur_allele_ID);
         // Get the allele ID using the parental map
-        if (par_map.find(cur_m - 1) != par_map.end())
-          cur_allele_ID = par_map.at(cur_m - 1).second;
+        if (piece.par_map.find(cur_m - 1) != piece.par_map.end())
+          cur_allele_ID = piece.par_map.at(cur_m - 1).second;
         else
           cur_allele_ID = ALLELE_UNKNOWN;
         break;
       case marker_type::allele_end:
         if (prev_t != marker_type::sequence)
-          make_allele_end_target(prev_t, prev_m, cur_m, cur_allele_ID);
+          make_allele_end_target(piece, prev_t, prev_m, cur_m, cur_allele_ID);
         cur_allele_ID++;
         break;
     }
@@ -310,7 +460,8 @@ void cov_Graph_Builder::map_targets() {
   }
 }
 
-void cov_Graph_Builder::make_site_entry_target(marker_type prev_t,
+void cov_Graph_Builder::make_site_entry_target(Piece& piece,
+                                               marker_type prev_t,
                                                Marker prev_m, Marker cur_m) {
   Marker marker_target{prev_m};
   AlleleId direct_deletion_allele{ALLELE_UNKNOWN};
@@ -324,11 +475,11 @@ void cov_Graph_Builder::make_site_entry_target(marker_type prev_t,
   }
   std::vector<targeted_marker> new_target{
       targeted_marker{marker_target, direct_deletion_allele}};
-  target_map.insert(std::make_pair(cur_m, new_target));
+  piece.target_map.insert(std::make_pair(cur_m, new_target));
 }
 
-void cov_Graph_Builder::make_site_exit_target(marker_type prev_t, Marker prev_m,
-                                              Marker cur_m,
+void cov_Graph_Builder::make_site_exit_target(Piece& piece, marker_type prev_t,
+                                              Marker prev_m, Marker cur_m,
                                               AlleleId cur_allele_ID) {
   Marker marker_target{prev_m};
   AlleleId direct_deletion_allele{ALLELE_UNKNOWN};
@@ -345,11 +496,12 @@ void cov_Graph_Builder::make_site_exit_target(marker_type prev_t, Marker prev_m,
       direct_deletion_allele = cur_allele_ID;
       break;
   }
-  add_exit_target(cur_m,
+  add_exit_target(piece.target_map, cur_m,
                   targeted_marker{marker_target, direct_deletion_allele});
 }
 
-void cov_Graph_Builder::make_allele_end_target(marker_type prev_t,
+void cov_Graph_Builder::make_allele_end_target(Piece& piece,
+                                               marker_type prev_t,
                                                Marker prev_m, Marker cur_m,
                                                AlleleId cur_allele_ID) {
   Marker marker_target{prev_m};
@@ -365,11 +517,12 @@ void cov_Graph_Builder::make_allele_end_target(marker_type prev_t,
       marker_target -= 1;
       break;
   }
-  add_exit_target(cur_m,
+  add_exit_target(piece.target_map, cur_m,
                   targeted_marker{marker_target, direct_deletion_allele});
 }
 
-void cov_Graph_Builder::add_exit_target(Marker cur_m, targeted_marker new_t_m) {
+void cov_Graph_Builder::add_exit_target(target_m& target_map, Marker cur_m,
+                                        targeted_marker new_t_m) {
   if (target_map.find(cur_m) != target_map.end()) {
     target_map.at(cur_m).emplace_back(new_t_m);
   } else {
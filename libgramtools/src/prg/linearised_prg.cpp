@@ -1,39 +1,37 @@
+#include <omp.h>
+
+#include <algorithm>
+
 #include "prg/linearised_prg.hpp"
 #include "common/parameters.hpp"
 #include "common/utils.hpp"
 
+static_assert(sizeof(Marker) == gram::num_bytes_per_integer,
+              "PRG strings are read and written as arrays of markers");
+
 /**********************
  * Supporting nesting**
  **********************/
 PRG_String::PRG_String(std::string const &file_in, endianness en)
     : odd_site_end_found(false), en(en) {
-  std::fstream input(file_in, std::ios::in | std::ios::binary);
+  std::ifstream input(file_in, std::ios::in | std::ios::binary);
+  if (!input) throw std::ios::failure("PRG String file not found");
+
+  // Read in bulk, then convert from the file's byte order if it is not ours
+  auto const num_bytes = fs::file_size(file_in);
+  my_PRG_string.resize(num_bytes / gram::num_bytes_per_integer);
+  input.read(reinterpret_cast<char *>(my_PRG_string.data()),
+             my_PRG_string.size() * gram::num_bytes_per_integer);
   if (!input)
-    throw std::ios::failure("PRG String file not found");
-  else {
-    uint32_t c{0};
-    uint8_t buffer[gram::num_bytes_per_integer];  // Note, use uint8_t and not
-                                                  // char which is signed
-    size_t byte_pos;
-    while (true) {
-      input.read((char *)&buffer,
-                 gram::num_bytes_per_integer);  // Read byte by byte
-      if (input.eof()) break;
-
-      if (en == endianness::big) {
-        c = (uint32_t)buffer[0] << 24 | (uint32_t)buffer[1] << 16 |
-            (uint32_t)buffer[2] << 8 | (uint32_t)buffer[3];
-      } else {
-        c = (uint32_t)buffer[0] | (uint32_t)buffer[1] << 8 |
-            (uint32_t)buffer[2] << 16 | (uint32_t)buffer[3] << 24;
-      }
+    throw std::ios::failure("Could not read PRG String file " + file_in);
+
+  bool const native_order = (en == endianness::little) ==
+                            (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+  if (!native_order) {
+    // Simple enough for the compiler to vectorise
+    for (auto &marker : my_PRG_string) marker = __builtin_bswap32(marker);
+  }
 
-      if (input.eof()) break;
-      assert(c >= 1);
-      my_PRG_string.push_back(c);
-      c = 0;
-    }
-  };
   output_file = file_in;
   map_ends_and_check_for_duplicates();
 
@@ -50,32 +48,50 @@ PRG_String::PRG_String(marker_vec const &v_in) {
 };
 
 void PRG_String::map_ends_and_check_for_duplicates() {
-  int pos = 0;
-  std::size_t v_size = my_PRG_string.size();  // Converts to signed
-  Marker marker;
-  std::set<Marker> seen_sites;
-
-  while (pos < v_size) {
-    marker = my_PRG_string[pos];
-    if (marker <= 4) {
-      ++pos;
-      continue;
-    }
-    if (is_site_marker(marker)) {
-      bool seen_before = seen_sites.find(marker) != seen_sites.end();
-      if (seen_before) {
-        // Duplicate site marker
-        throw std::runtime_error(
-            "PRG consistency error:"
-            " site marker " +
-            std::to_string(marker) + " used for two different sites");
-      } else
-        seen_sites.insert(marker);
-    } else {
-      end_positions[marker] =
-          pos;  // Inserts if does not exist, updates otherwise
+  // Each thread records the variant markers of a contiguous chunk; chunks are
+  // then merged in order, so that later allele markers give the site ends.
+  struct ChunkMarkers {
+    marker_vec site_markers;
+    std::vector<std::pair<Marker, int>> allele_markers;
+  };
+  std::size_t const v_size = my_PRG_string.size();
+  int const num_chunks =
+      v_size < (1 << 20) ? 1 : std::max(1, omp_get_max_threads());
+  std::vector<ChunkMarkers> chunks(num_chunks);
+
+#pragma omp parallel for num_threads(num_chunks) schedule(static, 1)
+  for (int chunk = 0; chunk < num_chunks; ++chunk) {
+    auto &markers = chunks[chunk];
+    std::size_t const first = v_size * chunk / num_chunks;
+    std::size_t const last = v_size * (chunk + 1) / num_chunks;
+    for (std::size_t pos = first; pos < last; ++pos) {
+      Marker const marker = my_PRG_string[pos];
+      assert(marker >= 1);
+      if (marker <= 4) continue;
+      if (is_site_marker(marker))
+        markers.site_markers.push_back(marker);
+      else
+        markers.allele_markers.emplace_back(marker, pos);
     }
-    ++pos;
+  }
+
+  marker_vec site_markers;
+  for (auto &markers : chunks) {
+    site_markers.insert(site_markers.end(), markers.site_markers.begin(),
+                        markers.site_markers.end());
+    // Inserts if does not exist, updates otherwise
+    for (auto const &allele_marker : markers.allele_markers)
+      end_positions[allele_marker.first] = allele_marker.second;
+  }
+
+  std::sort(site_markers.begin(), site_markers.end());
+  auto duplicate = std::adjacent_find(site_markers.begin(), site_markers.end());
+  if (duplicate != site_markers.end()) {
+    // Duplicate site marker
+    throw std::runtime_error(
+        "PRG consistency error:"
+        " site marker " +
+        std::to_string(*duplicate) + " used for two different sites");
   }
 }
 
@@ -86,29 +102,18 @@ void PRG_String::write(std::string const &fname, endianness en) {
     exit(1);
   }
 
-  std::vector<char> buffer(gram::num_bytes_per_integer);
-  uint8_t byte_number;
-
-  uint8_t model_byte_number;
-  if (en == endianness::big)
-    model_byte_number = gram::num_bytes_per_integer - 1;
-  else
-    model_byte_number = 0;
-
-  for (auto &s : my_PRG_string) {
-    buffer.clear();
-    byte_number = model_byte_number;
-    while (true) {
-      // In big endian, will push the most significant bytes first in buffer
-      // In little ^^,  will push the least ^^         ^^      ^^
-      buffer.push_back(s >> 8 * byte_number);
-      if (en == endianness::big) {
-        if (byte_number-- == 0) break;
-      } else {
-        if (byte_number++ == gram::num_bytes_per_integer - 1) break;
-      }
-    }
-    for (auto e : buffer) out.write(&e, 1);
+  bool const native_order = (en == endianness::little) ==
+                            (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+  if (native_order)
+    out.write(reinterpret_cast<char const *>(my_PRG_string.data()),
+              my_PRG_string.size() * gram::num_bytes_per_integer);
+  else {
+    marker_vec swapped(my_PRG_string.size());
+    std::transform(my_PRG_string.begin(), my_PRG_string.end(),
+                   swapped.begin(),
+                   [](Marker marker) { return __builtin_bswap32(marker); });
+    out.write(reinterpret_cast<char const *>(swapped.data()),
+              swapped.size() * gram::num_bytes_per_integer);
   }
   out.close();
 }
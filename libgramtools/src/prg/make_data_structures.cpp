@@ -1,11 +1,37 @@
 #include "prg/make_data_structures.hpp"
 #include <filesystem>
 #include "prg/coverage_graph.hpp"
+#include "prg/prg_info.hpp"
+#include "prg/sa_construction.hpp"
 
 namespace fs = std::filesystem;
 
 using namespace gram;
 
+/**
+ * Sorts the suffixes of the encoded prg with our own parallel, possibly
+ * external, construction, and caches the suffix array where
+ * `sdsl::construct` looks for it before building one itself.
+ */
+static void cache_suffix_array(BuildParams const &parameters,
+                               sdsl::cache_config const &config) {
+  marker_vec text = PRG_String{parameters.encoded_prg_fpath}.get_PRG_string();
+  text.push_back(0);  // The terminator sdsl appends to the text
+
+  SAConstructionParams sa_params{parameters.maximum_threads,
+                                 parameters.sa_memory_budget_mb << 20,
+                                 config.dir};
+  sdsl::int_vector_buffer<> sa_buffer(
+      sdsl::cache_file_name(sdsl::conf::KEY_SA, config), std::ios::out,
+      1 << 20, sdsl::bits::hi(text.size()) + 1);
+  construct_suffix_array(text, sa_params,
+                         [&sa_buffer](SuffixBlock const &block) {
+                           for (auto const &suffix : block)
+                             sa_buffer.push_back(suffix);
+                         });
+  sa_buffer.close();
+}
+
 FM_Index gram::generate_fm_index(BuildParams const &parameters) {
   FM_Index fm_index;
 
@@ -17,6 +43,10 @@ FM_Index gram::generate_fm_index(BuildParams const &parameters) {
   config.dir = fs::absolute(construction_tmp_dir).string();
   fs::create_directories(config.dir);
 
+  // sdsl sorts suffixes single-threaded and in memory
+  if (parameters.maximum_threads > 1 or parameters.sa_memory_budget_mb > 0)
+    cache_suffix_array(parameters, config);
+
   // Last param is the number of bytes per integer for reading encoded PRG
   // string. NB: sdsl doc says reads those in big endian, but actually reads in
   // little endian (GH issue #418) So the prg file needs to be in little endian.
@@ -50,6 +80,70 @@ coverage_Graph gram::generate_cov_graph(CommonParameters const &parameters,
   return c_g;
 }
 
+void gram::store_end_positions(CommonParameters const &parameters,
+                               PRG_String const &prg_string) {
+  std::ofstream ofs{parameters.end_positions_fpath, std::ios::binary};
+  boost::archive::binary_oarchive oa{ofs};
+  auto const end_positions = prg_string.get_end_positions();
+  oa << end_positions;
+}
+
+std::unordered_map<Marker, int> gram::load_end_positions(
+    CommonParameters const &parameters) {
+  std::ifstream ifs{parameters.end_positions_fpath, std::ios::binary};
+  // Not stored by earlier versions of `build`
+  if (!ifs) {
+    PRG_String prg_string{parameters.encoded_prg_fpath};
+    return prg_string.get_end_positions();
+  }
+
+  std::unordered_map<Marker, int> end_positions;
+  boost::archive::binary_iarchive ia{ifs};
+  ia >> end_positions;
+  return end_positions;
+}
+
+void gram::generate_sa_locus_runs(PRG_Info &prg_info,
+                                  CommonParameters const &parameters) {
+  prg_info.sa_locus_runs =
+      SALocusRuns(prg_info.fm_index, prg_info.coverage_graph);
+  sdsl::store_to_file(prg_info.sa_locus_runs, parameters.sa_locus_runs_fpath);
+}
+
+void gram::generate_reduced_bwt(PRG_Info &prg_info,
+                                marker_vec const &encoded_prg,
+                                CommonParameters const &parameters) {
+  prg_info.reduced_bwt = ReducedBWT(prg_info.fm_index, encoded_prg);
+  sdsl::store_to_file(prg_info.reduced_bwt, parameters.reduced_bwt_fpath);
+}
+
+void gram::load_reduced_bwt(PRG_Info &prg_info,
+                            CommonParameters const &parameters) {
+  // Not stored by earlier versions of `build`: read off the suffix array and
+  // the prg, rather than the wavelet tree one symbol at a time
+  if (!fs::exists(parameters.reduced_bwt_fpath)) {
+    PRG_String prg_string{parameters.encoded_prg_fpath};
+    prg_info.reduced_bwt =
+        ReducedBWT(prg_info.fm_index, prg_string.get_PRG_string());
+    return;
+  }
+  if (parameters.map_artefacts)
+    prg_info.reduced_bwt.map(parameters.reduced_bwt_fpath);
+  else
+    sdsl::load_from_file(prg_info.reduced_bwt, parameters.reduced_bwt_fpath);
+}
+
+void gram::load_sa_locus_runs(PRG_Info &prg_info,
+                              CommonParameters const &parameters) {
+  // Not stored by earlier versions of `build`
+  if (!fs::exists(parameters.sa_locus_runs_fpath)) {
+    prg_info.sa_locus_runs =
+        SALocusRuns(prg_info.fm_index, prg_info.coverage_graph);
+    return;
+  }
+  sdsl::load_from_file(prg_info.sa_locus_runs, parameters.sa_locus_runs_fpath);
+}
+
 child_map gram::build_child_map(parental_map const &par_map) {
   child_map result;
 
@@ -72,92 +166,46 @@ child_map gram::build_child_map(parental_map const &par_map) {
  **************/
 
 /**
- * Generates a bit vector with bit set if the given DNA `base` is present at
- * each index of the BWT.
- */
-void populate_dna_bwt_masks(FM_Index const &fm_index, DNA_BWT_Masks &d_m) {
-  for (uint64_t i = 0; i < fm_index.bwt.size(); i++) {
-    switch (fm_index.bwt[i]) {
-      case 1:
-        d_m.mask_a[i] = true;
-        break;
-      case 2:
-        d_m.mask_c[i] = true;
-        break;
-      case 3:
-        d_m.mask_g[i] = true;
-        break;
-      case 4:
-        d_m.mask_t[i] = true;
-        break;
-    }
-  }
-}
-
-/**
- * Generates a filename for a BWT mask for nucleotide bases.
- * @see generate_base_bwt_mask()
+ * Generates a filename for a bit mask over the BWT.
+ * @see generate_bwt_masks()
  */
-std::string bwt_mask_fname(const std::string &base_char,
+std::string bwt_mask_fname(const std::string &mask_name,
                            CommonParameters const &parameters) {
   auto handling_unit_tests = parameters.gram_dirpath[0] == '@';
   if (handling_unit_tests) {
-    return parameters.gram_dirpath + "_" + base_char + "_base_bwt_mask";
+    return parameters.gram_dirpath + "_" + mask_name + "_bwt_mask";
   }
   fs::path dir(parameters.gram_dirpath);
-  fs::path file(base_char + "_base_bwt_mask");
+  fs::path file(mask_name + "_bwt_mask");
   fs::path full_path = dir / file;
   return full_path.string();
 }
 
-DNA_BWT_Masks gram::generate_bwt_masks(FM_Index const &fm_index,
-                                       CommonParameters const &parameters) {
-  auto bwt_size = fm_index.bwt.size();
-  DNA_BWT_Masks d_m;
-  // Set storage for the bit masks
-  d_m.mask_a = sdsl::bit_vector(bwt_size, 0);
-  d_m.mask_c = sdsl::bit_vector(bwt_size, 0);
-  d_m.mask_g = sdsl::bit_vector(bwt_size, 0);
-  d_m.mask_t = sdsl::bit_vector(bwt_size, 0);
-
-  populate_dna_bwt_masks(fm_index, d_m);
-
-  auto fpath = bwt_mask_fname("a", parameters);
-  sdsl::store_to_file(d_m.mask_a, fpath);
-
-  fpath = bwt_mask_fname("c", parameters);
-  sdsl::store_to_file(d_m.mask_c, fpath);
-
-  fpath = bwt_mask_fname("g", parameters);
-  sdsl::store_to_file(d_m.mask_g, fpath);
-
-  fpath = bwt_mask_fname("t", parameters);
-  sdsl::store_to_file(d_m.mask_t, fpath);
-
-  return d_m;
-}
-
-sdsl::bit_vector load_base_bwt_mask(const std::string &base_char,
-                                    CommonParameters const &parameters) {
-  auto fpath = bwt_mask_fname(base_char, parameters);
-  sdsl::bit_vector mask;
-  sdsl::load_from_file(mask, fpath);
-  return mask;
+/** Derives the bwt markers mask of `prg_info` from its reduced bwt */
+static void derive_bwt_markers_mask(PRG_Info &prg_info) {
+  auto const &reduced_bwt = prg_info.reduced_bwt;
+  sdsl::bit_vector markers_mask(reduced_bwt.size(), 0);
+  for (auto const &index : reduced_bwt.marker_positions())
+    markers_mask[index] = 1;
+  prg_info.bwt_markers_mask =
+      std::make_shared<sdsl::bit_vector>(std::move(markers_mask));
 }
 
-DNA_BWT_Masks gram::load_dna_bwt_masks(const FM_Index &fm_index,
-                                       CommonParameters const &parameters) {
-  DNA_BWT_Masks dna_bwt_masks;
-  dna_bwt_masks.mask_a = load_base_bwt_mask("a", parameters);
-  dna_bwt_masks.mask_c = load_base_bwt_mask("c", parameters);
-  dna_bwt_masks.mask_g = load_base_bwt_mask("g", parameters);
-  dna_bwt_masks.mask_t = load_base_bwt_mask("t", parameters);
-  return dna_bwt_masks;
+void gram::generate_bwt_masks(PRG_Info &prg_info,
+                              CommonParameters const &parameters) {
+  derive_bwt_markers_mask(prg_info);
+  sdsl::store_to_file(*prg_info.bwt_markers_mask,
+                      bwt_mask_fname("markers", parameters));
 }
 
-sdsl::bit_vector gram::generate_bwt_markers_mask(const FM_Index &fm_index) {
-  sdsl::bit_vector bwt_markers_mask(fm_index.bwt.size(), 0);
-  for (uint64_t i = 0; i < fm_index.bwt.size(); i++)
-    bwt_markers_mask[i] = fm_index.bwt[i] > 4;
-  return bwt_markers_mask;
+void gram::load_bwt_masks(PRG_Info &prg_info,
+                          CommonParameters const &parameters) {
+  auto const markers_fpath = bwt_mask_fname("markers", parameters);
+  // Not stored by earlier versions of `build`
+  if (!fs::exists(markers_fpath)) {
+    derive_bwt_markers_mask(prg_info);
+    return;
+  }
+  prg_info.bwt_markers_mask =
+      load_int_vector<1>(markers_fpath, parameters.map_artefacts);
 }
@@ -0,0 +1,74 @@
+#include "prg/marker_jump_tables.hpp"
+
+using namespace gram;
+
+SA_Interval gram::get_marker_sa_interval(Marker const &marker,
+                                         FM_Index const &fm_index) {
+  const auto alphabet_rank = fm_index.char2comp[marker];
+  const auto start_sa_index = fm_index.C[alphabet_rank];
+
+  SA_Index end_sa_index;
+  // Case: the current marker is not the last element of the alphabet.
+  if (alphabet_rank < fm_index.sigma - 1) {
+    // Below: use - 1 because we get positioned at the first position whose
+    // suffix starts with the next element in the alphabet note: the rank query
+    // itself is exclusive, so at backward search time this will get +1 again.
+    end_sa_index = fm_index.C[alphabet_rank + 1] - 1;
+  }
+  // Case: it is the last element of the alphabet
+  else
+    end_sa_index = fm_index.size() - 1;
+
+  return SA_Interval{start_sa_index, end_sa_index};
+}
+
+MarkerJumpTables::MarkerJumpTables(
+    FM_Index const &fm_index, coverage_Graph const &coverage_graph,
+    std::unordered_map<Marker, int> const &last_allele_positions) {
+  // Allele markers are the largest markers of their site
+  Marker max_marker{0};
+  for (auto const &entry : last_allele_positions)
+    max_marker = std::max(max_marker, entry.first);
+  auto const num_sites = max_marker < 5 ? 0 : index(max_marker) + 1;
+
+  site_sa_indexes.resize(num_sites, 0);
+  allele_sa_intervals.resize(num_sites, SA_Interval{0, 0});
+  site_end_positions.resize(num_sites, 0);
+  exit_targets.resize(num_sites, 0);
+  parent_loci.resize(num_sites, VariantLocus{0, ALLELE_UNKNOWN});
+  entry_target_offsets.resize(num_sites + 1, 0);
+
+  // Site numbers need not be contiguous: only fill in those present
+  for (auto const &entry : last_allele_positions) {
+    auto const allele_marker = entry.first;
+    auto const i = index(allele_marker);
+    site_sa_indexes[i] =
+        get_marker_sa_interval(allele_marker - 1, fm_index).first;
+    allele_sa_intervals[i] = get_marker_sa_interval(allele_marker, fm_index);
+    site_end_positions[i] = entry.second;
+  }
+
+  auto const &target_map = coverage_graph.target_map;
+  for (auto const &entry : target_map) {
+    auto const &marker = entry.first;
+    if (is_site_marker(marker)) {
+      // A site exit point targets a single other marker
+      assert(entry.second.size() == 1);
+      exit_targets[index(marker)] = entry.second.back().ID;
+    } else
+      entry_target_offsets[index(marker) + 1] = entry.second.size();
+  }
+  for (auto const &entry : coverage_graph.par_map)
+    parent_loci[index(entry.first)] = entry.second;
+
+  // Lay out entry targets contiguously, in site order
+  for (std::size_t i = 0; i < num_sites; ++i)
+    entry_target_offsets[i + 1] += entry_target_offsets[i];
+  entry_target_list.resize(entry_target_offsets.back());
+  for (auto const &entry : target_map) {
+    if (is_site_marker(entry.first)) continue;
+    std::copy(entry.second.begin(), entry.second.end(),
+              entry_target_list.begin() +
+                  entry_target_offsets[index(entry.first)]);
+  }
+}
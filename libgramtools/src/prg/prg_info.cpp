@@ -1,13 +1,13 @@
 #include "prg/prg_info.hpp"
 #include "build/kmer_index/masks.hpp"
+#include "common/huge_pages.hpp"
 
 using namespace gram;
 
 PRG_Info gram::load_prg_info(CommonParameters const &parameters) {
   PRG_Info prg_info;
 
-  PRG_String ps{parameters.encoded_prg_fpath};
-  prg_info.last_allele_positions = ps.get_end_positions();
+  prg_info.last_allele_positions = load_end_positions(parameters);
 
   // Load coverage graph
   std::ifstream ifs{parameters.cov_graph_fpath};
@@ -16,14 +16,34 @@ PRG_Info gram::load_prg_info(CommonParameters const &parameters) {
   prg_info.num_variant_sites = prg_info.coverage_graph.bubble_map.size();
 
   prg_info.fm_index = load_fm_index(parameters);
+  prg_info.jump_tables =
+      MarkerJumpTables(prg_info.fm_index, prg_info.coverage_graph,
+                       prg_info.last_allele_positions);
+  load_sa_locus_runs(prg_info, parameters);
 
-  prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index);
-
-  prg_info.dna_bwt_masks = load_dna_bwt_masks(prg_info.fm_index, parameters);
-  prg_info.rank_bwt_a = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_a);
-  prg_info.rank_bwt_c = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_c);
-  prg_info.rank_bwt_g = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_g);
-  prg_info.rank_bwt_t = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_t);
+  load_reduced_bwt(prg_info, parameters);
+  load_bwt_masks(prg_info, parameters);
 
+  if (parameters.huge_pages) advise_huge_pages(prg_info);
   return prg_info;
 }
+
+/** The bytes of an `sdsl::int_vector`'s data */
+template <typename IntVector>
+static std::size_t num_bytes(IntVector const &vector) {
+  return (vector.bit_size() + 63) / 64 * sizeof(uint64_t);
+}
+
+void gram::advise_huge_pages(PRG_Info const &prg_info) {
+  // With a sampling density of 1, this is the whole suffix array
+  auto const &sa = prg_info.fm_index.sa_sample;
+  huge_pages::advise(sa.data(), num_bytes(sa));
+  auto const &random_access = prg_info.coverage_graph.random_access;
+  huge_pages::advise(random_access.data(),
+                     random_access.size() * sizeof(random_access[0]));
+  // Possibly mapped from its file: this reads it in now
+  if (prg_info.bwt_markers_mask != nullptr) {
+    auto const &markers_mask = *prg_info.bwt_markers_mask;
+    huge_pages::advise(markers_mask.data(), num_bytes(markers_mask));
+  }
+}
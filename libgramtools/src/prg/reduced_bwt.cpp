@@ -0,0 +1,306 @@
+#include "prg/reduced_bwt.hpp"
+
+#include <omp.h>
+#include <algorithm>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
+#include <limits>
+
+using namespace gram;
+
+namespace {
+/** Each two-bit lane's low bit */
+constexpr uint64_t low_bits = 0x5555555555555555ULL;
+
+/** Flags the low bit of the lanes of `word` holding `code` */
+uint64_t code_matches(uint64_t word, uint64_t code) {
+  auto const differences = word ^ (code * low_bits);
+  return ~(differences | differences >> 1) & low_bits;
+}
+
+template <typename Vector>
+uint64_t serialize_pod_vector(Vector const &vector, std::ostream &out,
+                              sdsl::structure_tree_node *v,
+                              std::string const &name) {
+  auto child = sdsl::structure_tree::add_child(v, name, "std::vector");
+  uint64_t written_bytes =
+      sdsl::write_member(vector.size(), out, child, "size");
+  auto const num_bytes = vector.size() * sizeof(typename Vector::value_type);
+  out.write((char const *)vector.data(), num_bytes);
+  written_bytes += num_bytes;
+  sdsl::structure_tree::add_size(child, written_bytes);
+  return written_bytes;
+}
+
+template <typename Vector>
+void load_pod_vector(Vector &vector, std::istream &in) {
+  std::size_t size;
+  sdsl::read_member(size, in);
+  vector.resize(size);
+  in.read((char *)vector.data(), size * sizeof(typename Vector::value_type));
+}
+
+/** Reads the arrays `serialize_pod_vector` wrote into a mapped file */
+class MappedReader {
+ public:
+  MappedReader(char const *data, uint64_t size, std::string fpath)
+      : data(data), size(size), fpath(std::move(fpath)) {}
+
+  template <typename T>
+  T read_member() {
+    T member;
+    std::memcpy(&member, take(sizeof(T)), sizeof(T));
+    return member;
+  }
+
+  template <typename T>
+  ArrayView<T> read_array() {
+    auto const num_elements = read_member<std::size_t>();
+    if (num_elements > (size - offset) / sizeof(T)) fail("truncated");
+    auto const elements = take(num_elements * sizeof(T));
+    if (reinterpret_cast<uintptr_t>(elements) % alignof(T) != 0)
+      fail("misaligned");
+    return ArrayView<T>(reinterpret_cast<T const *>(elements), num_elements);
+  }
+
+ private:
+  char const *take(uint64_t num_bytes) {
+    if (num_bytes > size - offset) fail("truncated");
+    auto const taken = data + offset;
+    offset += num_bytes;
+    return taken;
+  }
+
+  [[noreturn]] void fail(std::string const &reason) const {
+    throw std::runtime_error("Cannot map reduced bwt " + fpath + ": " +
+                             reason);
+  }
+
+  char const *data;
+  uint64_t size, offset = 0;
+  std::string fpath;
+};
+
+struct ChunkMarkers {
+  std::vector<uint32_t> indexes;
+  std::vector<Marker> symbols;
+};
+}  // namespace
+
+ReducedBWT::ReducedBWT(
+    uint64_t size,
+    std::function<void(uint64_t, uint64_t, Marker *)> const &read_symbols)
+    : bwt_size(size) {
+  if (size > std::numeric_limits<SA_Index>::max())
+    throw std::length_error("The prg's BWT is too long to index: " +
+                            std::to_string(size) + " symbols");
+  uint64_t const num_blocks = (size + block_size - 1) / block_size;
+  base_codes.assign(num_blocks * words_per_block, 0);
+  blocks.assign(num_blocks + 1, Block{{0, 0, 0, 0}, 0});
+
+  // Each chunk of whole blocks gets decoded independently. Blocks first hold
+  // the base counts of the block before them.
+  uint64_t const num_chunks = std::max<uint64_t>(
+      std::min<uint64_t>(omp_get_max_threads(), num_blocks / 16), 1);
+  std::vector<ChunkMarkers> chunk_markers(num_chunks);
+  std::vector<uint64_t> chunk_terminators(num_chunks, size);
+#pragma omp parallel for schedule(static, 1)
+  for (uint64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    auto &markers = chunk_markers[chunk];
+    std::vector<Marker> symbols(block_size);
+    for (auto block = num_blocks * chunk / num_chunks;
+         block < num_blocks * (chunk + 1) / num_chunks; ++block) {
+      auto &counts = blocks[block + 1].base_counts;
+      uint64_t const first = block * block_size;
+      uint64_t const last = std::min(first + block_size, size);
+      read_symbols(first, last, symbols.data());
+      for (uint64_t i = first; i < last; ++i) {
+        auto const symbol = symbols[i - first];
+        if (symbol == 0)
+          chunk_terminators[chunk] = i;
+        else if (symbol > 4) {
+          markers.indexes.push_back(i);
+          markers.symbols.push_back(symbol);
+        } else {
+          base_codes[i / bases_per_word] |= uint64_t(symbol - 1)
+                                            << 2 * (i % bases_per_word);
+          ++counts[symbol - 1];
+        }
+      }
+    }
+  }
+
+  terminator_index = *std::min_element(chunk_terminators.begin(),
+                                       chunk_terminators.end());
+  for (auto &markers : chunk_markers) {
+    marker_indexes.insert(marker_indexes.end(), markers.indexes.begin(),
+                          markers.indexes.end());
+    marker_symbols.insert(marker_symbols.end(), markers.symbols.begin(),
+                          markers.symbols.end());
+    markers = ChunkMarkers{};
+  }
+
+  uint64_t next_marker{0};
+  for (uint64_t block = 0; block <= num_blocks; ++block) {
+    if (block > 0)
+      for (int base = 0; base < 4; ++base)
+        blocks[block].base_counts[base] += blocks[block - 1].base_counts[base];
+    while (next_marker < marker_indexes.size() &&
+           marker_indexes[next_marker] < block * block_size)
+      ++next_marker;
+    blocks[block].first_marker = next_marker;
+  }
+
+  // The `C` array: the number of BWT symbols smaller than each symbol
+  Marker max_symbol{4};
+  for (auto const &symbol : marker_symbols)
+    max_symbol = std::max(max_symbol, symbol);
+  symbol_starts.assign(max_symbol + 2, 0);
+  if (size > 0) symbol_starts[1] = 1;  // The terminator
+  for (int base = 0; base < 4; ++base)
+    symbol_starts[base + 2] = blocks.back().base_counts[base];
+  for (auto const &symbol : marker_symbols) ++symbol_starts[symbol + 1];
+  for (std::size_t symbol = 1; symbol < symbol_starts.size(); ++symbol)
+    symbol_starts[symbol] += symbol_starts[symbol - 1];
+  view_owned_arrays();
+}
+
+ReducedBWT::ReducedBWT(FM_Index const &fm_index, marker_vec const &encoded_prg)
+    : ReducedBWT(fm_index.size(),
+                 [&](uint64_t first, uint64_t last, Marker *symbols) {
+                   // With a sampling density of 1, the whole suffix array
+                   auto const &sa = fm_index.sa_sample;
+                   for (auto i = first; i < last; ++i) {
+                     uint64_t const prg_index = sa[i];
+                     // The whole prg is preceded by its terminator
+                     symbols[i - first] =
+                         prg_index == 0 ? 0 : encoded_prg[prg_index - 1];
+                   }
+                 }) {}
+
+ReducedBWT::ReducedBWT(FM_Index const &fm_index)
+    : ReducedBWT(fm_index.size(),
+                 [&](uint64_t first, uint64_t last, Marker *symbols) {
+                   for (auto i = first; i < last; ++i)
+                     symbols[i - first] = fm_index.bwt[i];
+                 }) {}
+
+ReducedBWT &ReducedBWT::operator=(ReducedBWT const &other) {
+  bwt_size = other.bwt_size;
+  terminator_index = other.terminator_index;
+  base_codes = other.base_codes;
+  blocks = other.blocks;
+  marker_indexes = other.marker_indexes;
+  marker_symbols = other.marker_symbols;
+  symbol_starts = other.symbol_starts;
+  mapping = other.mapping;
+  if (mapping == nullptr) {
+    view_owned_arrays();
+    return *this;
+  }
+  codes = other.codes;
+  block_view = other.block_view;
+  marker_index_view = other.marker_index_view;
+  marker_symbol_view = other.marker_symbol_view;
+  starts = other.starts;
+  return *this;
+}
+
+void ReducedBWT::view_owned_arrays() {
+  codes = ArrayView<uint64_t>(base_codes);
+  block_view = ArrayView<Block>(blocks);
+  marker_index_view = ArrayView<uint32_t>(marker_indexes);
+  marker_symbol_view = ArrayView<Marker>(marker_symbols);
+  starts = ArrayView<SA_Index>(symbol_starts);
+}
+
+Marker ReducedBWT::operator[](uint64_t index) const {
+  if (index == terminator_index) return 0;
+  auto const block = index / block_size;
+  auto const markers = marker_index_view.begin();
+  auto const first = markers + block_view[block].first_marker;
+  auto const last = markers + block_view[block + 1].first_marker;
+  auto const marker = std::lower_bound(first, last, index);
+  if (marker != last && *marker == index)
+    return marker_symbol_view[marker - markers];
+  auto const word = codes[index / bases_per_word];
+  return (word >> 2 * (index % bases_per_word) & 3) + 1;
+}
+
+uint64_t ReducedBWT::rank(uint64_t upper_index, int_Base dna_base) const {
+  if (dna_base < 1 || dna_base > 4) return 0;
+  uint64_t const code = dna_base - 1;
+  auto const block = upper_index / block_size;
+  uint64_t count = block_view[block].base_counts[code];
+
+  auto const last_word = upper_index / bases_per_word;
+  for (auto word = block * words_per_block; word < last_word; ++word)
+    count += sdsl::bits::cnt(code_matches(codes[word], code));
+  auto const num_lanes = upper_index % bases_per_word;
+  if (num_lanes > 0) {
+    auto const lanes = (uint64_t{1} << 2 * num_lanes) - 1;
+    count += sdsl::bits::cnt(code_matches(codes[last_word], code) & lanes);
+  }
+
+  // Markers and the terminator got coded as A
+  if (code == 0) {
+    auto const block_start = block * block_size;
+    for (auto marker = block_view[block].first_marker;
+         marker < marker_index_view.size() &&
+         marker_index_view[marker] < upper_index;
+         ++marker)
+      --count;
+    if (terminator_index >= block_start && terminator_index < upper_index)
+      --count;
+  }
+  return count;
+}
+
+uint64_t ReducedBWT::serialize(std::ostream &out, sdsl::structure_tree_node *v,
+                               std::string name) const {
+  auto child = sdsl::structure_tree::add_child(v, name,
+                                               sdsl::util::class_name(*this));
+  uint64_t written_bytes = 0;
+  written_bytes += sdsl::write_member(bwt_size, out, child, "bwt_size");
+  written_bytes +=
+      sdsl::write_member(terminator_index, out, child, "terminator_index");
+  written_bytes += serialize_pod_vector(codes, out, child, "base_codes");
+  written_bytes += serialize_pod_vector(block_view, out, child, "blocks");
+  written_bytes +=
+      serialize_pod_vector(marker_index_view, out, child, "marker_indexes");
+  written_bytes +=
+      serialize_pod_vector(marker_symbol_view, out, child, "marker_symbols");
+  written_bytes += serialize_pod_vector(starts, out, child, "symbol_starts");
+  sdsl::structure_tree::add_size(child, written_bytes);
+  return written_bytes;
+}
+
+void ReducedBWT::load(std::istream &in) {
+  sdsl::read_member(bwt_size, in);
+  sdsl::read_member(terminator_index, in);
+  load_pod_vector(base_codes, in);
+  load_pod_vector(blocks, in);
+  load_pod_vector(marker_indexes, in);
+  load_pod_vector(marker_symbols, in);
+  load_pod_vector(symbol_starts, in);
+  mapping.reset();
+  view_owned_arrays();
+}
+
+void ReducedBWT::map(std::string const &fpath) {
+  auto file = std::make_shared<boost::iostreams::mapped_file_source>(fpath);
+  MappedReader reader(file->data(), file->size(), fpath);
+  bwt_size = reader.read_member<uint64_t>();
+  terminator_index = reader.read_member<uint64_t>();
+  codes = reader.read_array<uint64_t>();
+  block_view = reader.read_array<Block>();
+  marker_index_view = reader.read_array<uint32_t>();
+  marker_symbol_view = reader.read_array<Marker>();
+  starts = reader.read_array<SA_Index>();
+  base_codes = {};
+  blocks = {};
+  marker_indexes = {};
+  marker_symbols = {};
+  symbol_starts = {};
+  mapping = std::move(file);
+}
@@ -0,0 +1,370 @@
+#include <omp.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+#include "prg/sa_construction.hpp"
+
+using namespace gram;
+namespace fs = std::filesystem;
+
+namespace {
+/** Splitters sampled per partition: more evens out partition sizes */
+constexpr uint64_t oversampling = 16;
+constexpr uint64_t max_num_partitions = 1024;
+/** Beyond it, partitions that still exceed the budget are sorted regardless */
+constexpr int max_partitioning_depth = 4;
+
+/**
+ * Compares suffixes symbol by symbol. Needs no bounds checks: two distinct
+ * suffixes differ at the latest at the text's unique terminator.
+ */
+class SuffixLess {
+ public:
+  explicit SuffixLess(marker_vec const &text) : text(text.data()) {}
+  bool operator()(SuffixIndex lhs, SuffixIndex rhs) const {
+    if (lhs == rhs) return false;
+    while (text[lhs] == text[rhs]) {
+      ++lhs;
+      ++rhs;
+    }
+    return text[lhs] < text[rhs];
+  }
+
+ private:
+  Marker const *text;
+};
+
+/** Sorts chunks in parallel, then merges them pairwise, also in parallel */
+template <typename Less>
+void parallel_sort(SuffixBlock::iterator begin, SuffixBlock::iterator end,
+                   Less const &less, uint32_t num_threads) {
+  uint64_t const size = end - begin;
+  uint64_t const num_chunks =
+      std::min<uint64_t>(std::max<uint32_t>(num_threads, 1),
+                         std::max<uint64_t>(size / 1024, 1));
+  std::vector<uint64_t> bounds(num_chunks + 1);
+  for (uint64_t i = 0; i <= num_chunks; ++i) bounds[i] = size * i / num_chunks;
+
+#pragma omp parallel for num_threads(num_chunks) schedule(static, 1)
+  for (uint64_t i = 0; i < num_chunks; ++i)
+    std::sort(begin + bounds[i], begin + bounds[i + 1], less);
+
+  for (uint64_t width = 1; width < num_chunks; width *= 2) {
+    uint64_t const num_merges = (num_chunks + 2 * width - 1) / (2 * width);
+#pragma omp parallel for num_threads(num_merges) schedule(static, 1)
+    for (uint64_t merge = 0; merge < num_merges; ++merge) {
+      auto const first = merge * 2 * width;
+      auto const middle = std::min(first + width, num_chunks);
+      auto const last = std::min(first + 2 * width, num_chunks);
+      if (middle == last) continue;
+      std::inplace_merge(begin + bounds[first], begin + bounds[middle],
+                         begin + bounds[last], less);
+    }
+  }
+}
+
+template <typename Less>
+void parallel_sort(SuffixBlock &suffixes, Less const &less,
+                   uint32_t num_threads) {
+  parallel_sort(suffixes.begin(), suffixes.end(), less, num_threads);
+}
+
+/** A range [first, last) of the suffix array, of suffixes sharing a rank */
+using Group = std::pair<uint64_t, uint64_t>;
+
+/**
+ * Sorts `suffixes[first, last)` on `key`, ranks each by the SA index of the
+ * first suffix sharing its key, and appends the groups still unsorted.
+ */
+template <typename Key>
+void refine_group(SuffixBlock &suffixes, uint64_t first, uint64_t last,
+                  Key const &key, std::vector<SuffixIndex> &ranks,
+                  std::vector<Group> &unsorted, uint32_t num_threads) {
+  parallel_sort(
+      suffixes.begin() + first, suffixes.begin() + last,
+      [&key](SuffixIndex lhs, SuffixIndex rhs) { return key(lhs) < key(rhs); },
+      num_threads);
+  uint64_t group_start = first;
+  for (uint64_t i = first; i < last; ++i) {
+    if (i > first && key(suffixes[i]) != key(suffixes[i - 1])) {
+      if (i - group_start > 1) unsorted.emplace_back(group_start, i);
+      group_start = i;
+    }
+    ranks[suffixes[i]] = group_start;
+  }
+  if (last - group_start > 1) unsorted.emplace_back(group_start, last);
+}
+
+/**
+ * Prefix doubling (Manber-Myers), only refining the groups of suffixes not
+ * yet told apart (as in Larsson-Sadakane). After the round of step `h`,
+ * suffixes are sorted on their first `2h` symbols: each round sorts the
+ * suffixes of each unsorted group on the rank of the suffix `h` symbols
+ * further. Rounds are logarithmic in the longest repeat of the text, so
+ * repetitive prgs cost no more to sort than random text.
+ * Groups are refined in parallel; large ones, each with several threads.
+ * Holds three words per suffix.
+ */
+SuffixBlock prefix_doubling_sort(marker_vec const &text,
+                                 uint32_t num_threads) {
+  uint64_t const text_size = text.size();
+  SuffixBlock suffixes(text_size);
+  std::iota(suffixes.begin(), suffixes.end(), 0);
+  std::vector<SuffixIndex> ranks(text_size), next_ranks;
+  std::vector<Group> unsorted;
+  refine_group(
+      suffixes, 0, text_size,
+      [&text](SuffixIndex suffix) { return text[suffix]; }, ranks, unsorted,
+      num_threads);
+
+  uint64_t const large_group = std::max<uint64_t>(
+      text_size / (4 * std::max<uint32_t>(num_threads, 1)), 1 << 16);
+  for (uint64_t h = 1; !unsorted.empty(); h *= 2) {
+    // Keys are read from this round's ranks only. A suffix in an unsorted
+    // group is at least `h + 1` long: the terminator is unique.
+    next_ranks = ranks;
+    auto const key = [&ranks, h](SuffixIndex suffix) {
+      return ranks[suffix + h];
+    };
+    std::vector<Group> groups;
+    std::swap(groups, unsorted);
+    std::vector<Group> small_groups;
+    for (auto const &group : groups) {
+      if (group.second - group.first < large_group)
+        small_groups.push_back(group);
+      else
+        refine_group(suffixes, group.first, group.second, key, next_ranks,
+                     unsorted, num_threads);
+    }
+
+    std::vector<std::vector<Group>> thread_unsorted(
+        std::max<uint32_t>(num_threads, 1));
+#pragma omp parallel for num_threads(thread_unsorted.size()) \
+    schedule(dynamic, 64)
+    for (uint64_t i = 0; i < small_groups.size(); ++i)
+      refine_group(suffixes, small_groups[i].first, small_groups[i].second,
+                   key, next_ranks, thread_unsorted[omp_get_thread_num()], 1);
+    for (auto const &groups_of_thread : thread_unsorted)
+      unsorted.insert(unsorted.end(), groups_of_thread.begin(),
+                      groups_of_thread.end());
+    std::swap(ranks, next_ranks);
+  }
+  return suffixes;
+}
+
+/** Yields a set of suffixes block by block, as many times as needed */
+class SuffixSource {
+ public:
+  virtual ~SuffixSource() = default;
+  virtual uint64_t size() const = 0;
+  virtual void rewind() = 0;
+  /** @return false once all suffixes have been yielded */
+  virtual bool next(SuffixBlock &block) = 0;
+};
+
+/** All suffixes of the text */
+class TextSuffixes : public SuffixSource {
+ public:
+  TextSuffixes(uint64_t text_size, uint64_t block_size)
+      : text_size(text_size), block_size(block_size) {}
+  uint64_t size() const override { return text_size; }
+  void rewind() override { position = 0; }
+  bool next(SuffixBlock &block) override {
+    if (position == text_size) return false;
+    block.resize(std::min(block_size, text_size - position));
+    std::iota(block.begin(), block.end(), position);
+    position += block.size();
+    return true;
+  }
+
+ private:
+  uint64_t text_size, block_size, position = 0;
+};
+
+/** Suffixes of a partition, on disk */
+class PartitionSuffixes : public SuffixSource {
+ public:
+  PartitionSuffixes(std::string fpath, uint64_t num_suffixes,
+                    uint64_t block_size)
+      : fpath(std::move(fpath)),
+        num_suffixes(num_suffixes),
+        block_size(block_size) {}
+  uint64_t size() const override { return num_suffixes; }
+  std::string const &path() const { return fpath; }
+  void rewind() override {
+    fhandle = std::ifstream(fpath, std::ios::binary);
+    if (!fhandle)
+      throw SAConstructionException("Could not open partition file " + fpath);
+    position = 0;
+  }
+  bool next(SuffixBlock &block) override {
+    if (position == num_suffixes) return false;
+    block.resize(std::min(block_size, num_suffixes - position));
+    fhandle.read(reinterpret_cast<char *>(block.data()),
+                 block.size() * sizeof(SuffixIndex));
+    if (!fhandle)
+      throw SAConstructionException("Could not read partition file " + fpath);
+    position += block.size();
+    return true;
+  }
+
+ private:
+  std::string fpath;
+  uint64_t num_suffixes, block_size, position = 0;
+  std::ifstream fhandle;
+};
+
+class SuffixArrayBuilder {
+ public:
+  SuffixArrayBuilder(marker_vec const &text,
+                     SAConstructionParams const &params,
+                     std::function<void(SuffixBlock const &)> const &emit)
+      : text(text), params(params), emit(emit), less(text) {
+    budget_size = params.memory_budget_bytes == 0
+                      ? std::numeric_limits<uint64_t>::max()
+                      : params.memory_budget_bytes / sizeof(SuffixIndex);
+    // Room for the block being distributed and its partition assignments
+    block_size = std::clamp<uint64_t>(budget_size / 4, 1 << 12, 1 << 24);
+  }
+
+  void run() {
+    // Prefix doubling holds three words per suffix
+    if (text.size() <= budget_size / 3) {
+      emit(prefix_doubling_sort(text, params.num_threads));
+      return;
+    }
+    TextSuffixes all_suffixes(text.size(), block_size);
+    sort(all_suffixes, 0);
+  }
+
+ private:
+  void sort(SuffixSource &source, int depth) {
+    if (source.size() <= budget_size || depth == max_partitioning_depth) {
+      sort_in_memory(source);
+      return;
+    }
+    auto const num_partitions = std::min(
+        max_num_partitions, 2 * ((source.size() - 1) / budget_size + 1));
+    auto const splitters = sample_splitters(source, num_partitions);
+    auto partitions = distribute(source, splitters);
+
+    for (auto &partition : partitions) {
+      if (partition.size() == 0) continue;
+      // Did not split: sampling cannot do better than this
+      auto const next_depth = partition.size() == source.size()
+                                  ? max_partitioning_depth
+                                  : depth + 1;
+      sort(partition, next_depth);
+      fs::remove(partition.path());
+    }
+  }
+
+  void sort_in_memory(SuffixSource &source) {
+    SuffixBlock suffixes, block;
+    suffixes.reserve(source.size());
+    source.rewind();
+    while (source.next(block))
+      suffixes.insert(suffixes.end(), block.begin(), block.end());
+    parallel_sort(suffixes, less, params.num_threads);
+    emit(suffixes);
+  }
+
+  /** @return `num_partitions - 1` sorted suffixes delimiting the partitions */
+  SuffixBlock sample_splitters(SuffixSource &source, uint64_t num_partitions) {
+    uint64_t const stride =
+        std::max<uint64_t>(source.size() / (num_partitions * oversampling), 1);
+    SuffixBlock samples, block;
+    uint64_t position = 0;
+    source.rewind();
+    while (source.next(block)) {
+      for (uint64_t i = (stride - position % stride) % stride; i < block.size();
+           i += stride)
+        samples.push_back(block[i]);
+      position += block.size();
+    }
+    parallel_sort(samples, less, params.num_threads);
+
+    SuffixBlock splitters;
+    for (uint64_t i = 1; i < num_partitions; ++i)
+      splitters.push_back(samples[i * samples.size() / num_partitions]);
+    splitters.erase(std::unique(splitters.begin(), splitters.end()),
+                    splitters.end());
+    return splitters;
+  }
+
+  /**
+   * Writes each suffix to the partition file of the first splitter it
+   * precedes. Assignments are computed in parallel, block by block.
+   */
+  std::vector<PartitionSuffixes> distribute(SuffixSource &source,
+                                            SuffixBlock const &splitters) {
+    auto const num_partitions = splitters.size() + 1;
+    std::vector<std::string> fpaths;
+    std::vector<std::ofstream> fhandles;
+    for (uint64_t i = 0; i < num_partitions; ++i) {
+      fpaths.push_back(
+          (fs::path(params.tmp_dirpath) /
+           ("sa_partition_" + std::to_string(num_partition_files++)))
+              .string());
+      fhandles.emplace_back(fpaths.back(), std::ios::binary);
+      if (!fhandles.back())
+        throw SAConstructionException("Could not create partition file " +
+                                      fpaths.back());
+    }
+
+    std::vector<uint64_t> sizes(num_partitions, 0);
+    std::vector<uint32_t> assignments;
+    SuffixBlock block;
+    source.rewind();
+    while (source.next(block)) {
+      assignments.resize(block.size());
+#pragma omp parallel for num_threads(params.num_threads) schedule(static)
+      for (uint64_t i = 0; i < block.size(); ++i)
+        assignments[i] =
+            std::upper_bound(splitters.begin(), splitters.end(), block[i],
+                             less) -
+            splitters.begin();
+      for (uint64_t i = 0; i < block.size(); ++i) {
+        fhandles[assignments[i]].write(
+            reinterpret_cast<char const *>(&block[i]), sizeof(SuffixIndex));
+        ++sizes[assignments[i]];
+      }
+    }
+
+    std::vector<PartitionSuffixes> partitions;
+    for (uint64_t i = 0; i < num_partitions; ++i) {
+      fhandles[i].close();
+      if (!fhandles[i])
+        throw SAConstructionException("Could not write partition file " +
+                                      fpaths[i]);
+      partitions.emplace_back(fpaths[i], sizes[i], block_size);
+    }
+    return partitions;
+  }
+
+  marker_vec const &text;
+  SAConstructionParams const &params;
+  std::function<void(SuffixBlock const &)> const &emit;
+  SuffixLess less;
+  uint64_t budget_size, block_size;
+  uint64_t num_partition_files = 0;
+};
+}  // namespace
+
+void gram::construct_suffix_array(
+    marker_vec const &text, SAConstructionParams const &params,
+    std::function<void(SuffixBlock const &)> const &emit) {
+  if (text.empty() || text.back() != 0 ||
+      std::count(text.begin(), text.end(), 0) != 1)
+    throw SAConstructionException(
+        "Suffix array construction needs a text ending with a unique 0");
+  if (params.memory_budget_bytes > 0 && params.tmp_dirpath.empty())
+    throw SAConstructionException(
+        "Suffix array construction in a memory budget needs a tmp directory");
+
+  SuffixArrayBuilder(text, params, emit).run();
+}
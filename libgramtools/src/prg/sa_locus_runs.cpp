@@ -0,0 +1,130 @@
+#include "prg/sa_locus_runs.hpp"
+
+#include <omp.h>
+
+using namespace gram;
+
+namespace {
+struct Run {
+  uint64_t head;
+  VariantLocus locus;
+};
+}  // namespace
+
+SALocusRuns::SALocusRuns(FM_Index const &fm_index,
+                         coverage_Graph const &coverage_graph) {
+  auto const &random_access = coverage_graph.random_access;
+  uint64_t const sa_size = fm_index.size();
+  auto const locus_at = [&](uint64_t sa_index) {
+    auto const prg_index = fm_index[sa_index];
+    // The suffix of the prg's terminator is in no node
+    if (prg_index >= random_access.size())
+      return VariantLocus{0, ALLELE_UNKNOWN};
+    auto const &node = random_access[prg_index].node;
+    return VariantLocus{node->get_site_ID(), node->get_allele_ID()};
+  };
+
+  // Each chunk of the SA gets its runs found independently
+  uint64_t const num_chunks = std::max<uint64_t>(
+      std::min<uint64_t>(omp_get_max_threads(), sa_size / 4096), 1);
+  std::vector<std::vector<Run>> chunk_runs(num_chunks);
+#pragma omp parallel for schedule(static, 1)
+  for (uint64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    auto &runs = chunk_runs[chunk];
+    for (auto sa_index = sa_size * chunk / num_chunks;
+         sa_index < sa_size * (chunk + 1) / num_chunks; ++sa_index) {
+      auto locus = locus_at(sa_index);
+      if (runs.empty() || runs.back().locus != locus)
+        runs.push_back(Run{sa_index, locus});
+    }
+  }
+
+  // Runs spanning chunk boundaries are joined
+  std::vector<Run> runs;
+  for (auto const &chunk : chunk_runs) {
+    for (auto const &run : chunk) {
+      if (!runs.empty() && runs.back().locus == run.locus) continue;
+      runs.push_back(run);
+    }
+  }
+
+  run_heads = sdsl::bit_vector(sa_size, 0);
+  run_sites = sdsl::int_vector<>(runs.size(), 0);
+  run_alleles = sdsl::int_vector<>(runs.size(), 0);
+  for (uint64_t i = 0; i < runs.size(); ++i) {
+    run_heads[runs[i].head] = 1;
+    run_sites[i] = runs[i].locus.first;
+    run_alleles[i] = runs[i].locus.second + 1;
+  }
+  sdsl::util::bit_compress(run_sites);
+  sdsl::util::bit_compress(run_alleles);
+  sdsl::util::init_support(run_heads_rank, &run_heads);
+  sdsl::util::init_support(run_heads_select, &run_heads);
+}
+
+SALocusRuns::SALocusRuns(SALocusRuns const &other)
+    : run_heads(other.run_heads),
+      run_heads_rank(other.run_heads_rank),
+      run_heads_select(other.run_heads_select),
+      run_sites(other.run_sites),
+      run_alleles(other.run_alleles) {
+  attach_supports();
+}
+
+SALocusRuns::SALocusRuns(SALocusRuns &&other) noexcept
+    : run_heads(std::move(other.run_heads)),
+      run_heads_rank(std::move(other.run_heads_rank)),
+      run_heads_select(std::move(other.run_heads_select)),
+      run_sites(std::move(other.run_sites)),
+      run_alleles(std::move(other.run_alleles)) {
+  attach_supports();
+}
+
+SALocusRuns &SALocusRuns::operator=(SALocusRuns const &other) {
+  if (this == &other) return *this;
+  run_heads = other.run_heads;
+  run_heads_rank = other.run_heads_rank;
+  run_heads_select = other.run_heads_select;
+  run_sites = other.run_sites;
+  run_alleles = other.run_alleles;
+  attach_supports();
+  return *this;
+}
+
+SALocusRuns &SALocusRuns::operator=(SALocusRuns &&other) noexcept {
+  run_heads = std::move(other.run_heads);
+  run_heads_rank = std::move(other.run_heads_rank);
+  run_heads_select = std::move(other.run_heads_select);
+  run_sites = std::move(other.run_sites);
+  run_alleles = std::move(other.run_alleles);
+  attach_supports();
+  return *this;
+}
+
+void SALocusRuns::attach_supports() {
+  run_heads_rank.set_vector(&run_heads);
+  run_heads_select.set_vector(&run_heads);
+}
+
+uint64_t SALocusRuns::serialize(std::ostream &out,
+                                sdsl::structure_tree_node *v,
+                                std::string name) const {
+  auto child = sdsl::structure_tree::add_child(v, name,
+                                               sdsl::util::class_name(*this));
+  uint64_t written_bytes = 0;
+  written_bytes += run_heads.serialize(out, child, "run_heads");
+  written_bytes += run_heads_rank.serialize(out, child, "run_heads_rank");
+  written_bytes += run_heads_select.serialize(out, child, "run_heads_select");
+  written_bytes += run_sites.serialize(out, child, "run_sites");
+  written_bytes += run_alleles.serialize(out, child, "run_alleles");
+  sdsl::structure_tree::add_size(child, written_bytes);
+  return written_bytes;
+}
+
+void SALocusRuns::load(std::istream &in) {
+  run_heads.load(in);
+  run_heads_rank.load(in, &run_heads);
+  run_heads_select.load(in, &run_heads);
+  run_sites.load(in);
+  run_alleles.load(in);
+}
@@ -1,6 +1,7 @@
 /**
  * @file Combine JSON genotyped files into one
  */
+#include <omp.h>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -14,15 +15,17 @@ using JSON = nlohmann::json;
 using namespace gram::json;
 
 void usage(const char* argv[]) {
-  std::cout << "Usage: " << argv[0] << " fofn fout" << std::endl;
+  std::cout << "Usage: " << argv[0] << " fofn fout [num_threads]" << std::endl;
   std::cout << "\t fofn: file of file names of the JSON files to combine"
             << std::endl;
   std::cout << "\t fout: name of output combined JSON file" << std::endl;
+  std::cout << "\t num_threads: number of threads to use (default: 1)"
+            << std::endl;
   exit(1);
 }
 
 int main(int argc, const char* argv[]) {
-  if (argc != 3) usage(argv);
+  if (argc != 3 && argc != 4) usage(argv);
   fs::path fofn(argv[1]);
   if (!fs::exists(fofn)) {
     std::cout << fofn << " not found.";
@@ -32,6 +35,13 @@ int main(int argc, const char* argv[]) {
     usage(argv);
   }
 
+  int num_threads{1};
+  if (argc == 4) {
+    num_threads = std::atoi(argv[3]);
+    if (num_threads < 1) usage(argv);
+  }
+  omp_set_num_threads(num_threads);
+
   std::ofstream fout(argv[2]);
   if (!fout.good()) {
     std::cout << "Error: could not open " << argv[2] << std::endl;
@@ -39,27 +49,38 @@ int main(int argc, const char* argv[]) {
   }
 
   std::ifstream fin(fofn);
+  std::vector<std::string> fnames;
   std::string next_file;
-  JSON next_json;
-  Json_Prg combined_json;
-  bool first{true};
   while (std::getline(fin, next_file)) {
+    if (next_file.empty()) continue;
     std::ifstream next_istream(next_file);
     if (!next_istream.good()) {
       std::cout << "Error: Could not open JSON file " << next_file << std::endl;
       exit(1);
     }
-    next_json.clear();
-    next_istream >> next_json;
-    if (first) {
-      combined_json.set_prg(next_json);
-      first = false;
-    }
+    fnames.push_back(next_file);
+  }
 
-    else {
-      Json_Prg next_prg(next_json);
-      combined_json.combine_with(next_prg);
+  std::vector<JSON> jsons(fnames.size());
+  std::vector<bool> parsed(fnames.size(), true);
+#pragma omp parallel for schedule(dynamic)
+  for (std::size_t i = 0; i < fnames.size(); i++) {
+    std::ifstream next_istream(fnames[i]);
+    try {
+      next_istream >> jsons[i];
+    } catch (JSON::parse_error const& e) {
+#pragma omp critical(parse_failure)
+      parsed[i] = false;
     }
   }
-  fout << combined_json.get_prg();
+  for (std::size_t i{0}; i < fnames.size(); i++) {
+    if (!parsed[i]) {
+      std::cout << "Error: Could not parse JSON file " << fnames[i]
+                << std::endl;
+      exit(1);
+    }
+  }
+
+  Json_Prg_Merger merger(std::move(jsons));
+  merger.write(fout);
 }
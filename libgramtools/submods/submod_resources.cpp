@@ -37,6 +37,11 @@ PRG_Info gram::submods::generate_prg_info(const marker_vec& prg_raw) {
   // destructor affects the assigned-to cov_Graph
   prg_info.coverage_graph = std::move(coverage_Graph{ps});
   prg_info.last_allele_positions = ps.get_end_positions();
+  prg_info.jump_tables =
+      MarkerJumpTables(prg_info.fm_index, prg_info.coverage_graph,
+                       prg_info.last_allele_positions);
+  prg_info.sa_locus_runs =
+      SALocusRuns(prg_info.fm_index, prg_info.coverage_graph);
   prg_info.sites_mask = generate_sites_mask(encoded_prg);
   prg_info.allele_mask = generate_allele_mask(encoded_prg);
 
@@ -49,13 +54,8 @@ PRG_Info gram::submods::generate_prg_info(const marker_vec& prg_raw) {
   prg_info.markers_mask_count_set_bits =
       prg_info.prg_markers_rank(prg_info.prg_markers_mask.size());
 
-  prg_info.bwt_markers_mask = generate_bwt_markers_mask(prg_info.fm_index);
-
-  prg_info.dna_bwt_masks = generate_bwt_masks(prg_info.fm_index, parameters);
-  prg_info.rank_bwt_a = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_a);
-  prg_info.rank_bwt_c = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_c);
-  prg_info.rank_bwt_g = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_g);
-  prg_info.rank_bwt_t = sdsl::rank_support_v<1>(&prg_info.dna_bwt_masks.mask_t);
+  prg_info.reduced_bwt = ReducedBWT(prg_info.fm_index, encoded_prg);
+  generate_bwt_masks(prg_info, parameters);
 
   prg_info.num_variant_sites = prg_info.coverage_graph.bubble_map.size();
   return prg_info;
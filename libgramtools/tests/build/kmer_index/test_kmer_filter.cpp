@@ -0,0 +1,91 @@
+#include <filesystem>
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "build/kmer_index/kmer_filter.hpp"
+
+using namespace gram;
+
+namespace fs = std::filesystem;
+auto const filter_test_data_dir =
+    fs::path(__FILE__).parent_path().parent_path().parent_path() / "test_data";
+
+static Sequence random_sequence(std::mt19937 &gen, std::size_t length) {
+  std::uniform_int_distribution<int> base_dist(1, 4);
+  Sequence result(length);
+  for (auto &base : result) base = base_dist(gen);
+  return result;
+}
+
+static KmerIndex random_kmer_index(std::size_t num_kmers, uint32_t kmer_size) {
+  std::mt19937 gen(42);
+  KmerIndex kmer_index;
+  while (kmer_index.size() < num_kmers)
+    kmer_index[random_sequence(gen, kmer_size)] = SearchStates{};
+  return kmer_index;
+}
+
+TEST(KmerFilter, GivenIndexedKmers_NoFalseNegatives) {
+  for (uint32_t kmer_size : {3, 11, 33}) {
+    auto kmer_index = random_kmer_index(20, kmer_size);
+    KmerFilter filter(kmer_index, kmer_size);
+    for (auto const &entry : kmer_index)
+      EXPECT_TRUE(filter.may_contain(entry.first));
+  }
+}
+
+TEST(KmerFilter, GivenUnindexedKmers_FewFalsePositives) {
+  uint32_t const kmer_size{15};
+  auto kmer_index = random_kmer_index(10000, kmer_size);
+  KmerFilter filter(kmer_index, kmer_size);
+
+  std::mt19937 gen(7);
+  std::size_t num_queries{0}, false_positives{0};
+  while (num_queries < 10000) {
+    auto kmer = random_sequence(gen, kmer_size);
+    if (kmer_index.find(kmer) != kmer_index.end()) continue;
+    ++num_queries;
+    false_positives += filter.may_contain(kmer);
+  }
+  EXPECT_LT(false_positives, 100);
+}
+
+TEST(KmerFilter, GivenRead_SeedKmersOfBothOrientationsChecked) {
+  uint32_t const kmer_size{4};
+  // Indexed: the read's last kmer, and its reverse complement's last kmer
+  KmerIndex kmer_index{{encode_dna_bases("GGTA"), {}},
+                       {encode_dna_bases("CATT"), {}}};
+  KmerFilter filter(kmer_index, kmer_size);
+
+  auto read = encode_dna_bases("AATGCCGGTA");
+  EXPECT_TRUE(filter.may_seed(read));
+  EXPECT_TRUE(filter.may_seed_reverse_complement(read));
+  // Reverse complement of the read's first kmer, AATG
+  auto catt = encode_dna_bases("CATT");
+  EXPECT_EQ(hash_kmer(read.data(), kmer_size, true),
+            hash_kmer(catt.data(), kmer_size));
+
+  auto read_too_short = encode_dna_bases("GTA");
+  EXPECT_FALSE(filter.may_seed(read_too_short));
+  EXPECT_FALSE(filter.may_seed_reverse_complement(read_too_short));
+}
+
+TEST(KmerFilter, GivenEmptyFilter_AllReadsLetThrough) {
+  KmerFilter filter;
+  auto read = encode_dna_bases("AATGCCGGTA");
+  EXPECT_TRUE(filter.empty());
+  EXPECT_TRUE(filter.may_seed(read));
+  EXPECT_TRUE(filter.may_seed_reverse_complement(read));
+}
+
+TEST(KmerFilter, GivenDumpedFilter_LoadedFilterIdentical) {
+  auto kmer_index = random_kmer_index(500, 9);
+  KmerFilter filter(kmer_index, 9);
+  auto fpath = (filter_test_data_dir / "tmp_kmer_filter").generic_string();
+  filter.dump(fpath);
+  auto loaded = KmerFilter::load(fpath);
+  fs::remove(fpath);
+  EXPECT_EQ(loaded, filter);
+  EXPECT_THROW(KmerFilter::load(fpath), KmerFilterException);
+}
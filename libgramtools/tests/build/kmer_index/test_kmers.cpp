@@ -35,6 +35,22 @@ TEST(GetBoundaryMarkerIndexes, NoVariantSites_NoSiteIndexes) {
   EXPECT_EQ(result, expected);
 }
 
+TEST(GetBoundaryMarkerIndexes, ManyVariantSites_CorrectSiteStartEndIndexes) {
+  std::string prg_string;
+  std::vector<PrgIndexRange> expected;
+  for (uint64_t site = 0; site < 200; ++site) {
+    // "a" then a site like "5g6c6", of length 5
+    auto const site_marker = std::to_string(5 + 2 * site),
+               allele_marker = std::to_string(6 + 2 * site);
+    prg_string += "a" + site_marker + "g" + allele_marker + "c" + allele_marker;
+    expected.emplace_back(PrgIndexRange{6 * site + 1, 6 * site + 5});
+  }
+  auto prg_info = generate_prg_info(encode_prg(prg_string));
+
+  auto result = get_boundary_marker_indexes(prg_info);
+  EXPECT_EQ(result, expected);
+}
+
 TEST(GetKmerRegionRange, VariantSiteCloseToStart_CorrectKmerRegionEndIndexes) {
   auto prg_raw = encode_prg("t7a8c8acagctt");
   auto prg_info = generate_prg_info(prg_raw);
@@ -1337,3 +1353,29 @@ TEST(GenerateKmers, GenerateAllKmersOfSizeThree_CorrectSpotCheck) {
     EXPECT_TRUE(result);
   }
 }
+
+TEST(GetAllReverseKmers, ManyDistantSites_SameAsRegionByRegion) {
+  std::string prg_string;
+  for (int site = 0; site < 50; ++site)
+    prg_string += "acgtacgt" + std::to_string(5 + 2 * site) + "g" +
+                  std::to_string(6 + 2 * site) + "t" +
+                  std::to_string(6 + 2 * site);
+  auto prg_info = generate_prg_info(encode_prg(prg_string));
+
+  BuildParams parameters = {};
+  parameters.kmers_size = 3;
+  parameters.max_read_size = 3;
+  auto result = get_prg_reverse_kmers(parameters, prg_info);
+
+  auto boundary_marker_indexes = get_boundary_marker_indexes(prg_info);
+  auto kmer_region_ranges = combine_overlapping_regions(get_kmer_region_ranges(
+      boundary_marker_indexes, parameters.max_read_size, prg_info));
+  EXPECT_EQ(kmer_region_ranges.size(), 50);
+  ordered_vector_set<Sequence> expected = {};
+  for (auto const &kmer_region_range : kmer_region_ranges) {
+    auto reverse_kmers = get_region_range_reverse_kmers(
+        kmer_region_range, parameters.kmers_size, prg_info);
+    expected.insert(reverse_kmers.begin(), reverse_kmers.end());
+  }
+  EXPECT_EQ(result, expected);
+}
@@ -0,0 +1,49 @@
+#include <cstdint>
+
+#include "common/huge_pages.hpp"
+#include "gtest/gtest.h"
+
+using namespace gram;
+
+class HugePages : public ::testing::Test {
+ protected:
+  void SetUp() { huge_pages::enable(true); }
+  void TearDown() { huge_pages::enable(false); }
+};
+
+TEST_F(HugePages, LargeVector_AlignedOnHugePage) {
+  huge_pages::Vector<uint64_t> vector(huge_pages::page_size / 8 + 1, 1);
+  auto const address = reinterpret_cast<std::uintptr_t>(vector.data());
+  EXPECT_EQ(address % huge_pages::page_size, 0);
+  EXPECT_EQ(vector.back(), 1);
+}
+
+TEST_F(HugePages, SmallVector_Usable) {
+  huge_pages::Vector<uint32_t> vector{1, 2, 3};
+  vector.push_back(4);
+  huge_pages::Vector<uint32_t> expected{1, 2, 3, 4};
+  EXPECT_EQ(vector, expected);
+}
+
+TEST_F(HugePages, VectorGrownPastHugePage_ContentsKept) {
+  huge_pages::Vector<uint64_t> vector;
+  for (uint64_t i = 0; i < huge_pages::page_size / 4; ++i) vector.push_back(i);
+  EXPECT_EQ(vector[12345], 12345);
+  EXPECT_EQ(vector.back(), huge_pages::page_size / 4 - 1);
+}
+
+TEST_F(HugePages, AdviseUnalignedRange_ContentsKept) {
+  std::vector<char> bytes(3 * 4096 + 17, 'a');
+  huge_pages::advise(bytes.data() + 1, bytes.size() - 1);
+  huge_pages::advise(bytes.data(), 0);
+  huge_pages::advise(nullptr, 100);
+  EXPECT_EQ(bytes[4096], 'a');
+}
+
+TEST(HugePagesSwitch, Toggled_ReportedEnabled) {
+  EXPECT_FALSE(huge_pages::enabled());
+  huge_pages::enable(true);
+  EXPECT_TRUE(huge_pages::enabled());
+  huge_pages::enable(false);
+  EXPECT_FALSE(huge_pages::enabled());
+}
@@ -0,0 +1,47 @@
+#include <sstream>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "common/numa.hpp"
+#include "gtest/gtest.h"
+
+using namespace gram;
+
+TEST(NumaParseList, RangesAndSingles_AllListed) {
+  std::vector<int> expected{0, 1, 2, 3, 8, 10, 11};
+  EXPECT_EQ(numa::parse_list("0-3,8,10-11"), expected);
+}
+
+TEST(NumaParseList, Malformed_Empty) {
+  EXPECT_TRUE(numa::parse_list("0-x").empty());
+  EXPECT_TRUE(numa::parse_list("").empty());
+}
+
+TEST(NumaResidentMemory, SeveralMappings_SummedPerNode) {
+  std::stringstream numa_maps(
+      "7f00 default file=/lib/x.so mapped=3 N0=2 N1=1 kernelpagesize_kB=4\n"
+      "7f10 interleave:0-1 anon=4 dirty=4 N0=2 N1=2 kernelpagesize_kB=4\n"
+      "7f20 default anon=1 N1=1 kernelpagesize_kB=2048\n"
+      "7f30 default\n");
+  std::map<int, uint64_t> expected{{0, 16}, {1, 2060}};
+  EXPECT_EQ(numa::resident_kb_per_node(numa_maps), expected);
+}
+
+TEST(NumaInterleave, Disabled_NothingToStop) {
+  numa::ScopedInterleave interleave(false);
+  interleave.stop();
+  EXPECT_FALSE(numa::online_nodes().empty());
+}
+
+#ifdef __linux__
+TEST(NumaPinning, Stopped_CallingThreadAffinityRestored) {
+  cpu_set_t before, after;
+  sched_getaffinity(0, sizeof(before), &before);
+  numa::ScopedPinning pinning(true);
+  pinning.stop();
+  sched_getaffinity(0, sizeof(after), &after);
+  EXPECT_TRUE(CPU_EQUAL(&before, &after));
+}
+#endif
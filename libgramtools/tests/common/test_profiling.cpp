@@ -0,0 +1,105 @@
+#include <omp.h>
+
+#include "common/profiling.hpp"
+#include "gtest/gtest.h"
+
+using namespace gram;
+using namespace gram::profiling;
+
+class Profiling : public ::testing::Test {
+ protected:
+  void SetUp() override { reset(); }
+  void TearDown() override { reset(); }
+};
+
+TEST_F(Profiling, CountersFromSeveralThreads_SummedInTotal) {
+  omp_set_num_threads(4);
+#pragma omp parallel for
+  for (int i = 0; i < 1000; ++i) {
+    increment(Counter::reads_seeded);
+    increment(Counter::sa_entries_touched, 3);
+  }
+
+  auto const result = to_json();
+  EXPECT_EQ(result["counters"]["reads_seeded"], 1000);
+  EXPECT_EQ(result["counters"]["sa_entries_touched"], 3000);
+  EXPECT_EQ(result["counters"]["vBWT_jumps"], 0);
+
+  uint64_t per_thread_sum{0};
+  for (auto const &thread : result["threads"])
+    per_thread_sum += thread["counters"]["reads_seeded"].get<uint64_t>();
+  EXPECT_EQ(per_thread_sum, 1000);
+}
+
+TEST_F(Profiling, DetailedProfilingDisabled_NoTimersRecorded) {
+  { ScopedTimer timer("seed"); }
+
+  auto const result = to_json();
+  EXPECT_FALSE(result["detailed"]);
+  EXPECT_TRUE(result["timers"].empty());
+}
+
+TEST_F(Profiling, NestedTimers_RecordedAsTree) {
+  enable_detailed(false);
+  for (int i = 0; i < 3; ++i) {
+    ScopedTimer outer("extend");
+    for (int j = 0; j < 2; ++j) ScopedTimer inner("vBWT_jump");
+  }
+  { ScopedTimer timer("seed"); }
+
+  auto const timers = to_json()["timers"];
+  ASSERT_EQ(timers.size(), 2);
+  // Timers are listed by name
+  EXPECT_EQ(timers[0]["name"], "extend");
+  EXPECT_EQ(timers[0]["calls"], 3);
+  ASSERT_EQ(timers[0]["timers"].size(), 1);
+  EXPECT_EQ(timers[0]["timers"][0]["name"], "vBWT_jump");
+  EXPECT_EQ(timers[0]["timers"][0]["calls"], 6);
+  EXPECT_EQ(timers[1]["name"], "seed");
+  EXPECT_EQ(timers[1]["calls"], 1);
+}
+
+TEST_F(Profiling, NestedStages_RecordedAsTree) {
+  begin_stage("Load data");
+  end_stage();
+  {
+    ScopedStage quasimap("Quasimap");
+    std::vector<char> allocated(1 << 20, 1);
+    { ScopedStage map_reads("Map reads"); }
+  }
+
+  auto const stages = to_json()["stages"];
+  ASSERT_EQ(stages.size(), 2);
+  EXPECT_EQ(stages[0]["name"], "Load data");
+  EXPECT_FALSE(stages[0].contains("stages"));
+  EXPECT_EQ(stages[1]["name"], "Quasimap");
+  ASSERT_EQ(stages[1]["stages"].size(), 1);
+  EXPECT_EQ(stages[1]["stages"][0]["name"], "Map reads");
+  EXPECT_GE(stages[1]["seconds"].get<double>(),
+            stages[1]["stages"][0]["seconds"].get<double>());
+  EXPECT_GE(stages[1]["peak_rss_kb"].get<uint64_t>(),
+            stages[1]["rss_start_kb"].get<uint64_t>());
+}
+
+TEST_F(Profiling, StageByDefault_PeakIncludesEarlierPeak) {
+  // Released before the stage starts, but still in the process' peak RSS
+  { std::vector<char> allocated(16 << 20, 1); }
+  { ScopedStage stage("Load data"); }
+
+  auto const result = to_json();
+  EXPECT_FALSE(result["peak_rss_per_stage"]);
+  auto const stage = result["stages"][0];
+  EXPECT_GE(stage["peak_rss_kb"].get<uint64_t>(),
+            stage["rss_start_kb"].get<uint64_t>() + (8 << 10));
+}
+
+TEST_F(Profiling, ResetAfterRecording_AllCleared) {
+  increment(Counter::vBWT_jumps);
+  begin_stage("Genotyping");
+  end_stage();
+  reset();
+
+  auto const result = to_json();
+  EXPECT_EQ(result["counters"]["vBWT_jumps"], 0);
+  EXPECT_TRUE(result["stages"].empty());
+}
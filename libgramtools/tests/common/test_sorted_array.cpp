@@ -0,0 +1,42 @@
+#include "common/sorted_array.hpp"
+#include "gtest/gtest.h"
+
+using namespace gram;
+
+using Array = SortedArray<int>;
+
+TEST(SortedArray, InitializerList_SortedWithoutDuplicates) {
+  Array array{7, 3, 5, 3};
+  std::vector<int> result(array.begin(), array.end());
+  EXPECT_EQ(result, (std::vector<int>{3, 5, 7}));
+}
+
+TEST(SortedArray, Insert_KeepsOrderAndRejectsDuplicates) {
+  Array array;
+  EXPECT_TRUE(array.insert(5));
+  EXPECT_TRUE(array.insert(2));
+  EXPECT_FALSE(array.insert(5));
+  EXPECT_EQ(array, (Array{2, 5}));
+  EXPECT_TRUE(array.contains(2));
+  EXPECT_EQ(array.find(3), array.end());
+}
+
+TEST(SortedArray, Merge_UnionOfBoth) {
+  Array array{1, 4, 6};
+  array.merge(Array{2, 4, 9});
+  EXPECT_EQ(array, (Array{1, 2, 4, 6, 9}));
+}
+
+TEST(SortedArray, Compare_LexicographicAsSets) {
+  EXPECT_TRUE((Array{1, 5} < Array{2}));
+  EXPECT_TRUE((Array{1} < Array{1, 2}));
+  EXPECT_FALSE((Array{3, 1} < Array{1, 3}));
+}
+
+TEST(SortedArray, Clear_EmptyThenReusable) {
+  Array array{1, 2};
+  array.clear();
+  EXPECT_TRUE(array.empty());
+  array.insert(3);
+  EXPECT_EQ(array, Array{3});
+}
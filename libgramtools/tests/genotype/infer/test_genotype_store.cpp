@@ -0,0 +1,247 @@
+#include <filesystem>
+#include <sstream>
+
+#include "genotype/infer/level_genotyping/site.hpp"
+#include "genotype/infer/output_specs/genotype_store.hpp"
+#include "genotype/infer/output_specs/json_site_spec.hpp"
+#include "genotype/infer/output_specs/make_json.hpp"
+#include "genotype/infer/output_specs/segment_tracker.hpp"
+#include "gtest/gtest.h"
+
+using namespace gram;
+using namespace gram::json;
+using namespace gram::genotype::output_spec;
+using namespace gram::genotype::output_spec::store_encoding;
+
+namespace fs = std::filesystem;
+auto const store_test_data_dir =
+    fs::path(__FILE__).parent_path().parent_path().parent_path() / "test_data";
+
+TEST(GenotypeStoreEncoding, GivenVarintsAndDoubles_RoundTrips) {
+  std::string bytes;
+  std::vector<uint64_t> vals{0, 1, 127, 128, 300, 1ull << 40};
+  for (auto const& val : vals) put_varint(bytes, val);
+  put_double(bytes, 3.25);
+  put_varint(bytes, zigzag(-1));
+
+  char const* ptr = bytes.data();
+  char const* end = bytes.data() + bytes.size();
+  for (auto const& val : vals) EXPECT_EQ(get_varint(ptr, end), val);
+  EXPECT_EQ(get_double(ptr, end), 3.25);
+  EXPECT_EQ(unzigzag(get_varint(ptr, end)), -1);
+  EXPECT_EQ(ptr, end);
+  EXPECT_THROW(get_varint(ptr, end), GenotypeStoreException);
+}
+
+static JSON make_site(std::size_t pos, strings const& alleles) {
+  Json_Site site;
+  auto& json = site.get_site();
+  json.at("POS") = pos;
+  json.at("SEG") = "chr1";
+  json.at("ALS") = JSON(alleles);
+  return json;
+}
+
+static void add_call(JSON& site, JSON const& gts, AlleleIds const& hapgs,
+                     allele_coverages const& covs, std::size_t dp,
+                     double gt_conf) {
+  site.at("GT").push_back(gts);
+  site.at("HAPG").push_back(JSON(hapgs));
+  site.at("COV").push_back(JSON(covs));
+  site.at("DP").push_back(dp);
+  site.at("FT").push_back(JSON::array());
+  site["GT_CONF"].push_back(gt_conf);
+}
+
+class GenotypeStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    fpath = (store_test_data_dir / "tmp.gts").generic_string();
+    merged_fpath = (store_test_data_dir / "tmp_merged.gts").generic_string();
+
+    // Two samples, three sites (combined JSON: alleles shared by samples)
+    prg1.get_prg().at("Model") = "LevelGenotyping";
+    prg1.get_prg().at("Samples") =
+        JSON::array({JSON{{"Name", "s1"}}, JSON{{"Name", "s2"}}});
+    auto site = make_site(3, {"CTCCT", "CTT"});
+    add_call(site, JSON::array({0, 0}), {0, 0}, {10, 2}, 12, 5.5);
+    add_call(site, JSON::array({1, 1}), {1, 1}, {2, 10}, 12, 2.);
+    prg1.add_site(std::make_shared<Json_Site>(site));
+
+    site = make_site(50, {"AAA", "A"});
+    add_call(site, JSON::array({nullptr}), {}, {0, 0}, 0, 0.);
+    add_call(site, JSON::array({0, 1}), {0, 4}, {7, 8}, 15, 1.);
+    prg1.add_site(std::make_shared<Json_Site>(site));
+
+    site = make_site(90, {"G", "T", "C"});
+    add_call(site, JSON::array({2, 2}), {2, 2}, {0, 0, 20}, 20, 30.);
+    add_call(site, JSON::array({1, 1}), {1, 1}, {0, 9, 0}, 9, 3.);
+    prg1.add_site(std::make_shared<Json_Site>(site));
+
+    // A third sample, with a new allele at the first site
+    prg2.get_prg().at("Model") = "LevelGenotyping";
+    prg2.get_prg().at("Samples") = JSON::array({JSON{{"Name", "s3"}}});
+    site = make_site(3, {"CTCCT", "GTT"});
+    add_call(site, JSON::array({1, 1}), {2, 2}, {1, 11}, 12, 4.);
+    prg2.add_site(std::make_shared<Json_Site>(site));
+    site = make_site(50, {"AAA"});
+    add_call(site, JSON::array({0, 0}), {0, 0}, {6}, 6, 1.);
+    prg2.add_site(std::make_shared<Json_Site>(site));
+    site = make_site(90, {"G"});
+    add_call(site, JSON::array({nullptr}), {}, {0}, 0, 0.);
+    prg2.add_site(std::make_shared<Json_Site>(site));
+  }
+
+  void TearDown() {
+    for (auto const& f : {fpath, merged_fpath})
+      if (fs::exists(f)) fs::remove(f);
+  }
+
+  std::string fpath, merged_fpath;
+  Json_Prg prg1, prg2;
+};
+
+TEST_F(GenotypeStoreTest, GivenJsonPrg_ReadBackSitesAndSamples) {
+  GenotypeStore store(2);  // Small blocks: third site starts a new block
+  store.add_samples(prg1);
+  store.write(fpath);
+
+  GenotypeStoreReader reader(fpath);
+  EXPECT_EQ(reader.num_sites(), 3);
+  EXPECT_EQ(reader.get_sample_names(), strings({"s1", "s2"}));
+  EXPECT_EQ(reader.get_model(), "LevelGenotyping");
+  stored_site expected_site{90, "chr1", {"G", "T", "C"}};
+  EXPECT_EQ(reader.get_site(2), expected_site);
+
+  auto null_call = reader.get_call(1, 0);
+  EXPECT_TRUE(null_call.is_null());
+
+  stored_call expected_call{{1, 1}, {1, 1}, {0, 9, 0}, 9, 3.};
+  EXPECT_EQ(reader.get_call(2, 1), expected_call);
+
+  auto site_calls = reader.get_site_calls(2);
+  auto sample_calls = reader.get_sample_calls(1);
+  EXPECT_EQ(site_calls.at(1), expected_call);
+  EXPECT_EQ(sample_calls.at(2), expected_call);
+  EXPECT_EQ(sample_calls.at(0), reader.get_call(0, 1));
+}
+
+TEST_F(GenotypeStoreTest, GivenNewAlleleInMergedStore_OnlyNewSampleRescaled) {
+  {
+    GenotypeStore store;
+    store.add_samples(prg1);
+    store.write(fpath);
+  }
+  GenotypeStoreReader reader(fpath);
+  GenotypeStore merged;
+  merged.add_samples(reader);
+  merged.add_samples(prg2);
+  merged.write(merged_fpath);
+
+  GenotypeStoreReader merged_reader(merged_fpath);
+  EXPECT_EQ(merged_reader.num_samples(), 3);
+  EXPECT_EQ(merged_reader.get_site(0).alleles,
+            strings({"CTCCT", "CTT", "GTT"}));
+
+  // Previously stored samples are unchanged, bar padding of coverages
+  stored_call expected_s1{{0, 0}, {0, 0}, {10, 2, 0}, 12, 5.5};
+  EXPECT_EQ(merged_reader.get_call(0, 0), expected_s1);
+  stored_call expected_s3{{2, 2}, {2, 2}, {1, 0, 11}, 12, 4.};
+  EXPECT_EQ(merged_reader.get_call(0, 2), expected_s3);
+  EXPECT_TRUE(merged_reader.get_call(2, 2).is_null());
+}
+
+TEST_F(GenotypeStoreTest, GivenIncompatibleInputs_Throws) {
+  GenotypeStore store;
+  store.add_samples(prg1);
+
+  Json_Prg fewer_sites;
+  fewer_sites.get_prg().at("Model") = "LevelGenotyping";
+  EXPECT_THROW(store.add_samples(fewer_sites), GenotypeStoreException);
+
+  auto& other_json = prg2.get_prg();
+  other_json.at("Sites").at(0).at("ALS").at(0) = "GGGGG";
+  Json_Prg different_ref(other_json);
+  EXPECT_THROW(store.add_samples(different_ref), GenotypeStoreException);
+}
+
+TEST_F(GenotypeStoreTest, GivenIncompatibleLaterSite_StoreUnchanged) {
+  GenotypeStore store;
+  store.add_samples(prg1);
+
+  // Its first site registers a new allele before the third site throws
+  auto& other_json = prg2.get_prg();
+  other_json.at("Sites").at(2).at("ALS").at(0) = "A";
+  Json_Prg different_ref(other_json);
+  EXPECT_THROW(store.add_samples(different_ref), GenotypeStoreException);
+
+  EXPECT_EQ(store.num_samples(), 2);
+  store.write(fpath);
+  GenotypeStoreReader reader(fpath);
+  EXPECT_EQ(reader.get_sample_names(), strings({"s1", "s2"}));
+  EXPECT_EQ(reader.get_site(0).alleles, strings({"CTCCT", "CTT"}));
+}
+
+TEST_F(GenotypeStoreTest, GivenWrongNumberOfCoverages_Throws) {
+  auto& json = prg1.get_prg();
+  json.at("Sites").at(2).at("COV").at(1) = JSON::array({9, 0});
+  Json_Prg wrong_covs(json);
+
+  GenotypeStore store;
+  EXPECT_THROW(store.add_samples(wrong_covs), GenotypeStoreException);
+  EXPECT_EQ(store.num_samples(), 0);
+}
+
+static gt_site_ptr make_gtyped_site(std::size_t pos, allele_vector alleles,
+                                    GtypedIndices gts, allele_coverages covs,
+                                    double gt_conf) {
+  auto site = std::make_shared<LevelGenotypedSite>();
+  site->populate_site(
+      gtype_information{alleles, gts, covs, 12, AlleleIds{0, 1}, {}});
+  site->set_pos(pos);
+  site->set_gt_conf(gt_conf);
+  return site;
+}
+
+TEST_F(GenotypeStoreTest, GivenGenotypedSites_SameStoreAsFromJson) {
+  gt_sites sites{
+      make_gtyped_site(3, {Allele{"CTCCT", {}, 0}, Allele{"CTT", {}, 1}},
+                       {0, 1}, {5, 7}, 2.5),
+      make_gtyped_site(50, {Allele{"G", {}, 0}, Allele{"T", {}, 1}}, {1, 1},
+                       {0, 12}, 8.),
+      make_gtyped_site(90, {Allele{"A", {}, 0}}, {-1}, {}, 0.)};
+  std::string const coords{"chr1 40\nchr2 80\n"};
+
+  Json_Prg json_prg;
+  json_prg.get_prg().at("Model") = "LevelGenotyping";
+  json_prg.set_sample_info("s1", "");
+  std::istringstream coords_json(coords);
+  SegmentTracker json_tracker(coords_json);
+  for (auto const& site : sites) {
+    auto json_site = make_json_site(site);
+    json_site->set_segment(json_tracker.get_ID(site->get_pos()));
+    json_site->set_pos(json_tracker.get_relative_pos(site->get_pos()) + 1);
+    json_prg.add_site(json_site);
+  }
+  GenotypeStore from_json;
+  from_json.add_samples(json_prg);
+  from_json.write(fpath);
+
+  std::istringstream coords_direct(coords);
+  SegmentTracker tracker(coords_direct);
+  GenotypeStore direct;
+  direct.add_sample("s1", sites, tracker, "LevelGenotyping");
+  direct.write(merged_fpath);
+
+  std::ifstream json_store(fpath, std::ios::binary),
+      direct_store(merged_fpath, std::ios::binary);
+  std::string const json_bytes{std::istreambuf_iterator<char>(json_store), {}};
+  std::string const direct_bytes{std::istreambuf_iterator<char>(direct_store),
+                                 {}};
+  EXPECT_EQ(direct_bytes, json_bytes);
+
+  GenotypeStoreReader reader(merged_fpath);
+  stored_site expected_site{11, "chr2", {"G", "T"}};
+  EXPECT_EQ(reader.get_site(1), expected_site);
+  EXPECT_TRUE(reader.get_call(2, 0).is_null());
+}
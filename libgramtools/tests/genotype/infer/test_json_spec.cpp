@@ -337,3 +337,90 @@ TEST(PRG_Combine_Successs2_cpy, GivenTwoPrgs_CorrectCombined) {
   site2_sample1.combine_with(site2_sample2);
   EXPECT_EQ(data.prg1.get_prg().at("Sites").at(1), site2_sample1.get_site());
 }
+
+TEST(Site_Combine_Success, GivenThreeSites_CombineAllSameAsPairwise) {
+  JSON_data_store data;
+  std::vector<Json_Site> to_combine;
+  for (auto const& sample : data.site1_samples)
+    to_combine.emplace_back(sample->get_site());
+  auto result = Json_Site::combine_all(to_combine);
+
+  auto sample1 = data.site1_samples.at(0), sample2 = data.site1_samples.at(1),
+       sample3 = data.site1_samples.at(2);
+  sample1->combine_with(*sample2);
+  sample1->combine_with(*sample3);
+  EXPECT_EQ(result.get_site(), sample1->get_site());
+}
+
+TEST(Site_Combine_Success,
+     GivenAlleleOnlyCalledByLastSite_CombineAllKeepsEarlierCoverages) {
+  allele_vec als{"A", "C", "G", "T"};
+  MockJsonSite sample1(als, {0}, {0}, {5, 1, 2, 3}, 11, 1, "s");
+  MockJsonSite sample2(als, {1}, {1}, {1, 6, 0, 0}, 7, 1, "s");
+  MockJsonSite sample3(als, {2}, {2}, {0, 1, 7, 0}, 8, 1, "s");
+
+  std::vector<Json_Site> to_combine{Json_Site(sample1.get_site()),
+                                    Json_Site(sample2.get_site()),
+                                    Json_Site(sample3.get_site())};
+  auto result = Json_Site::combine_all(to_combine);
+  // "T" is called by no sample so is dropped; "G" keeps samples 1 and 2's COV
+  MockJsonSite expected({"A", "C", "G"}, {{0}, {1}, {2}}, {{0}, {1}, {2}},
+                        {{5, 1, 2}, {1, 6, 0}, {0, 1, 7}}, {11, 7, 8}, 1, "s");
+  EXPECT_EQ(result.get_site(), expected.get_site());
+
+  // Pairwise, "G" is dropped by the first fold, so samples 1 and 2 lose it
+  sample1.combine_with(sample2);
+  sample1.combine_with(sample3);
+  allele_coverages const pairwise_cov = sample1.get_site().at("COV").at(0);
+  EXPECT_EQ(pairwise_cov, allele_coverages({5, 1, 0}));
+}
+
+TEST(Site_CombineAll_Fail, GivenDifferentSites_Fails) {
+  JSON_data_store data;
+  std::vector<Json_Site> to_combine{
+      Json_Site(data.site1_samples.at(0)->get_site()),
+      Json_Site(data.site2_samples.at(0)->get_site())};
+  ASSERT_THROW(Json_Site::combine_all(to_combine), JSONCombineException);
+}
+
+TEST(PRG_Merger, GivenTwoPrgs_SameAsPairwiseCombine) {
+  JSON_data_store data;
+  Json_Prg_Merger merger(
+      std::vector<JSON>{data.prg1.get_prg(), data.prg2.get_prg()});
+  auto merged = merger.merge();
+
+  data.prg1.combine_with(data.prg2);
+  EXPECT_EQ(merged, data.prg1.get_prg());
+}
+
+TEST(PRG_Merger, GivenTwoPrgs_StreamedOutputSameAsDumpedCombine) {
+  JSON_data_store data;
+  Json_Prg_Merger merger(
+      std::vector<JSON>{data.prg1.get_prg(), data.prg2.get_prg()});
+  std::stringstream streamed;
+  merger.write(streamed, 1);
+
+  data.prg1.combine_with(data.prg2);
+  std::stringstream dumped;
+  dumped << data.prg1.get_prg();
+  EXPECT_EQ(streamed.str(), dumped.str());
+}
+
+TEST(PRG_Merger, GivenDuplicateSampleNames_CanForceOrNotForceMerge) {
+  JSON_data_store data;
+  data.prg2.set_sample_info("Gazorp", "");
+  std::vector<JSON> inputs{data.prg1.get_prg(), data.prg2.get_prg()};
+  EXPECT_THROW(Json_Prg_Merger{inputs}, JSONConsistencyException);
+
+  Json_Prg_Merger merger(inputs, true);
+  auto const& samples = merger.get_header().at("Samples");
+  EXPECT_EQ(samples.at(1).at("Name"), "Gazorp_1");
+}
+
+TEST(PRG_Merger, GivenIncompatiblePrgs_Fails) {
+  JSON_data_store data;
+  auto other = data.prg2.get_prg();
+  other.at("Model") = "A_different_model";
+  std::vector<JSON> inputs{data.prg1.get_prg(), other};
+  EXPECT_THROW(Json_Prg_Merger{inputs}, JSONCombineException);
+}
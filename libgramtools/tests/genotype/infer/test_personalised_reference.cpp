@@ -215,3 +215,40 @@ TEST_F(Personalised_Ref, GivenSeqS2Tracker_CorrectMultiSegRef) {
   str_vec expected{{"ATCGCTT"}, {"TATC"}};
   EXPECT_EQ(res, expected);
 }
+
+TEST_F(Personalised_Ref, GivenHetDiploidGts_StreamsTwoRefsInSegmentOrder) {
+  sites.at(0)->set_genotype(GtypedIndices{1, 2});
+  sites.at(2)->set_genotype(GtypedIndices{0, 1});
+  sites.at(3)->set_genotype(GtypedIndices{0, 1});
+  std::stringstream out;
+  auto num_written =
+      write_personalised_ref(out, graph_root, sites, s1_tracker, "desc");
+  EXPECT_EQ(num_written, 2);
+  std::string expected{
+      ">gramtools_prg_1 desc\nATCGGTTTATC\n"
+      ">gramtools_prg_2 desc\nATCTTTTG\n"};
+  EXPECT_EQ(out.str(), expected);
+}
+
+TEST_F(Personalised_Ref, GivenHetSameGts_StreamsSingleRef) {
+  sites.at(0)->set_genotype(GtypedIndices{0, 0});
+  sites.at(2)->set_genotype(GtypedIndices{1, 1});
+  sites.at(3)->set_genotype(GtypedIndices{1, 1});
+  std::stringstream out;
+  auto num_written =
+      write_personalised_ref(out, graph_root, sites, s1_tracker, "desc");
+  EXPECT_EQ(num_written, 1);
+  EXPECT_EQ(out.str(), ">gramtools_prg_1 desc\nATCGCTTTTTG\n");
+}
+
+TEST_F(Personalised_Ref, GivenMultiSegTracker_StreamedSameAsBuiltRefs) {
+  null_all_sites();
+  std::stringstream out, expected;
+  write_personalised_ref(out, graph_root, sites, s2_tracker_seq, "desc");
+
+  s2_tracker_seq.reset();
+  auto p_refs = get_personalised_ref(graph_root, sites, s2_tracker_seq);
+  add_description(p_refs, "desc");
+  for (auto const& p_ref : p_refs) expected << p_ref << std::endl;
+  EXPECT_EQ(out.str(), expected.str());
+}
@@ -31,6 +31,44 @@ TEST(RandomInclusiveInt, RandomCall_MaxBoundaryReturned) {
   EXPECT_EQ(result, expected);
 }
 
+TEST(CounterRandom, Philox_KnownAnswer) {
+  // Test vector of the Random123 library
+  auto const result = CounterRandom::philox(
+      {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+      {0xa4093822, 0x299f31d0});
+  CounterRandom::Counter expected{0xd16cfe09, 0x94fdcceb, 0x5001e420,
+                                  0x24126ea1};
+  EXPECT_EQ(result, expected);
+}
+
+TEST(CounterRandom, SameSeedAndCounter_SameDraws) {
+  CounterRandom first{42, {7, 0, 1, 0}};
+  CounterRandom second{42, {7, 0, 1, 0}};
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(first.generate(1, 1000000), second.generate(1, 1000000));
+}
+
+TEST(CounterRandom, DifferentCounters_DifferentDraws) {
+  std::set<uint32_t> draws;
+  for (uint32_t ordinal = 0; ordinal < 100; ++ordinal)
+    for (uint32_t strand = 0; strand < 2; ++strand)
+      draws.insert(CounterRandom{42, {ordinal, 0, strand, 0}}.generate(
+          0, UINT32_MAX));
+  EXPECT_EQ(draws.size(), 200);
+}
+
+TEST(CounterRandom, ManyDraws_AllInRangeAndBoundsReached) {
+  CounterRandom r{3, {0, 0, 0, 0}};
+  std::set<uint32_t> draws;
+  for (int i = 0; i < 1000; ++i) {
+    auto const draw = r.generate(1, 3);
+    EXPECT_GE(draw, 1);
+    EXPECT_LE(draw, 3);
+    draws.insert(draw);
+  }
+  EXPECT_EQ(draws, (std::set<uint32_t>{1, 2, 3}));
+}
+
 TEST(CountNonvariantSearchStates, OnePathOneNonPath_CountOne) {
   SearchStates search_states = {
       SearchState{SA_Interval{},
@@ -58,12 +96,19 @@ TEST(LocusFinder_logic, SameSiteMoreThanOnceInSearchState_ThrowsError) {
 TEST(SameLevel0SitesDifferentOrder, SingleEntryInMap) {
   level0_Sites s1{Marker{5}, Marker{7}, Marker{9}, Marker{11}};
   level0_Sites s2{Marker{11}, Marker{9}, Marker{7}, Marker{5}};
+  EXPECT_EQ(s1, s2);
 
-  uniqueSitePaths unique_map{};
-  unique_map.insert({s1, traversal_info{}});
-  unique_map.insert({s2, traversal_info{}});
-
-  EXPECT_EQ(1, unique_map.size());
+  SearchStates search_states = {
+      SearchState{SA_Interval{},
+                  VariantSitePath{VariantLocus{5, FIRST_ALLELE},
+                                  VariantLocus{7, FIRST_ALLELE}}},
+      SearchState{SA_Interval{},
+                  VariantSitePath{VariantLocus{7, FIRST_ALLELE + 1},
+                                  VariantLocus{5, FIRST_ALLELE + 1}}}};
+  PRG_Info prg_info;
+  MappingInstanceSelector m{&prg_info};
+  m.process_searchstates(search_states);
+  EXPECT_EQ(1, m.usps.size());
 }
 
 TEST(GetUniquePathSites, TwoDifferentPaths_CorrectPaths) {
@@ -85,11 +130,11 @@ TEST(GetUniquePathSites, TwoDifferentPaths_CorrectPaths) {
   EXPECT_EQ(result, expected);
 
   // Check SearchState dispatch
-  auto ss_result1 = m.usps[SitePath{5, 7}].first.front();
-  EXPECT_EQ(ss_result1, search_states.front());
+  auto ss_result1 = find_site_path(m.usps, SitePath{5, 7})->first.front();
+  EXPECT_EQ(ss_result1, &search_states.front());
 
-  auto ss_result2 = m.usps[SitePath{9, 11}].first.front();
-  EXPECT_EQ(ss_result2, search_states.back());
+  auto ss_result2 = find_site_path(m.usps, SitePath{9, 11})->first.front();
+  EXPECT_EQ(ss_result2, &search_states.back());
 }
 
 TEST(GetUniquePathSites,
@@ -295,7 +340,7 @@ TEST_F(MappingInstanceSelector_addSearchStates,
        addOneSearchState_correctlyRegistered) {
   selector.add_searchstate(s1);
   traversal_info expected_info{
-      SearchStates{s1},
+      SearchStateViews{&s1},
       uniqueLoci{VariantLocus{5, FIRST_ALLELE}, VariantLocus{7, FIRST_ALLELE}}};
   uniqueSitePaths expected_map{{SitePath{5}, expected_info}};
 
@@ -308,11 +353,11 @@ TEST_F(MappingInstanceSelector_addSearchStates,
   selector.process_searchstates(all_ss);
 
   traversal_info expected_i1{
-      SearchStates{s1, s2},
+      SearchStateViews{&all_ss.front(), &*std::next(all_ss.begin())},
       uniqueLoci{VariantLocus{5, FIRST_ALLELE}, VariantLocus{7, FIRST_ALLELE},
                  VariantLocus{5, FIRST_ALLELE + 1}}};
 
-  traversal_info expected_i2{SearchStates{s3},
+  traversal_info expected_i2{SearchStateViews{&all_ss.back()},
                              uniqueLoci{VariantLocus{9, FIRST_ALLELE}}};
 
   uniqueSitePaths expected_map{{SitePath{5}, expected_i1},
@@ -349,7 +394,7 @@ TEST_F(MappingInstanceSelector_select,
       .WillOnce(Return(3));
 
   MappingInstanceSelector m{&prg_info, &r};
-  m.set_searchstates(ss);  // Copies them to m
+  m.set_searchstates(ss);  // Views them from m
   m.process_searchstates(ss);
   EXPECT_EQ(m.usps.size(), 1);  // Expect one unique site recorded: 7
 
@@ -375,8 +420,8 @@ TEST_F(MappingInstanceSelector_select, selectnonvariant_emptyMappingSelector) {
   MappingInstanceSelector m{ss, &prg_info, &r};
   auto selection = m.get_selection();
 
-  EXPECT_EQ(selection.navigational_search_states.size(), 0);
-  EXPECT_EQ(selection.equivalence_class_loci.size(), 0);
+  EXPECT_TRUE(selection.empty());
+  EXPECT_EQ(selection.equivalence_class_loci, nullptr);
 }
 
 TEST_F(MappingInstanceSelector_select, selectvariant_nonemptyMappingSelector) {
@@ -386,8 +431,29 @@ TEST_F(MappingInstanceSelector_select, selectvariant_nonemptyMappingSelector) {
 
   MappingInstanceSelector m{ss, &prg_info, &r};
   auto selection = m.get_selection();
-  EXPECT_EQ(selection.navigational_search_states.size(), 2);
+  EXPECT_EQ(selection.navigational_search_states->size(), 2);
+  uniqueLoci expected_loci{{VariantLocus{7, FIRST_ALLELE}},
+                           {VariantLocus{7, FIRST_ALLELE + 1}}};
+  EXPECT_EQ(*selection.equivalence_class_loci, expected_loci);
+}
+
+TEST_F(MappingInstanceSelector_select,
+       selectAgainOnOtherRead_previousClassesForgotten) {
+  using namespace ::testing;
+  MockRandomGenerator r;
+  EXPECT_CALL(r, generate(1, 1)).Times(Exactly(1)).WillOnce(Return(1));
+  EXPECT_CALL(r, generate(1, 3)).Times(Exactly(1)).WillOnce(Return(3));
+  SearchStates other_read{SearchState{
+      SA_Interval{4, 4}, VariantSitePath{VariantLocus{9, FIRST_ALLELE}}}};
+
+  MappingInstanceSelector m{&prg_info};
+  m.select(other_read, r);
+  m.select(ss, r);
+
+  EXPECT_EQ(m.usps.size(), 1);
+  auto selection = m.get_selection();
+  EXPECT_EQ(selection.navigational_search_states->size(), 2);
   uniqueLoci expected_loci{{VariantLocus{7, FIRST_ALLELE}},
                            {VariantLocus{7, FIRST_ALLELE + 1}}};
-  EXPECT_EQ(selection.equivalence_class_loci, expected_loci);
+  EXPECT_EQ(*selection.equivalence_class_loci, expected_loci);
 }
@@ -0,0 +1,110 @@
+#include <omp.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "genotype/quasimap/progress.hpp"
+#include "gtest/gtest.h"
+
+using namespace gram;
+namespace fs = std::filesystem;
+
+class QuasimapProgressTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dirpath = fs::temp_directory_path() / "gram_test_quasimap_progress";
+    fs::create_directories(dirpath);
+    reads_fpath = (dirpath / "reads.fastq").generic_string();
+    std::ofstream(reads_fpath) << std::string(1000, 'A');
+  }
+  void TearDown() override { fs::remove_all(dirpath); }
+
+  fs::path dirpath;
+  std::string reads_fpath;
+};
+
+TEST_F(QuasimapProgressTest, ReadsRecordedFromSeveralThreads_Aggregated) {
+  omp_set_num_threads(4);
+  QuasimapProgress progress({reads_fpath}, "");
+#pragma omp parallel for
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 10 == 0)
+      progress.record_read(true, 0, 0);
+    else if (i % 2 == 0)
+      progress.record_read(false, 2, 2);
+    else
+      progress.record_read(false, 1, 1);
+  }
+
+  auto const status = progress.status();
+  EXPECT_EQ(status["reads_processed"], 1000);
+  EXPECT_EQ(status["reads_skipped"], 100);
+  // Not skipped: 400 even reads map both orientations, 500 odd reads map the
+  // one orientation the prefilter let through
+  EXPECT_EQ(status["orientations_searched"], 1300);
+  EXPECT_EQ(status["orientations_mapped"], 1300);
+  EXPECT_DOUBLE_EQ(status["mapped_fraction"].get<double>(), 1.0);
+
+  uint64_t per_thread_sum{0};
+  for (auto const &reads : status["reads_per_thread"])
+    per_thread_sum += reads.get<uint64_t>();
+  EXPECT_EQ(per_thread_sum, 1000);
+}
+
+TEST_F(QuasimapProgressTest, OrientationsRecordedApart_Aggregated) {
+  omp_set_num_threads(4);
+  QuasimapProgress progress({reads_fpath}, "");
+#pragma omp parallel for
+  for (int i = 0; i < 100; ++i) {
+    progress.record_read(false, 2, 1);
+    if (i % 4 == 0) progress.record_orientation_mapped();
+  }
+
+  auto const status = progress.status();
+  EXPECT_EQ(status["reads_processed"], 100);
+  EXPECT_EQ(status["orientations_mapped"], 125);
+}
+
+TEST_F(QuasimapProgressTest, InputPartlyRead_EtaAndBytesRead) {
+  QuasimapProgress progress({reads_fpath}, "");
+  progress.start_file(0);
+  progress.set_input_offset(250);
+
+  auto const status = progress.status();
+  EXPECT_EQ(status["input"]["bytes_total"], 1000);
+  EXPECT_EQ(status["input"]["bytes_read"], 250);
+  EXPECT_FALSE(status["eta_seconds"].is_null());
+}
+
+TEST_F(QuasimapProgressTest, UnknownInputOffset_NoEta) {
+  QuasimapProgress progress({reads_fpath}, "");
+  progress.start_file(0);
+  progress.set_input_offset(-1);
+  EXPECT_TRUE(progress.status()["eta_seconds"].is_null());
+}
+
+TEST_F(QuasimapProgressTest, BufferPartlyMapped_PendingReadsLeft) {
+  QuasimapProgress progress({reads_fpath}, "");
+  progress.record_read(false, 2, 1);
+  progress.set_buffer_loaded(100);
+  for (int i = 0; i < 40; ++i) progress.record_read(false, 2, 1);
+
+  auto const buffer = progress.status()["buffer"];
+  EXPECT_EQ(buffer["loaded"], 100);
+  EXPECT_EQ(buffer["pending"], 60);
+}
+
+TEST_F(QuasimapProgressTest, Stopped_FinalStatusWritten) {
+  auto const status_fpath = (dirpath / "status.json").generic_string();
+  QuasimapProgress progress({reads_fpath}, status_fpath,
+                            std::chrono::milliseconds(1));
+  progress.start();
+  progress.record_read(false, 2, 2);
+  progress.stop();
+
+  nlohmann::json status;
+  std::ifstream(status_fpath) >> status;
+  EXPECT_EQ(status["state"], "done");
+  EXPECT_EQ(status["reads_processed"], 1);
+  EXPECT_FALSE(fs::exists(status_fpath + ".tmp"));
+}
@@ -14,6 +14,7 @@
 
 #include "gtest/gtest.h"
 
+#include "common/dna_kernels.hpp"
 #include "genotype/quasimap/coverage/allele_base.hpp"
 #include "genotype/quasimap/quasimap.hpp"
 #include "genotype/quasimap/search/BWT_search.hpp"
@@ -30,6 +31,68 @@ TEST(ReverseComplementRead, GivenRead_ReverseComplementReadReturned) {
   EXPECT_EQ(result, expected);
 }
 
+static std::vector<gram::SimdLevel> supported_simd_levels() {
+  std::vector<gram::SimdLevel> levels{gram::SimdLevel::scalar};
+  if (gram::best_simd_level() != gram::SimdLevel::scalar)
+    levels.push_back(gram::SimdLevel::sse4);
+  if (gram::best_simd_level() == gram::SimdLevel::avx2)
+    levels.push_back(gram::SimdLevel::avx2);
+  return levels;
+}
+
+TEST(ReadKernels, GivenReadsOfVaryingLengths_AllSimdLevelsAgree) {
+  std::string const bases = "ACGTacgt";
+  gram::Sequence encoded, reversed;
+  // Lengths on either side of the 16 and 32-byte vector widths
+  for (std::size_t length = 0; length <= 70; ++length) {
+    std::string dna;
+    gram::Sequence expected, expected_reverse(length);
+    for (std::size_t i = 0; i < length; ++i) {
+      dna.push_back(bases[(i * 7 + length) % bases.size()]);
+      expected.push_back(encode_dna_base(dna.back()));
+    }
+    for (std::size_t i = 0; i < length; ++i)
+      expected_reverse[i] = 5 - expected[length - 1 - i];
+
+    for (auto const level : supported_simd_levels()) {
+      EXPECT_TRUE(gram::encode_dna_bases(dna.data(), length, encoded, level));
+      EXPECT_EQ(encoded, expected);
+      gram::reverse_complement_read(encoded, reversed, level);
+      EXPECT_EQ(reversed, expected_reverse);
+    }
+  }
+}
+
+TEST(ReadKernels, GivenNonACGTBaseAnywhere_ReadEncodedAsEmpty) {
+  std::string const read(45, 'C');
+  gram::Sequence encoded{1, 2, 3};
+  for (auto const level : supported_simd_levels()) {
+    for (std::size_t pos = 0; pos < read.size(); ++pos) {
+      for (char const non_dna : {'N', 'n', '-', 'U', '\0'}) {
+        auto with_n = read;
+        with_n[pos] = non_dna;
+        EXPECT_FALSE(gram::encode_dna_bases(with_n.data(), with_n.size(),
+                                            encoded, level));
+        EXPECT_TRUE(encoded.empty());
+      }
+    }
+  }
+}
+
+TEST(ReadKernels, GivenOutOfRangeBases_ComplementedToZero) {
+  gram::Sequence read(40, 2);
+  read[0] = 0;
+  read[20] = 5;
+  read[39] = 200;
+  gram::Sequence expected(40, 3);
+  expected[39] = expected[19] = expected[0] = 0;
+  gram::Sequence result;
+  for (auto const level : supported_simd_levels()) {
+    gram::reverse_complement_read(read, result, level);
+    EXPECT_EQ(result, expected);
+  }
+}
+
 TEST(GetKmer, GivenReadAndKmerSize_CorrectKmerReturned) {
   auto read = encode_dna_bases("accgaatt");
   uint32_t kmer_size = 3;
@@ -69,6 +132,25 @@ TEST(Coverage, ReadCrossingSecondVariantFirstAllele_CorrectAlleleCoverage) {
   EXPECT_EQ(result, expected);
 }
 
+TEST(Coverage, SameReadTwiceThroughReadCache_CoverageRecordedTwice) {
+  Sequence kmer = encode_dna_bases("gccta");
+  Sequences kmers = {kmer};
+  prg_setup setup;
+  setup.setup_numbered_prg("gct5c6g6t6aG7t8C8CTA", kmers);
+  ReadCache read_cache(1 << 20);
+
+  const auto read = encode_dna_bases("agccta");
+  for (int i = 0; i < 2; ++i)
+    EXPECT_TRUE(quasimap_read(read, setup.coverage, setup.kmer_index,
+                              setup.prg_info, setup.parameters, ReadID{},
+                              QuasimapCaches{&read_cache}));
+
+  EXPECT_EQ(read_cache.hits(), 1);
+  const auto &result = setup.coverage.allele_sum_coverage;
+  AlleleSumCoverage expected = {{0, 0, 0}, {0, 2}};
+  EXPECT_EQ(result, expected);
+}
+
 TEST(Coverage, ReadCrossingMultipleVariantSites_CorrectAlleleCoverage) {
   Sequence kmer = encode_dna_bases("gtcta");
   Sequences kmers = {kmer};
@@ -429,6 +511,23 @@ TEST(KmerIndexQuasimap, KmerAbsentFromKmerIndex_NoSearchStatesReturned) {
   EXPECT_EQ(search_states.size(), 0);
 }
 
+TEST(KmerIndexQuasimap, SeedKmerRejectedByFilter_OrientationPrefiltered) {
+  Sequence kmer = encode_dna_bases("agt");
+  Sequences kmers = {kmer};
+  prg_setup setup;
+  setup.setup_numbered_prg("gct5c6g6T6AG7T8c8cta", kmers);
+  KmerFilter kmer_filter(setup.kmer_index, setup.parameters.kmers_size);
+
+  QuasimapReadsStats quasimap_stats{};
+  quasimap_stats.coverage = setup.coverage;
+  // Forward seeds on "agt"; the reverse complement, "acta", ends in "cta"
+  const auto read = encode_dna_bases("tagt");
+  quasimap_forward_reverse(quasimap_stats, read, setup.parameters,
+                           setup.kmer_index, kmer_filter, setup.prg_info);
+  EXPECT_EQ(quasimap_stats.prefiltered_reads_count, 1);
+  EXPECT_EQ(quasimap_stats.mapped_reads_count, 1);
+}
+
 TEST(vBWTJump_andBWTExtension, InitiallyInSite_HaveExitedSite) {
   auto prg_raw = encode_prg("gcgct5c6G6t6agtcct");
   auto prg_info = generate_prg_info(prg_raw);
@@ -480,6 +579,20 @@ TEST_F(SearchStates_and_Coverage_EndInSite, MapOneRead_CorrectSearchState) {
   EXPECT_EQ(path_result, path_expected);
 }
 
+TEST_F(SearchStates_and_Coverage_EndInSite,
+       MapTwiceThroughSuffixCache_SameSearchStates) {
+  auto const expected =
+      search_read_backwards(read, kmer, setup.kmer_index, setup.prg_info);
+  SuffixCache suffix_cache(1 << 20, {1, 2});
+  for (int i = 0; i < 2; ++i) {
+    auto const result = search_read_backwards(
+        read, kmer, setup.kmer_index, setup.prg_info, &suffix_cache);
+    EXPECT_EQ(result, expected);
+  }
+  EXPECT_EQ(suffix_cache.lookups(), 2);
+  EXPECT_EQ(suffix_cache.hits(), 1);
+}
+
 TEST_F(SearchStates_and_Coverage_EndInSite, MapOneRead_CorrectCoverage) {
   quasimap_read(read, setup.coverage, setup.kmer_index, setup.prg_info,
                 setup.parameters);
@@ -0,0 +1,95 @@
+#include <omp.h>
+
+#include "genotype/quasimap/read_cache.hpp"
+#include "gtest/gtest.h"
+
+using namespace gram;
+
+static SearchStates some_search_states() {
+  SearchState search_state;
+  search_state.sa_interval = SA_Interval{3, 5};
+  search_state.traversed_path = VariantSitePath{VariantLocus{5, 1}};
+  return SearchStates{search_state, SearchState{SA_Interval{7, 7}}};
+}
+
+/** A distinct read for each `i` below 4^8 */
+static Sequence read_of(int i) {
+  Sequence read;
+  for (int base = 0; base < 8; ++base, i /= 4) read.push_back(i % 4 + 1);
+  return read;
+}
+
+TEST(ReadCache, ReadNotInserted_NotFound) {
+  ReadCache cache(1 << 20);
+  SearchStates found;
+  EXPECT_FALSE(cache.find(Sequence{1, 2, 3}, found));
+  EXPECT_EQ(cache.misses(), 1);
+  EXPECT_EQ(cache.hits(), 0);
+}
+
+TEST(ReadCache, ReadInserted_SearchStatesFound) {
+  ReadCache cache(1 << 20);
+  cache.insert(Sequence{1, 2, 3}, some_search_states());
+  SearchStates found;
+  EXPECT_TRUE(cache.find(Sequence{1, 2, 3}, found));
+  EXPECT_EQ(found, some_search_states());
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+TEST(ReadCache, UnmappedReadInserted_EmptySearchStatesFound) {
+  ReadCache cache(1 << 20);
+  cache.insert(Sequence{4, 4}, SearchStates{});
+  SearchStates found = some_search_states();
+  EXPECT_TRUE(cache.find(Sequence{4, 4}, found));
+  EXPECT_TRUE(found.empty());
+}
+
+TEST(ReadCache, ReadInsertedTwice_CachedOnce) {
+  ReadCache cache(1 << 20);
+  cache.insert(Sequence{1, 2, 3}, some_search_states());
+  cache.insert(Sequence{1, 2, 3}, SearchStates{});
+  EXPECT_EQ(cache.size(), 1);
+  SearchStates found;
+  cache.find(Sequence{1, 2, 3}, found);
+  EXPECT_EQ(found, some_search_states());
+}
+
+TEST(ReadCache, NoBudget_NothingCached) {
+  ReadCache cache(0);
+  cache.insert(Sequence{1, 2, 3}, some_search_states());
+  SearchStates found;
+  EXPECT_FALSE(cache.find(Sequence{1, 2, 3}, found));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(ReadCache, ManyReadsInserted_StaysWithinBudget) {
+  uint64_t const budget = 64 * 1024;
+  ReadCache cache(budget);
+  for (int i = 0; i < 10000; ++i)
+    cache.insert(read_of(i), some_search_states());
+  EXPECT_LE(cache.bytes(), budget);
+  EXPECT_GT(cache.size(), 0);
+  EXPECT_LT(cache.size(), 10000);
+
+  // The latest read is always kept
+  SearchStates found;
+  EXPECT_TRUE(cache.find(read_of(9999), found));
+}
+
+TEST(ReadCache, ConcurrentInsertsAndFinds_AllFound) {
+  ReadCache cache(64 << 20);
+  int const num_reads = 2000;
+#pragma omp parallel for num_threads(4)
+  for (int i = 0; i < 2 * num_reads; ++i) {
+    auto const read = read_of(i % num_reads);
+    SearchStates found;
+    if (!cache.find(read, found)) cache.insert(read, some_search_states());
+  }
+  EXPECT_EQ(cache.size(), num_reads);
+  EXPECT_EQ(cache.hits() + cache.misses(), 2 * num_reads);
+  for (int i = 0; i < num_reads; ++i) {
+    SearchStates found;
+    EXPECT_TRUE(cache.find(read_of(i), found));
+    EXPECT_EQ(found, some_search_states());
+  }
+}
@@ -0,0 +1,96 @@
+#include "genotype/quasimap/suffix_cache.hpp"
+#include "gtest/gtest.h"
+
+using namespace gram;
+
+static SearchStates some_search_states(SA_Index sa_index) {
+  SearchState search_state;
+  search_state.sa_interval = SA_Interval{sa_index, sa_index + 2};
+  search_state.traversing_path = VariantSitePath{VariantLocus{7, 1}};
+  return SearchStates{search_state};
+}
+
+// Kmers are the last 2 bases
+static std::size_t const kmer_size{2};
+
+TEST(SuffixCache, NothingInserted_NotFound) {
+  SuffixCache cache(1 << 20, {1, 2});
+  SearchStates found;
+  EXPECT_EQ(cache.find(Sequence{1, 2, 3, 4}, kmer_size, found), 0);
+  EXPECT_EQ(cache.lookups(), 1);
+  EXPECT_EQ(cache.hits(), 0);
+}
+
+TEST(SuffixCache, SuffixInserted_FoundFromReadSharingIt) {
+  SuffixCache cache(1 << 20, {1, 2});
+  cache.insert(Sequence{1, 2, 3, 4}, kmer_size, 1, some_search_states(3));
+  SearchStates found;
+  EXPECT_EQ(cache.find(Sequence{4, 4, 2, 3, 4}, kmer_size, found), 1);
+  EXPECT_EQ(found, some_search_states(3));
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+TEST(SuffixCache, TwoCheckpointsInserted_LongestFound) {
+  SuffixCache cache(1 << 20, {1, 2});
+  Sequence const read{1, 2, 3, 4};
+  cache.insert(read, kmer_size, 1, some_search_states(3));
+  cache.insert(read, kmer_size, 2, some_search_states(10));
+  SearchStates found;
+  EXPECT_EQ(cache.find(read, kmer_size, found), 2);
+  EXPECT_EQ(found, some_search_states(10));
+}
+
+TEST(SuffixCache, CheckpointLongerThanRead_NotLookedUp) {
+  SuffixCache cache(1 << 20, {1, 8});
+  cache.insert(Sequence{1, 2, 3, 4}, kmer_size, 1, some_search_states(3));
+  SearchStates found;
+  EXPECT_EQ(cache.find(Sequence{2, 3, 4}, kmer_size, found), 1);
+}
+
+TEST(SuffixCache, NotACheckpoint_NotInserted) {
+  SuffixCache cache(1 << 20, {2});
+  Sequence const read{1, 2, 3, 4};
+  cache.insert(read, kmer_size, 1, some_search_states(3));
+  SearchStates found;
+  EXPECT_EQ(cache.find(read, kmer_size, found), 0);
+}
+
+TEST(SuffixCache, NoBudget_NothingCached) {
+  SuffixCache cache(0, {1});
+  Sequence const read{1, 2, 3};
+  cache.insert(read, kmer_size, 1, some_search_states(3));
+  SearchStates found;
+  EXPECT_EQ(cache.find(read, kmer_size, found), 0);
+  EXPECT_EQ(cache.lookups(), 0);
+}
+
+TEST(SuffixCache, FullCache_LeastRecentlyUsedEvicted) {
+  // One shard's budget fits a few suffixes only
+  SuffixCache cache(64 * 800, {5});
+  Sequence const kept{1, 1, 1, 1, 1, 1, 1};
+  cache.insert(kept, kmer_size, 5, some_search_states(3));
+  SearchStates found;
+  // Distinct suffixes, all differing from `kept`
+  for (int i = 0; i < 4000; ++i) {
+    Sequence read{2};
+    for (int base = 0, digits = i; base < 6; ++base, digits /= 4)
+      read.push_back(digits % 4 + 1);
+    cache.insert(read, kmer_size, 5, some_search_states(i));
+    // Keeps `kept` recently used
+    EXPECT_EQ(cache.find(kept, kmer_size, found), 5);
+  }
+  Sequence const first{2, 1, 1, 1, 1, 1, 1};
+  EXPECT_EQ(cache.find(first, kmer_size, found), 0);
+}
+
+TEST(SuffixCache, CheckpointRarelyFound_TurnedOff) {
+  SuffixCache cache(1 << 20, {1, 2}, 0.5, 10);
+  Sequence const read{1, 2, 3, 4};
+  cache.insert(read, kmer_size, 1, some_search_states(3));
+  SearchStates found;
+  // Checkpoint 2 is never found, checkpoint 1 always
+  for (int i = 0; i < 20; ++i) cache.find(read, kmer_size, found);
+  SuffixCache::Checkpoints expected{1};
+  EXPECT_EQ(cache.active_checkpoints(), expected);
+  EXPECT_EQ(cache.hits(), 20);
+}
@@ -31,6 +31,14 @@ TEST(InconsistentPRG_site_with_one_allele, fails) {
   EXPECT_THROW(cov_Graph_Builder{s}, std::runtime_error);
 }
 
+TEST(InconsistentPRG_site_with_one_allele, InLastPiece_fails) {
+  std::string prg_string;
+  for (int i = 0; i < 50; ++i) prg_string += "[A,C]G";
+  prg_string += "[C]";
+  PRG_String s{prg_string_to_ints(prg_string)};
+  EXPECT_THROW(cov_Graph_Builder{s}, std::runtime_error);
+}
+
 TEST(coverage_Graph, is_nested_status) {
   std::string prg{"ATCG[GC,G]A[AT,T]A"};
   marker_vec v = prg_string_to_ints(prg);
@@ -443,6 +451,57 @@ TEST_F(cov_G_Builder_nested_adjMarkers, ParentalMap) {
   EXPECT_EQ(c.par_map, expected);
 }
 
+/**
+ * Many top-level sites: the graph gets built in several pieces, which
+ * stitching must place and wire as a single pass would.
+ */
+class cov_G_Builder_pieces : public ::testing::Test {
+ protected:
+  void SetUp() {
+    std::string prg_string;
+    for (int i = 0; i < num_units; ++i) prg_string += "[A,C[G,T]]GT";
+    PRG_String p{prg_string_to_ints(prg_string)};
+    c = cov_Graph_Builder{p};
+  }
+  static constexpr int num_units{50};
+  cov_Graph_Builder c;
+};
+
+TEST_F(cov_G_Builder_pieces, SeveralPieces) {
+  EXPECT_GT(c.find_piece_starts().size(), 1);
+}
+
+TEST_F(cov_G_Builder_pieces, BubblesAndParents) {
+  EXPECT_EQ(c.bubble_map.size(), 2 * num_units);
+  EXPECT_EQ(c.par_map.size(), num_units);
+  for (Marker unit = 0; unit < num_units; ++unit) {
+    Marker site_ID = 5 + 4 * unit, nested_site_ID = site_ID + 2;
+    EXPECT_EQ(c.bubble_starts.at(site_ID)->get_pos(), 3 * unit);
+    EXPECT_EQ(c.bubble_ends.at(site_ID)->get_pos(), 3 * unit + 1);
+    EXPECT_EQ(c.bubble_starts.at(nested_site_ID)->get_pos(), 3 * unit + 1);
+    EXPECT_EQ(c.par_map.at(nested_site_ID), VariantLocus(site_ID, 1));
+  }
+}
+
+TEST_F(cov_G_Builder_pieces, SitesWiredInOrder) {
+  for (Marker unit = 0; unit < num_units; ++unit) {
+    Marker site_ID = 5 + 4 * unit;
+    auto const& exit = c.bubble_ends.at(site_ID);
+    ASSERT_EQ(exit->get_num_edges(), 1);
+    auto const& invariant = exit->get_edges().front();
+    EXPECT_EQ(invariant->get_sequence(), "GT");
+    EXPECT_EQ(invariant->get_pos(), 3 * unit + 1);
+
+    ASSERT_EQ(invariant->get_num_edges(), 1);
+    auto const& next = invariant->get_edges().front();
+    if (unit + 1 < num_units)
+      EXPECT_EQ(next, c.bubble_starts.at(site_ID + 4));
+    else  // The sink
+      EXPECT_EQ(next->get_pos(), 3 * num_units + 1);
+  }
+  EXPECT_EQ(c.root->get_edges().front(), c.bubble_starts.at(5));
+}
+
 namespace fs = std::filesystem;
 auto const test_data_dir =
     fs::path(__FILE__).parent_path().parent_path() / "test_data";
@@ -137,3 +137,29 @@ TEST(PRGString, ExitPoint_MapPositions) {
   std::unordered_map<Marker, int> expected_end_positions{{6, 9}, {8, 8}};
   EXPECT_EQ(expected_end_positions, l.get_end_positions());
 }
+
+/** Large enough for sites to be mapped by several threads */
+static marker_vec many_sites_prg(Marker num_sites) {
+  marker_vec result;
+  for (Marker site = 5; site < 5 + 2 * num_sites; site += 2) {
+    result.insert(result.end(), {1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4});
+    result.insert(result.end(), {site, 1, site + 1, 2, 3, site + 1});
+  }
+  return result;
+}
+
+TEST(PRGString, ManySites_MapPositions) {
+  auto const markers = many_sites_prg(100000);
+  PRG_String l = PRG_String(markers);
+
+  auto const end_positions = l.get_end_positions();
+  EXPECT_EQ(end_positions.size(), 100000);
+  EXPECT_EQ(end_positions.at(6), 17);
+  EXPECT_EQ(end_positions.at(5 + 2 * 99999 + 1), markers.size() - 1);
+}
+
+TEST(PRGString, ManySitesOneDuplicated_Throws) {
+  auto markers = many_sites_prg(100000);
+  markers.insert(markers.end(), {1, 5, 2, 6, 3, 6});
+  EXPECT_THROW(PRG_String{markers}, std::runtime_error);
+}
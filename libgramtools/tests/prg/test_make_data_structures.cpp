@@ -1,3 +1,6 @@
+#include <filesystem>
+#include <random>
+
 #include "gtest/gtest.h"
 
 #include "prg/make_data_structures.hpp"
@@ -57,3 +60,119 @@ TEST(BuildChildMap, GivenParentalMap_CorrectChildMap) {
 
   EXPECT_EQ(result, expected);
 }
+
+class BWTMasks : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Long enough for the mask to span several 64-bit words
+    prg_info = generate_prg_info(
+        prg_string_to_ints("ACGT[AC,G[T,TTA]]GGA[CC,T]ACTGATTGCCCGTAACGTAGGAT"
+                           "TACG[A,C,GG]TTACGGATCAAGTCC[T,A]CCTGA"));
+    parameters.gram_dirpath = "@bwt_masks_test";
+  }
+
+  void TearDown() override {
+    std::remove((parameters.gram_dirpath + "_markers_bwt_mask").c_str());
+  }
+
+  static void expect_masks_match_bwt(PRG_Info const& prg_info) {
+    auto const& bwt = prg_info.fm_index.bwt;
+    ASSERT_EQ(prg_info.bwt_markers_mask->size(), bwt.size());
+    for (uint64_t i = 0; i < bwt.size(); ++i)
+      EXPECT_EQ((*prg_info.bwt_markers_mask)[i], bwt[i] > 4);
+  }
+
+  PRG_Info prg_info;
+  CommonParameters parameters = {};
+};
+
+TEST_F(BWTMasks, GeneratedFromReducedBWT_MatchBWT) {
+  generate_bwt_masks(prg_info, parameters);
+  expect_masks_match_bwt(prg_info);
+}
+
+TEST_F(BWTMasks, StoredThenLoaded_MatchBWT) {
+  generate_bwt_masks(prg_info, parameters);
+
+  PRG_Info loaded;
+  loaded.fm_index = prg_info.fm_index;
+  loaded.reduced_bwt = prg_info.reduced_bwt;
+  load_bwt_masks(loaded, parameters);
+  expect_masks_match_bwt(loaded);
+}
+
+TEST_F(BWTMasks, NotStored_DerivedFromReducedBWT) {
+  PRG_Info loaded;
+  loaded.fm_index = prg_info.fm_index;
+  loaded.reduced_bwt = prg_info.reduced_bwt;
+  load_bwt_masks(loaded, parameters);
+  expect_masks_match_bwt(loaded);
+}
+
+TEST_F(BWTMasks, StoredThenMapped_MatchBWT) {
+  generate_bwt_masks(prg_info, parameters);
+
+  PRG_Info mapped;
+  mapped.fm_index = prg_info.fm_index;
+  mapped.reduced_bwt = prg_info.reduced_bwt;
+  parameters.map_artefacts = true;
+  load_bwt_masks(mapped, parameters);
+  expect_masks_match_bwt(mapped);
+}
+
+class GenerateFMIndex : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tmp_dirpath = fs::temp_directory_path() / "gram_test_generate_fm_index";
+    fs::create_directories(tmp_dirpath);
+    parameters.gram_dirpath = tmp_dirpath.string();
+    parameters.encoded_prg_fpath = (tmp_dirpath / "prg").string();
+    parameters.fm_index_fpath = (tmp_dirpath / "fm_index").string();
+    parameters.sdsl_memory_log_fpath = (tmp_dirpath / "sdsl_log").string();
+    parameters.maximum_threads = 1;
+    parameters.sa_memory_budget_mb = 0;
+
+    // Random bases and bi-allelic sites, long enough that a 1 MB suffix
+    // array budget forces partitioning
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<Marker> base(1, 4);
+    marker_vec prg;
+    for (Marker site_marker = 5; prg.size() < 100000; site_marker += 2) {
+      for (int i = 0; i < 20; ++i) prg.push_back(base(generator));
+      prg.push_back(site_marker);
+      for (int i = 0; i < 3; ++i) prg.push_back(base(generator));
+      prg.push_back(site_marker + 1);
+      for (int i = 0; i < 3; ++i) prg.push_back(base(generator));
+      prg.push_back(site_marker + 1);
+    }
+    PRG_String{prg}.write(parameters.encoded_prg_fpath);
+  }
+
+  void TearDown() override { fs::remove_all(tmp_dirpath); }
+
+  static void expect_same_fm_index(FM_Index const& result,
+                                   FM_Index const& expected) {
+    ASSERT_EQ(result.size(), expected.size());
+    for (uint64_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(result[i], expected[i]);
+      ASSERT_EQ(result.bwt[i], expected.bwt[i]);
+    }
+  }
+
+  fs::path tmp_dirpath;
+  BuildParams parameters = {};
+};
+
+TEST_F(GenerateFMIndex, SeveralThreads_SameAsSdslConstruction) {
+  auto const expected = generate_fm_index(parameters);
+  parameters.maximum_threads = 4;
+  expect_same_fm_index(generate_fm_index(parameters), expected);
+}
+
+TEST_F(GenerateFMIndex, InMemoryBudget_SameAsSdslConstruction) {
+  auto const expected = generate_fm_index(parameters);
+  parameters.sa_memory_budget_mb = 1;
+  expect_same_fm_index(generate_fm_index(parameters), expected);
+  parameters.maximum_threads = 4;
+  expect_same_fm_index(generate_fm_index(parameters), expected);
+}
@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include "prg/marker_jump_tables.hpp"
+#include "prg/prg_info.hpp"
+#include "submod_resources.hpp"
+
+using namespace gram::submods;
+
+class MarkerJumpTables_Nested : public ::testing::Test {
+ protected:
+  void SetUp() {
+    prg_info = generate_prg_info(prg_string_to_ints("[A,]A[[G,A]A,C,T]"));
+  }
+  PRG_Info prg_info;
+};
+
+TEST_F(MarkerJumpTables_Nested, OneEntryPerSite) {
+  EXPECT_EQ(prg_info.jump_tables.num_sites(), 3);
+}
+
+TEST_F(MarkerJumpTables_Nested, SAIndexes_SameAsFMIndex) {
+  auto const &jump_tables = prg_info.jump_tables;
+  for (Marker site_marker : {5, 7, 9}) {
+    auto const &fm_index = prg_info.fm_index;
+    EXPECT_EQ(jump_tables.site_sa_index(site_marker),
+              fm_index.C[fm_index.char2comp[site_marker]]);
+    EXPECT_EQ(jump_tables.allele_sa_interval(site_marker + 1),
+              get_marker_sa_interval(site_marker + 1, fm_index));
+  }
+}
+
+TEST_F(MarkerJumpTables_Nested, SiteEndPositions) {
+  auto const &jump_tables = prg_info.jump_tables;
+  EXPECT_EQ(jump_tables.site_end_position(6), 3);
+  EXPECT_EQ(jump_tables.site_end_position(8), 16);
+  EXPECT_EQ(jump_tables.site_end_position(10), 10);
+}
+
+TEST_F(MarkerJumpTables_Nested, ExitTargetsAndParents) {
+  auto const &jump_tables = prg_info.jump_tables;
+  // Double entry in the prg: exiting site 9 exits site 7 too
+  EXPECT_EQ(jump_tables.exit_target(9), 7);
+  EXPECT_EQ(jump_tables.parent_locus(9), VariantLocus(7, FIRST_ALLELE));
+  EXPECT_EQ(jump_tables.exit_target(5), 0);
+  EXPECT_EQ(jump_tables.exit_target(7), 0);
+  EXPECT_EQ(jump_tables.parent_locus(7), VariantLocus(0, ALLELE_UNKNOWN));
+}
+
+TEST_F(MarkerJumpTables_Nested, EntryTargets_SameAsTargetMap) {
+  auto const &jump_tables = prg_info.jump_tables;
+  // Direct deletion of site 5's second allele
+  auto targets = jump_tables.entry_targets(6);
+  std::vector<targeted_marker> result(targets.begin(), targets.end());
+  std::vector<targeted_marker> expected{
+      targeted_marker{5, FIRST_ALLELE + 1}};
+  EXPECT_EQ(result, expected);
+
+  EXPECT_TRUE(jump_tables.entry_targets(8).empty());
+  EXPECT_TRUE(jump_tables.entry_targets(10).empty());
+}
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+
+#include "prg/marker_jump_tables.hpp"
+#include "prg/prg_info.hpp"
+#include "submod_resources.hpp"
+
+using namespace gram::submods;
+
+class ReducedBWT_SeveralBlocks : public ::testing::Test {
+ protected:
+  void SetUp() {
+    // Long enough for the bwt to span several blocks of bases
+    std::string prg_string;
+    for (int i = 0; i < 20; ++i)
+      prg_string += "ACGTTGCA[AC,G[T,TTA]]GGA[CC,T]ACTGATTGCC[A,C,GG]TTAC";
+    prg_info = generate_prg_info(prg_string_to_ints(prg_string));
+  }
+
+  static void expect_same_as_fm_index(ReducedBWT const &reduced_bwt,
+                                      FM_Index const &fm_index) {
+    auto const &bwt = fm_index.bwt;
+    ASSERT_EQ(reduced_bwt.size(), bwt.size());
+    uint64_t counts[5] = {0, 0, 0, 0, 0};
+    for (uint64_t i = 0; i < bwt.size(); ++i) {
+      for (int_Base base = 1; base <= 4; ++base)
+        EXPECT_EQ(reduced_bwt.rank(i, base), counts[base]);
+      EXPECT_EQ(reduced_bwt[i], bwt[i]);
+      if (bwt[i] >= 1 && bwt[i] <= 4) ++counts[bwt[i]];
+    }
+    for (int_Base base = 1; base <= 4; ++base)
+      EXPECT_EQ(reduced_bwt.rank(bwt.size(), base), counts[base]);
+  }
+
+  PRG_Info prg_info;
+};
+
+TEST_F(ReducedBWT_SeveralBlocks, FromPrg_SameAsFMIndex) {
+  expect_same_as_fm_index(prg_info.reduced_bwt, prg_info.fm_index);
+}
+
+TEST_F(ReducedBWT_SeveralBlocks, FromWaveletTree_SameAsFMIndex) {
+  expect_same_as_fm_index(ReducedBWT(prg_info.fm_index), prg_info.fm_index);
+}
+
+TEST_F(ReducedBWT_SeveralBlocks, SAIntervals_SameAsFMIndex) {
+  auto const &fm_index = prg_info.fm_index;
+  auto const &reduced_bwt = prg_info.reduced_bwt;
+  for (Marker base = 1; base <= 4; ++base)
+    EXPECT_EQ(reduced_bwt.first_sa_index(base),
+              fm_index.C[fm_index.char2comp[base]]);
+  auto const &encoded_prg = prg_info.encoded_prg;
+  auto const max_marker =
+      *std::max_element(encoded_prg.begin(), encoded_prg.end());
+  for (Marker marker = 5; marker <= max_marker; ++marker)
+    EXPECT_EQ(reduced_bwt.sa_interval(marker),
+              get_marker_sa_interval(marker, fm_index));
+}
+
+TEST_F(ReducedBWT_SeveralBlocks, MarkerPositions_SameAsFMIndex) {
+  auto const &bwt = prg_info.fm_index.bwt;
+  std::vector<uint32_t> expected;
+  for (uint64_t i = 0; i < bwt.size(); ++i)
+    if (bwt[i] > 4) expected.push_back(i);
+  auto const positions = prg_info.reduced_bwt.marker_positions();
+  EXPECT_EQ(std::vector<uint32_t>(positions.begin(), positions.end()),
+            expected);
+}
+
+TEST_F(ReducedBWT_SeveralBlocks, StoredThenLoaded_SameAsFMIndex) {
+  auto const fpath = "@reduced_bwt_test";
+  sdsl::store_to_file(prg_info.reduced_bwt, fpath);
+  ReducedBWT loaded;
+  sdsl::load_from_file(loaded, fpath);
+  std::remove(fpath);
+  expect_same_as_fm_index(loaded, prg_info.fm_index);
+}
+
+TEST_F(ReducedBWT_SeveralBlocks, StoredThenMapped_SameAsFMIndex) {
+  auto const fpath = "@reduced_bwt_map_test";
+  sdsl::store_to_file(prg_info.reduced_bwt, fpath);
+  {
+    ReducedBWT mapped;
+    mapped.map(fpath);
+    expect_same_as_fm_index(mapped, prg_info.fm_index);
+    // Copies share the mapping
+    ReducedBWT copy = mapped;
+    mapped = ReducedBWT{};
+    expect_same_as_fm_index(copy, prg_info.fm_index);
+  }
+  std::remove(fpath);
+}
+
+TEST_F(ReducedBWT_SeveralBlocks, Copied_SameAsFMIndex) {
+  ReducedBWT copy;
+  {
+    ReducedBWT original(prg_info.reduced_bwt);
+    copy = original;
+  }
+  expect_same_as_fm_index(copy, prg_info.fm_index);
+}
+
+TEST(ReducedBWT, MappedFileTruncated_Throws) {
+  auto const fpath = "@reduced_bwt_truncated_test";
+  std::ofstream(fpath) << "short";
+  ReducedBWT mapped;
+  EXPECT_THROW(mapped.map(fpath), std::runtime_error);
+  std::remove(fpath);
+}
+
+TEST(ReducedBWT, NoSites_NoMarkers) {
+  auto prg_info = generate_prg_info(encode_prg("acgt"));
+  EXPECT_EQ(prg_info.reduced_bwt.sa_interval(4), SA_Interval(4, 4));
+  EXPECT_TRUE(prg_info.reduced_bwt.marker_positions().empty());
+}
@@ -0,0 +1,133 @@
+#include <filesystem>
+#include <numeric>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "prg/sa_construction.hpp"
+
+using namespace gram;
+namespace fs = std::filesystem;
+
+class SAConstruction : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tmp_dirpath = fs::temp_directory_path() / "gram_test_sa_construction";
+    fs::create_directories(tmp_dirpath);
+  }
+  void TearDown() override { fs::remove_all(tmp_dirpath); }
+
+  SuffixBlock construct(marker_vec const &text, uint32_t num_threads,
+                        uint64_t memory_budget_bytes) {
+    SAConstructionParams params{num_threads, memory_budget_bytes,
+                                tmp_dirpath.string()};
+    SuffixBlock result;
+    construct_suffix_array(text, params, [&result](SuffixBlock const &block) {
+      result.insert(result.end(), block.begin(), block.end());
+    });
+    return result;
+  }
+
+  static SuffixBlock naive_suffix_array(marker_vec const &text) {
+    SuffixBlock result(text.size());
+    std::iota(result.begin(), result.end(), 0);
+    std::sort(result.begin(), result.end(), [&text](auto lhs, auto rhs) {
+      return std::lexicographical_compare(text.begin() + lhs, text.end(),
+                                          text.begin() + rhs, text.end());
+    });
+    return result;
+  }
+
+  /**
+   * Checks `sa` is the suffix array of `text` in linear time: each suffix must
+   * not precede the next on its first symbol, nor, on equal first symbols, on
+   * the rank of the suffix after it.
+   */
+  static bool is_suffix_array(marker_vec const &text, SuffixBlock const &sa) {
+    auto const size = text.size();
+    if (sa.size() != size) return false;
+    std::vector<uint64_t> ranks(size, size);
+    for (uint64_t i = 0; i < size; ++i) {
+      if (sa[i] >= size || ranks[sa[i]] != size) return false;
+      ranks[sa[i]] = i;
+    }
+    for (uint64_t i = 1; i < size; ++i) {
+      auto const previous = sa[i - 1], current = sa[i];
+      if (text[previous] > text[current]) return false;
+      // Neither is the unique terminator, so both have a next suffix
+      if (text[previous] == text[current] &&
+          ranks[previous + 1] > ranks[current + 1])
+        return false;
+    }
+    return true;
+  }
+
+  /** Random bases, with site and allele markers sprinkled in */
+  static marker_vec random_prg_text(uint64_t size) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<Marker> base(1, 4), marker(5, 40);
+    marker_vec text(size);
+    for (auto &symbol : text)
+      symbol = generator() % 10 == 0 ? marker(generator) : base(generator);
+    text.push_back(0);
+    return text;
+  }
+
+  fs::path tmp_dirpath;
+};
+
+TEST_F(SAConstruction, RandomText_SameAsNaiveSort) {
+  auto const text = random_prg_text(5000);
+  EXPECT_EQ(construct(text, 1, 0), naive_suffix_array(text));
+}
+
+TEST_F(SAConstruction, SeveralThreads_SameAsNaiveSort) {
+  auto const text = random_prg_text(20000);
+  EXPECT_EQ(construct(text, 4, 0), naive_suffix_array(text));
+}
+
+TEST_F(SAConstruction, RepetitiveText_SameAsNaiveSort) {
+  marker_vec text;
+  for (int i = 0; i < 300; ++i) text.insert(text.end(), {1, 2, 1, 5, 3, 6});
+  text.push_back(0);
+  EXPECT_EQ(construct(text, 3, 0), naive_suffix_array(text));
+}
+
+TEST_F(SAConstruction, LongRepetitivePrg_ValidSuffixArray) {
+  // Suffixes share prefixes of up to the whole text: comparing them directly
+  // would take a quadratic number of steps
+  auto unit = random_prg_text(500);
+  unit.pop_back();
+  marker_vec text;
+  for (int i = 0; i < 1000; ++i)
+    text.insert(text.end(), unit.begin(), unit.end());
+  text.push_back(0);
+  EXPECT_TRUE(is_suffix_array(text, construct(text, 1, 0)));
+  EXPECT_TRUE(is_suffix_array(text, construct(text, 4, 0)));
+}
+
+TEST_F(SAConstruction, SuffixArrayOverMemoryBudget_PartitionedOnDisk) {
+  auto const text = random_prg_text(50000);
+  std::size_t num_blocks{0};
+  SAConstructionParams params{2, 8000, tmp_dirpath.string()};
+  SuffixBlock result;
+  construct_suffix_array(text, params, [&](SuffixBlock const &block) {
+    EXPECT_LE(block.size() * sizeof(SuffixIndex), 8000);
+    result.insert(result.end(), block.begin(), block.end());
+    ++num_blocks;
+  });
+
+  EXPECT_GT(num_blocks, 1);
+  EXPECT_EQ(result, naive_suffix_array(text));
+  EXPECT_TRUE(fs::is_empty(tmp_dirpath));
+}
+
+TEST_F(SAConstruction, SingleSymbolRepeated_PartitionsCannotAllFitBudget) {
+  marker_vec text(3000, 1);
+  text.push_back(0);
+  EXPECT_EQ(construct(text, 2, 800), naive_suffix_array(text));
+}
+
+TEST_F(SAConstruction, NoTerminator_Throws) {
+  marker_vec const text{1, 2, 3};
+  EXPECT_THROW(construct(text, 1, 0), SAConstructionException);
+}
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+
+#include "prg/prg_info.hpp"
+#include "submod_resources.hpp"
+
+using namespace gram::submods;
+
+/*
+PRG: AC5T6CAGTAGTC6TA
+i	BWT	SA	text_suffix
+0	A	16
+1	T	15	A
+2	0	0	A C 5 T 6 C A G T A G T C 6 T A
+3	C	6	A G T A G T C 6 T A
+4	T	9	A G T C 6 T A
+5	6	5	C A G T A G T C 6 T A
+6	A	1	C 5 T 6 C A G T A G T C 6 T A
+7	T	12	C 6 T A
+8	A	7	G T A G T C 6 T A
+9	A	10	G T C 6 T A
+10	6	14	T A
+11	G	8	T A G T C 6 T A
+12	G	11	T C 6 T A
+13	5	3	T 6 C A G T A G T C 6 T A
+14	C	2	5 T 6 C A G T A G T C 6 T A
+15	T	4	6 C A G T A G T C 6 T A
+16	C	13	6 T A
+*/
+class SALocusRuns_OneSite : public ::testing::Test {
+ protected:
+  using Runs = std::vector<std::pair<SA_Interval, VariantLocus>>;
+  void SetUp() { prg_info = generate_prg_info(encode_prg("ac5t6cagtagtc6ta")); }
+
+  Runs runs_in(SA_Interval const &sa_interval) const {
+    Runs runs;
+    prg_info.sa_locus_runs.for_each_run(
+        sa_interval,
+        [&runs](SA_Interval const &sub_interval, VariantLocus const &locus) {
+          runs.emplace_back(sub_interval, locus);
+        });
+    return runs;
+  }
+
+  PRG_Info prg_info;
+};
+
+TEST_F(SALocusRuns_OneSite, IntervalWithinOneRun_OneRun) {
+  Runs expected{{SA_Interval{3, 4}, VariantLocus{5, FIRST_ALLELE + 1}}};
+  EXPECT_EQ(runs_in(SA_Interval{3, 4}), expected);
+}
+
+TEST_F(SALocusRuns_OneSite, IntervalOverSeveralRuns_RunsClipped) {
+  Runs expected{
+      {SA_Interval{5, 5}, VariantLocus{5, FIRST_ALLELE + 1}},
+      {SA_Interval{6, 6}, VariantLocus{0, ALLELE_UNKNOWN}},
+      {SA_Interval{7, 8}, VariantLocus{5, FIRST_ALLELE + 1}},
+  };
+  EXPECT_EQ(runs_in(SA_Interval{5, 8}), expected);
+}
+
+TEST_F(SALocusRuns_OneSite, WholeSA_SameAsPerIndexLoci) {
+  Runs expected;
+  auto const &random_access = prg_info.coverage_graph.random_access;
+  for (SA_Index sa_index = 1; sa_index < prg_info.fm_index.size();
+       ++sa_index) {
+    auto const &node = random_access[prg_info.fm_index[sa_index]].node;
+    VariantLocus locus{node->get_site_ID(), node->get_allele_ID()};
+    if (!expected.empty() && expected.back().second == locus)
+      expected.back().first.second = sa_index;
+    else
+      expected.emplace_back(SA_Interval{sa_index, sa_index}, locus);
+  }
+  EXPECT_EQ(runs_in(SA_Interval{1, prg_info.fm_index.size() - 1}), expected);
+}
+
+TEST_F(SALocusRuns_OneSite, StoredThenLoaded_SameRuns) {
+  auto const fpath = "@sa_locus_runs_test";
+  sdsl::store_to_file(prg_info.sa_locus_runs, fpath);
+  auto const expected = runs_in(SA_Interval{0, 16});
+
+  SALocusRuns loaded;
+  sdsl::load_from_file(loaded, fpath);
+  prg_info.sa_locus_runs = loaded;
+  std::remove(fpath);
+  EXPECT_EQ(runs_in(SA_Interval{0, 16}), expected);
+}
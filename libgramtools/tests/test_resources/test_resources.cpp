@@ -29,11 +29,6 @@ void prg_setup::internal_setup(marker_vec encoded_prg, Sequences kmers) {
   // rank_support again, in this scope for it to work
   prg_info = generate_prg_info(encoded_prg);
 
-  sdsl::util::init_support(prg_info.rank_bwt_a, &prg_info.dna_bwt_masks.mask_a);
-  sdsl::util::init_support(prg_info.rank_bwt_c, &prg_info.dna_bwt_masks.mask_c);
-  sdsl::util::init_support(prg_info.rank_bwt_g, &prg_info.dna_bwt_masks.mask_g);
-  sdsl::util::init_support(prg_info.rank_bwt_t, &prg_info.dna_bwt_masks.mask_t);
-
   sdsl::util::init_support(prg_info.prg_markers_rank,
                            &prg_info.prg_markers_mask);
   sdsl::util::init_support(prg_info.prg_markers_select,